@@ -0,0 +1,385 @@
+/*
+ * microbench.cpp
+ * Microbenchmarks del código por objeto y del reporte (sin GPU ni DeepStream)
+ *
+ * Uso:
+ *   microbench [--out <csv>] [--repeat N] [--max-tracks N] [--filter texto]
+ *              [--baseline <csv>] [--threshold %]
+ *
+ * Mide las funciones reales de src/ (track_info.cpp, report.cpp,
+ * report_store.cpp) con los metadatos de bench/nvds en lugar del SDK:
+ *   roi_test              is_bbox_in_roi sobre bbox aleatorios
+ *   tracker_steady        tracker_process_object con 64 tracks sin transiciones
+ *   tracker_transitions   64 tracks que entran, disparan la alerta y salen
+ *   tracker_insert        tracks nuevos hasta N (10k, 100k, 1M)
+ *   tracker_lookup        objetos ya seguidos con N tracks en la tabla
+ *   report                generate_report con N tracks (a /dev/null)
+ *   report_store          reporte columnar con N tracks
+ *
+ * Cada benchmark se repite --repeat veces (default: 5) y se guarda la
+ * mediana y el mínimo en ns por operación. El CSV (stdout o --out) tiene
+ * las columnas benchmark,size,ops,ns_per_op,min_ns_per_op; las líneas que
+ * empiezan con # son comentarios. Con --baseline se compara la mediana con
+ * la de un CSV anterior y el programa termina con 2 si alguna empeoró más
+ * de --threshold por ciento (default: 10).
+ */
+
+#include "config/track_info.hpp"
+#include "log/logger.hpp"
+#include "report/report.hpp"
+#include "report/report_store.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#define OBJECTS_PER_FRAME 64
+#define FRAME_WIDTH 1280
+#define FRAME_HEIGHT 720
+
+struct BenchResult {
+    std::string name;
+    guint64 size;
+    guint64 ops;
+    gdouble ns_per_op;             // Mediana de las repeticiones
+    gdouble min_ns_per_op;
+};
+
+struct BenchOptions {
+    const gchar *out;
+    const gchar *baseline;
+    const gchar *filter;
+    guint repeat;
+    guint64 max_tracks;
+    gdouble threshold;
+};
+
+static std::vector<BenchResult> g_results;
+static BenchOptions g_options;
+
+static guint64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// g_print del tracker y del reporte no deben mezclarse con el CSV
+static void quiet_print(const gchar *) {}
+
+static gboolean selected(const gchar *name) {
+    return !g_options.filter || strstr(name, g_options.filter) != NULL;
+}
+
+static void record(const gchar *name, guint64 size, guint64 ops, std::vector<gdouble> samples) {
+    std::sort(samples.begin(), samples.end());
+    BenchResult r;
+    r.name = name;
+    r.size = size;
+    r.ops = ops;
+    r.ns_per_op = samples[samples.size() / 2];
+    r.min_ns_per_op = samples[0];
+    g_results.push_back(r);
+    fprintf(stderr, "%-20s %9" G_GUINT64_FORMAT " %12.1f ns/op (min %.1f)\n",
+            name, size, r.ns_per_op, r.min_ns_per_op);
+}
+
+// timed() devuelve los ns medidos de una repetición
+static void run(const gchar *name, guint64 size, guint64 ops,
+                const std::function<guint64()> &timed) {
+    if (!selected(name)) return;
+    std::vector<gdouble> samples;
+    for (guint r = 0; r < g_options.repeat; r++) {
+        samples.push_back((gdouble)timed() / ops);
+    }
+    record(name, size, ops, samples);
+}
+
+static void object_at(NvDsObjectMeta *obj, guint64 id, gfloat cx, gfloat cy) {
+    memset(obj, 0, sizeof(*obj));
+    obj->object_id = id;
+    obj->class_id = 0;
+    g_strlcpy(obj->obj_label, "Car", sizeof(obj->obj_label));
+    obj->rect_params.width = 80.0f;
+    obj->rect_params.height = 60.0f;
+    obj->rect_params.left = cx * FRAME_WIDTH - 40.0f;
+    obj->rect_params.top = cy * FRAME_HEIGHT - 30.0f;
+}
+
+static void tracker_setup(TrackerContext *ctx, GTimer *app_timer, gint max_time) {
+    ROIParams roi = { 0.25f, 0.25f, 0.5f, 0.5f };
+    TrackerConfig config;
+    tracker_config_defaults(&config, &roi, max_time);
+    tracker_config_finalize(&config);
+    tracker_init(ctx, &config, app_timer);
+}
+
+static void bench_roi_test(void) {
+    const guint64 ops = 4 * 1000 * 1000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<gfloat> pos(0.0f, 1.0f);
+    std::vector<NvOSD_RectParams> boxes(4096);
+    for (NvOSD_RectParams &b : boxes) {
+        memset(&b, 0, sizeof(b));
+        b.width = 80.0f;
+        b.height = 60.0f;
+        b.left = pos(rng) * FRAME_WIDTH;
+        b.top = pos(rng) * FRAME_HEIGHT;
+    }
+    ROIParams roi = { 0.25f, 0.25f, 0.5f, 0.5f };
+    run("roi_test", boxes.size(), ops, [&]() {
+        volatile guint inside = 0;
+        guint64 start = now_ns();
+        for (guint64 i = 0; i < ops; i++) {
+            inside += is_bbox_in_roi(&boxes[i & 4095], &roi, FRAME_WIDTH, FRAME_HEIGHT);
+        }
+        return now_ns() - start;
+    });
+}
+
+static void bench_tracker_frames(GTimer *app_timer) {
+    const guint frames = 20000;
+    const guint64 ops = (guint64)frames * OBJECTS_PER_FRAME;
+    std::vector<NvDsObjectMeta> objs(OBJECTS_PER_FRAME);
+
+    // Sin transiciones: todos dentro del ROI y un umbral inalcanzable
+    run("tracker_steady", OBJECTS_PER_FRAME, ops, [&]() {
+        TrackerContext ctx;
+        tracker_setup(&ctx, app_timer, 1000000);
+        for (guint i = 0; i < OBJECTS_PER_FRAME; i++) {
+            object_at(&objs[i], i + 1, 0.3f + 0.005f * i, 0.5f);
+        }
+        guint64 start = now_ns();
+        for (guint f = 0; f < frames; f++) {
+            for (NvDsObjectMeta &obj : objs) {
+                tracker_process_object(&ctx, &obj, FRAME_WIDTH, FRAME_HEIGHT);
+            }
+        }
+        guint64 elapsed = now_ns() - start;
+        tracker_destroy(&ctx);
+        return elapsed;
+    });
+
+    // Umbral 0: dentro -> alerta -> fuera, una transición por objeto y frame
+    guint64 events = 0;
+    run("tracker_transitions", OBJECTS_PER_FRAME, ops, [&]() {
+        TrackerContext ctx;
+        tracker_setup(&ctx, app_timer, 0);
+        events = 0;
+        guint64 start = now_ns();
+        for (guint f = 0; f < frames; f++) {
+            gfloat cy = (f % 3 == 2) ? 0.1f : 0.5f;
+            for (guint i = 0; i < OBJECTS_PER_FRAME; i++) {
+                objs[i].rect_params.top = cy * FRAME_HEIGHT - 30.0f;
+                events += tracker_process_object(&ctx, &objs[i], FRAME_WIDTH, FRAME_HEIGHT)
+                          != TRACK_EVENT_NONE;
+            }
+        }
+        guint64 elapsed = now_ns() - start;
+        tracker_destroy(&ctx);
+        return elapsed;
+    });
+    if (selected("tracker_transitions")) {
+        fprintf(stderr, "%-20s %.2f events/op\n", "", (gdouble)events / ops);
+    }
+}
+
+// Tabla con n tracks: inserción, búsqueda y reportes sobre la misma tabla
+static void bench_scale(GTimer *app_timer, guint64 n, const gchar *store_path) {
+    gboolean want_insert = selected("tracker_insert"), want_lookup = selected("tracker_lookup");
+    gboolean want_report = selected("report"), want_store = selected("report_store");
+    if (!want_insert && !want_lookup && !want_report && !want_store) return;
+
+    const guint64 lookups = 1000 * 1000;
+    std::mt19937_64 rng(n);
+    std::vector<guint64> order(lookups);
+    for (guint64 &id : order) id = 1 + rng() % n;
+
+    std::vector<gdouble> insert_ns, lookup_ns, report_ns, store_ns;
+    NvDsObjectMeta obj;
+    object_at(&obj, 0, 0.1f, 0.1f);
+    for (guint r = 0; r < g_options.repeat; r++) {
+        TrackerContext ctx;
+        tracker_setup(&ctx, app_timer, 1000000);
+        guint64 start = now_ns();
+        for (guint64 id = 1; id <= n; id++) {
+            obj.object_id = id;
+            tracker_process_object(&ctx, &obj, FRAME_WIDTH, FRAME_HEIGHT);
+        }
+        insert_ns.push_back((gdouble)(now_ns() - start) / n);
+
+        if (want_lookup) {
+            start = now_ns();
+            for (guint64 id : order) {
+                obj.object_id = id;
+                tracker_process_object(&ctx, &obj, FRAME_WIDTH, FRAME_HEIGHT);
+            }
+            lookup_ns.push_back((gdouble)(now_ns() - start) / lookups);
+        }
+
+        if (want_report || want_store) {
+            // Como al final de una corrida: todos pasaron por el ROI
+            guint64 i = 0;
+            for (auto &pair : ctx.tracked_objects) {
+                TrackInfo &info = pair.second;
+                info.entry_timestamp = (gdouble)(pair.first % 86400000) / 1000.0;
+                info.total_time = 1.0 + (gdouble)(i % 600) / 10.0;
+                info.alert_triggered = (i % 4) == 0;
+                info.zone = 0;
+                info.entry_zone = 0;
+                i++;
+            }
+            ReportExtras extras;
+            memset(&extras, 0, sizeof(extras));
+            if (want_report) {
+                start = now_ns();
+                generate_report(&ctx, "/dev/null", &extras);
+                report_ns.push_back((gdouble)(now_ns() - start) / n);
+            }
+            if (want_store) {
+                std::vector<const TrackInfo *> rows;
+                rows.reserve(ctx.tracked_objects.size());
+                for (const auto &pair : ctx.tracked_objects) rows.push_back(&pair.second);
+                std::sort(rows.begin(), rows.end(), [](const TrackInfo *a, const TrackInfo *b) {
+                    return a->entry_timestamp < b->entry_timestamp;
+                });
+                start = now_ns();
+                report_store_write(store_path, &ctx, rows);
+                store_ns.push_back((gdouble)(now_ns() - start) / n);
+                unlink(store_path);
+            }
+        }
+        tracker_destroy(&ctx);
+    }
+    if (want_insert) record("tracker_insert", n, n, insert_ns);
+    if (want_lookup) record("tracker_lookup", n, lookups, lookup_ns);
+    if (want_report) record("report", n, n, report_ns);
+    if (want_store) record("report_store", n, n, store_ns);
+}
+
+static gboolean write_results(FILE *out) {
+    gchar date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    fprintf(out, "# microbench %s g++ %s repeat=%u\n", date, __VERSION__, g_options.repeat);
+    fprintf(out, "benchmark,size,ops,ns_per_op,min_ns_per_op\n");
+    for (const BenchResult &r : g_results) {
+        fprintf(out, "%s,%" G_GUINT64_FORMAT ",%" G_GUINT64_FORMAT ",%.2f,%.2f\n",
+                r.name.c_str(), r.size, r.ops, r.ns_per_op, r.min_ns_per_op);
+    }
+    return fflush(out) == 0;
+}
+
+// 0 si ninguna mediana empeoró más del umbral, 2 si alguna sí, 1 en error
+static gint compare_baseline(const gchar *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "No se pudo leer la referencia %s\n", path);
+        return 1;
+    }
+    std::vector<BenchResult> base;
+    gchar line[256];
+    while (fgets(line, sizeof(line), f)) {
+        gchar name[64];
+        unsigned long long size, ops;
+        gdouble ns, min_ns;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%63[^,],%llu,%llu,%lf,%lf", name, &size, &ops, &ns, &min_ns) == 5) {
+            BenchResult r;
+            r.name = name;
+            r.size = size;
+            r.ops = ops;
+            r.ns_per_op = ns;
+            r.min_ns_per_op = min_ns;
+            base.push_back(r);
+        }
+    }
+    fclose(f);
+
+    gint status = 0;
+    fprintf(stderr, "\n%-20s %9s %12s %12s %8s\n", "benchmark", "size", "base ns", "ns", "delta");
+    for (const BenchResult &r : g_results) {
+        auto it = std::find_if(base.begin(), base.end(), [&](const BenchResult &b) {
+            return b.name == r.name && b.size == r.size;
+        });
+        if (it == base.end() || it->ns_per_op <= 0.0) {
+            fprintf(stderr, "%-20s %9" G_GUINT64_FORMAT " %12s %12.1f %8s\n",
+                    r.name.c_str(), r.size, "-", r.ns_per_op, "nuevo");
+            continue;
+        }
+        gdouble delta = 100.0 * (r.ns_per_op - it->ns_per_op) / it->ns_per_op;
+        gboolean regressed = delta > g_options.threshold;
+        if (regressed) status = 2;
+        fprintf(stderr, "%-20s %9" G_GUINT64_FORMAT " %12.1f %12.1f %+7.1f%%%s\n",
+                r.name.c_str(), r.size, it->ns_per_op, r.ns_per_op, delta,
+                regressed ? "  REGRESION" : "");
+    }
+    return status;
+}
+
+int main(int argc, char **argv) {
+    g_options.out = NULL;
+    g_options.baseline = NULL;
+    g_options.filter = NULL;
+    g_options.repeat = 5;
+    g_options.max_tracks = 1000000;
+    g_options.threshold = 10.0;
+    for (int i = 1; i < argc; i++) {
+        if (g_strcmp0(argv[i], "--out") == 0 && i + 1 < argc) {
+            g_options.out = argv[++i];
+        } else if (g_strcmp0(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            g_options.baseline = argv[++i];
+        } else if (g_strcmp0(argv[i], "--filter") == 0 && i + 1 < argc) {
+            g_options.filter = argv[++i];
+        } else if (g_strcmp0(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            gint repeat = atoi(argv[++i]);
+            g_options.repeat = repeat > 0 ? (guint)repeat : 1;
+        } else if (g_strcmp0(argv[i], "--max-tracks") == 0 && i + 1 < argc) {
+            g_options.max_tracks = g_ascii_strtoull(argv[++i], NULL, 10);
+        } else if (g_strcmp0(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            g_options.threshold = g_strtod(argv[++i], NULL);
+        } else {
+            fprintf(stderr, "Uso: %s [--out <csv>] [--repeat N] [--max-tracks N] [--filter texto]\n"
+                            "          [--baseline <csv>] [--threshold %%]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Solo errores: la alerta se registra en cada frame que dura
+    static Logger logger;
+    logger_init(&logger, LOG_LEVEL_ERROR, LOG_FORMAT_PLAIN, "/dev/null");
+    g_set_print_handler(quiet_print);
+    GTimer *app_timer = g_timer_new();
+    gchar store_dir[] = "/tmp/microbench-XXXXXX";
+    if (!mkdtemp(store_dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    gchar *store_path = g_build_filename(store_dir, "report.cols", NULL);
+
+    bench_roi_test();
+    bench_tracker_frames(app_timer);
+    for (guint64 n = 10000; n <= g_options.max_tracks; n *= 10) {
+        bench_scale(app_timer, n, store_path);
+    }
+
+    rmdir(store_dir);
+    g_free(store_path);
+    g_timer_destroy(app_timer);
+    logger_destroy(&logger);
+
+    gint status = 0;
+    FILE *out = g_options.out ? fopen(g_options.out, "w") : stdout;
+    if (!out || !write_results(out)) {
+        fprintf(stderr, "No se pudo escribir %s\n", g_options.out ? g_options.out : "stdout");
+        status = 1;
+    }
+    if (out && out != stdout) fclose(out);
+    if (status == 0 && g_options.baseline) status = compare_baseline(g_options.baseline);
+    return status;
+}
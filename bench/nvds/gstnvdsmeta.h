@@ -0,0 +1,48 @@
+/*
+ * gstnvdsmeta.h (solo para bench/)
+ * Subconjunto de los metadatos de DeepStream que usa el tracker
+ *
+ * Permite compilar track_info.cpp y el reporte sin el SDK de DeepStream
+ * para medirlos en cualquier máquina Linux. Los campos que lee el tracker
+ * tienen los mismos nombres y tipos que en DeepStream 6.0 (nvll_osd_struct.h
+ * y nvdsmeta.h); el resto se omite. No se usa en el build de la aplicación.
+ */
+
+#ifndef BENCH_GSTNVDSMETA_H
+#define BENCH_GSTNVDSMETA_H
+
+#include <glib.h>
+
+#define MAX_LABEL_SIZE 128
+
+typedef struct {
+    double red;
+    double green;
+    double blue;
+    double alpha;
+} NvOSD_ColorParams;
+
+typedef struct {
+    float left;
+    float top;
+    float width;
+    float height;
+    unsigned int border_width;
+    NvOSD_ColorParams border_color;
+    unsigned int has_bg_color;
+    unsigned int reserved;
+    NvOSD_ColorParams bg_color;
+    int has_color_info;
+    int color_id;
+} NvOSD_RectParams;
+
+typedef struct {
+    gint unique_component_id;
+    gint class_id;
+    guint64 object_id;
+    gfloat confidence;
+    NvOSD_RectParams rect_params;
+    gchar obj_label[MAX_LABEL_SIZE];
+} NvDsObjectMeta;
+
+#endif // BENCH_GSTNVDSMETA_H
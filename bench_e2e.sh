@@ -0,0 +1,166 @@
+#!/bin/bash
+
+# Benchmark extremo a extremo con clips generados
+# Universidad de Costa Rica - IE0301
+#
+# Genera clips H.264 sintéticos (videotestsrc con objetos en movimiento) en
+# una matriz de resoluciones, frame rates y duraciones, procesa cada uno en
+# modo video y en modo udp y reúne en un solo CSV: FPS, tiempo hasta el
+# primer frame, p50/p99 de la latencia por frame, RSS pico y CPU por hilo.
+# Los clips se reutilizan entre corridas (mismo contenido, mismo encoder).
+# Uso:
+#   ./bench_e2e.sh
+#   RESOLUTIONS="1280x720" FRAMERATES="30" DURATIONS="10" ./bench_e2e.sh
+
+RESOLUTIONS="${RESOLUTIONS:-640x360 1280x720 1920x1080}"
+FRAMERATES="${FRAMERATES:-15 30}"
+DURATIONS="${DURATIONS:-10 30}"
+MODES="${MODES:-video udp}"
+OUT_DIR="resultados_e2e"
+CLIP_DIR="$OUT_DIR/clips"
+RESULTS="$OUT_DIR/e2e_bench.csv"
+PORT=5000
+
+if [ ! -f "./bin/roi_surveillance" ]; then
+    echo "ERROR: Ejecutable no encontrado. Ejecuta 'make' primero"
+    exit 1
+fi
+# Sin latency_probe el modo udp se mide igual, pero sin latencia de red
+HAVE_PROBE=0
+[ -f "./bin/latency_probe" ] && HAVE_PROBE=1
+
+mkdir -p "$CLIP_DIR"
+rm -f "$OUT_DIR"/run_*
+
+# Encoder H.264: hardware si existe, si no x264
+enc() {
+    if gst-inspect-1.0 nvv4l2h264enc > /dev/null 2>&1; then
+        echo "nvvideoconvert ! video/x-raw(memory:NVMM) ! nvv4l2h264enc ! h264parse"
+    else
+        echo "x264enc tune=zerolatency ! h264parse"
+    fi
+}
+
+# Clip con una pelota que rebota sobre fondo con ruido: hay movimiento en
+# todo el cuadro y el contenido es el mismo en cada máquina
+make_clip() {
+    local path=$1 width=$2 height=$3 fps=$4 seconds=$5
+    [ -s "$path" ] && return 0
+    gst-launch-1.0 -q videotestsrc pattern=ball motion=sweep background-color=0xff404040 \
+        num-buffers=$((seconds * fps)) ! \
+        video/x-raw,width=$width,height=$height,framerate=$fps/1 ! \
+        $(enc) ! mp4mux ! filesink location="$path"
+}
+
+{
+    echo "fecha: $(date -Iseconds)"
+    echo "host: $(uname -a)"
+    echo "cpus: $(nproc)"
+    echo "commit: $(git rev-parse --short HEAD 2>/dev/null || echo '?')"
+    echo "gstreamer: $(gst-launch-1.0 --version | head -n 1)"
+    echo "encoder: $(enc)"
+} > "$OUT_DIR/entorno.txt"
+
+echo "Generando clips..."
+CLIPS=()
+for res in $RESOLUTIONS; do
+    for fps in $FRAMERATES; do
+        for seconds in $DURATIONS; do
+            name="${res}_${fps}fps_${seconds}s"
+            make_clip "$CLIP_DIR/$name.mp4" "${res%x*}" "${res#*x}" "$fps" "$seconds" ||
+                { echo "  ERROR generando $name"; continue; }
+            CLIPS+=("$name")
+        done
+    done
+done
+
+total=$(( ${#CLIPS[@]} * $(echo $MODES | wc -w) ))
+i=0
+for name in "${CLIPS[@]}"; do
+    for mode in $MODES; do
+        i=$((i + 1))
+        run="run_${name}_${mode}"
+        echo "[$i/$total] $name ($mode)"
+        args=(vi-file "$CLIP_DIR/$name.mp4" --mode "$mode"
+              --bench-out "$OUT_DIR/$run.bench.csv"
+              --file-name "$OUT_DIR/$run.report.txt")
+        PID_PROBE=""
+        if [ "$mode" = "udp" ]; then
+            args+=(--udp-host 127.0.0.1 --udp-port $PORT)
+            if [ $HAVE_PROBE -eq 1 ]; then
+                args+=(--latency-log "$OUT_DIR/$run.ingest.bin")
+                ./bin/latency_probe --port $PORT --ingest "$OUT_DIR/$run.ingest.bin" \
+                    > "$OUT_DIR/$run.net.csv" 2> /dev/null &
+                PID_PROBE=$!
+                sleep 1
+            fi
+        else
+            args+=(vo-file "$OUT_DIR/$run.mp4")
+        fi
+
+        ./bin/roi_surveillance "${args[@]}" > "$OUT_DIR/$run.log" 2>&1
+        status=$?
+        if [ $status -ne 0 ]; then
+            # Sin emisor el receptor no terminaría: se detiene y la fila queda como error
+            echo "  ERROR: codigo $status (ver $OUT_DIR/$run.log)"
+            touch "$OUT_DIR/$run.failed"
+            [ -n "$PID_PROBE" ] && kill "$PID_PROBE" 2>/dev/null
+        fi
+        [ -n "$PID_PROBE" ] && wait "$PID_PROBE" 2>/dev/null
+        rm -f "$OUT_DIR/$run.mp4" "$OUT_DIR/$run.ingest.bin"
+    done
+done
+
+# Un solo CSV: parámetros del clip + fila de --bench-out + latencia de red
+python3 - "$OUT_DIR" "$RESULTS" "${CLIPS[@]}" <<PY
+import csv, os, sys
+out_dir, results, clips = sys.argv[1], sys.argv[2], sys.argv[3:]
+modes = "$MODES".split()
+fields = ["clip", "width", "height", "input_fps", "duration_s", "mode", "status", "frames", "fps",
+          "first_frame_s", "frame_p50_ms", "frame_p99_ms", "net_p50_ms", "net_p99_ms",
+          "peak_rss_mb", "cpu_pct", "threads"]
+rows = []
+for clip in clips:
+    res, fps, dur = clip.split("_")
+    for mode in modes:
+        run = os.path.join(out_dir, "run_%s_%s" % (clip, mode))
+        row = dict(clip=clip, width=res.split("x")[0], height=res.split("x")[1],
+                   input_fps=fps[:-3], duration_s=dur[:-1], mode=mode, status="ok")
+        # Una corrida fallida puede dejar CSV parciales: no se mezclan
+        if os.path.exists(run + ".failed"):
+            row["status"] = "error"
+            rows.append(row)
+            continue
+        try:
+            bench = list(csv.DictReader(open(run + ".bench.csv")))[-1]
+            row.update({k: bench[k] for k in fields if k in bench})
+        except (OSError, IndexError):
+            pass
+        try:
+            net = list(csv.DictReader(open(run + ".net.csv")))[-1]
+            row["net_p50_ms"], row["net_p99_ms"] = net["lat_p50_ms"], net["lat_p99_ms"]
+        except (OSError, IndexError, KeyError):
+            pass
+        rows.append(row)
+
+with open(results, "w", newline="") as f:
+    w = csv.DictWriter(f, fieldnames=fields, restval="")
+    w.writeheader()
+    w.writerows(rows)
+
+print("")
+print("==============================================")
+print("Resultados (%s)" % results)
+print("==============================================")
+print("%-22s %-5s %7s %7s %8s %8s %8s %8s %6s" %
+      ("clip", "modo", "fps", "ttff_s", "p50_ms", "p99_ms", "red_p99", "rss_mb", "cpu%"))
+for r in rows:
+    if r["status"] != "ok" or not r.get("fps"):
+        print("%-22s %-5s  (%s)" % (r["clip"], r["mode"],
+                                    "error" if r["status"] != "ok" else "sin datos"))
+        continue
+    print("%-22s %-5s %7.1f %7.3f %8.2f %8.2f %8s %8.1f %6.0f" %
+          (r["clip"], r["mode"], float(r["fps"]), float(r["first_frame_s"]),
+           float(r["frame_p50_ms"]), float(r["frame_p99_ms"]), r.get("net_p99_ms") or "-",
+           float(r["peak_rss_mb"]), float(r["cpu_pct"])))
+PY
@@ -0,0 +1,69 @@
+#!/bin/bash
+
+# Benchmark de topologías de hilos
+# Universidad de Costa Rica - IE0301
+#
+# Procesa el mismo video con varias topologías (--topology) y compara FPS,
+# latencia por etapa y CPU. Uso:
+#   ./bench_topology.sh <video> ["topologia" ...]
+# Sin topologías se usa una lista representativa para 4 núcleos.
+
+VIDEO="${1:-videosPrueba/videoCarros.mp4}"
+shift
+OUT_DIR="resultados_topologia"
+RESULTS="$OUT_DIR/topology_bench.csv"
+
+if [ $# -gt 0 ]; then
+    LAYOUTS=("$@")
+else
+    LAYOUTS=(
+        "none"
+        "infer"
+        "infer,osd"
+        "infer,osd,encode"
+        "mux,infer,track,osd,encode,output"
+        "infer:2,osd:2,encode:2"
+        "infer@1,osd@2,encode@3"
+    )
+fi
+
+if [ ! -f "./bin/roi_surveillance" ]; then
+    echo "ERROR: Ejecutable no encontrado. Ejecuta 'make' primero"
+    exit 1
+fi
+if [ ! -f "$VIDEO" ]; then
+    echo "ERROR: Video no encontrado: $VIDEO"
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+rm -f "$RESULTS"
+
+i=0
+for layout in "${LAYOUTS[@]}"; do
+    i=$((i + 1))
+    echo "[$i/${#LAYOUTS[@]}] Topologia: $layout"
+    ./bin/roi_surveillance \
+        vi-file "$VIDEO" \
+        vo-file "$OUT_DIR/out_$i.mp4" \
+        --topology "$layout" \
+        --bench-out "$RESULTS" \
+        --file-name "$OUT_DIR/report_$i.txt" \
+        > "$OUT_DIR/run_$i.log" 2>&1 || echo "  ERROR (ver $OUT_DIR/run_$i.log)"
+    rm -f "$OUT_DIR/out_$i.mp4"
+done
+
+echo ""
+echo "=============================================="
+echo "Resultados ordenados por FPS ($RESULTS)"
+echo "=============================================="
+# topologia, fps, cpu y latencia promedio por etapa
+python3 - "$RESULTS" <<'PY'
+import csv, sys
+rows = list(csv.DictReader(open(sys.argv[1])))
+stages = ["mux", "infer", "track", "osd", "encode", "output"]
+print("%-40s %7s %6s  %s" % ("topologia", "fps", "cpu%", "  ".join("%6s" % s for s in stages)))
+for r in sorted(rows, key=lambda r: -float(r["fps"])):
+    lat = "  ".join("%6.1f" % float(r[s + "_avg_ms"]) for s in stages)
+    print("%-40s %7.1f %6.0f  %s" % (r["topology"], float(r["fps"]), float(r["cpu_pct"]), lat))
+PY
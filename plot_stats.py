@@ -1,16 +1,18 @@
 #!/usr/bin/env python3
 """
-Visualizador de estadisticas de tegrastats
+Visualizador de estadisticas de recursos
 Universidad de Costa Rica - IE0301
 
 Uso:
-    python3 plot_stats.py                    # Procesa todos los logs en stats/
-    python3 plot_stats.py archivo.log        # Procesa un archivo especifico
-    python3 plot_stats.py --all              # Genera graficos combinados
+    python3 plot_stats.py                    # Procesa todos los archivos en stats/
+    python3 plot_stats.py archivo.csv        # CSV de --resource-log
+    python3 plot_stats.py archivo.log        # Log de tegrastats (formato anterior)
+    python3 plot_stats.py --all              # Genera graficos combinados (tegrastats)
 """
 
 import re
 import sys
+import csv
 import glob
 from pathlib import Path
 import matplotlib.pyplot as plt
@@ -182,6 +184,69 @@ def plot_single_video(filepath, output_dir='plots'):
     
     plt.close()
 
+def parse_resource_csv(filepath):
+    """Lee el CSV de --resource-log; las columnas vacias quedan en None"""
+    data = {'time': [], 'pts': [], 'cpu_pct': [], 'rss_mb': [],
+            'gpu_load_pct': [], 'emc_load_pct': []}
+
+    def value(row, key, scale=1.0):
+        return float(row[key]) * scale if row.get(key) else None
+
+    with open(filepath, newline='') as f:
+        for row in csv.DictReader(f):
+            data['time'].append(float(row['t_s']))
+            data['pts'].append(value(row, 'pts_s'))
+            data['cpu_pct'].append(value(row, 'cpu_pct'))
+            data['rss_mb'].append(value(row, 'rss_kb', 1.0 / 1024.0))
+            data['gpu_load_pct'].append(value(row, 'gpu_load_pct'))
+            data['emc_load_pct'].append(value(row, 'emc_load_pct'))
+    return data
+
+def plot_resource_csv(filepath, output_dir='plots'):
+    """Genera graficos para un CSV de --resource-log"""
+    Path(output_dir).mkdir(exist_ok=True)
+
+    video_name = Path(filepath).stem.replace('_resources', '')
+    print(f"Procesando: {video_name}")
+
+    data = parse_resource_csv(filepath)
+    if not data['time']:
+        print(f"WARNING: No se encontraron datos en {filepath}")
+        return
+
+    fig, axes = plt.subplots(2, 2, figsize=(15, 10))
+    fig.suptitle(f'Estadísticas de Recursos - {video_name}', fontsize=16, fontweight='bold')
+
+    series = [
+        (axes[0, 0], 'cpu_pct', 'b-', 'CPU del proceso (% de un núcleo)'),
+        (axes[0, 1], 'gpu_load_pct', 'g-', 'Uso de GPU (%)'),
+        (axes[1, 0], 'rss_mb', 'r-', 'Memoria residente (MB)'),
+        (axes[1, 1], 'emc_load_pct', 'm-', 'Uso de EMC (%)'),
+    ]
+    for ax, key, style, title in series:
+        points = [(t, v) for t, v in zip(data['time'], data[key]) if v is not None]
+        ax.set_title(title, fontweight='bold')
+        ax.set_xlabel('Tiempo (s)', fontsize=12)
+        ax.grid(True, alpha=0.3)
+        if not points:
+            ax.text(0.5, 0.5, 'No disponible', ha='center', va='center',
+                    transform=ax.transAxes)
+            continue
+        ax.plot([p[0] for p in points], [p[1] for p in points], style, linewidth=2)
+
+    plt.tight_layout()
+    output_file = f"{output_dir}/{video_name}_resources.png"
+    plt.savefig(output_file, dpi=300, bbox_inches='tight')
+    print(f"[OK] Grafico guardado: {output_file}")
+    plt.close()
+
+    print(f"\nEstadisticas de {video_name}:")
+    for key, label in [('cpu_pct', 'CPU'), ('gpu_load_pct', 'GPU'),
+                       ('rss_mb', 'RSS (MB)'), ('emc_load_pct', 'EMC')]:
+        values = [v for v in data[key] if v is not None]
+        if values:
+            print(f"   {label:<9} promedio {sum(values) / len(values):8.1f}   maximo {max(values):8.1f}")
+
 def plot_all_combined(stats_dir='stats', output_dir='plots'):
     """Genera grafico combinado de todos los videos"""
     Path(output_dir).mkdir(exist_ok=True)
@@ -248,25 +313,31 @@ def main():
     if len(sys.argv) > 1:
         if sys.argv[1] == '--all':
             plot_all_combined()
+        elif sys.argv[1].endswith('.csv'):
+            plot_resource_csv(sys.argv[1])
         else:
             plot_single_video(sys.argv[1])
     else:
         # Procesar todos los archivos en stats/
+        csv_files = glob.glob("stats/*_resources.csv")
         files = glob.glob("stats/*_stats.log")
-        if not files:
+        if not files and not csv_files:
             print("WARNING: No se encontraron archivos en stats/")
-            print("Ejecuta primero: ./quick_test.sh")
+            print("Ejecuta primero: ./test_videos.sh")
             return
         
-        print(f"Encontrados {len(files)} archivos de estadisticas")
+        print(f"Encontrados {len(files) + len(csv_files)} archivos de estadisticas")
         print()
         
+        for filepath in sorted(csv_files):
+            plot_resource_csv(filepath)
         for filepath in sorted(files):
             plot_single_video(filepath)
         
-        # Generar grafico combinado
-        print("Generando grafico combinado...")
-        plot_all_combined()
+        # Generar grafico combinado (logs de tegrastats)
+        if files:
+            print("Generando grafico combinado...")
+            plot_all_combined()
     
     print()
     print("=" * 60)
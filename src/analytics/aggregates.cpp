@@ -0,0 +1,206 @@
+/*
+ * aggregates.cpp
+ * Implementación de las estadísticas en ventanas deslizantes
+ */
+
+#include "aggregates.hpp"
+#include "log/logger.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const guint WINDOW_MINUTES[AGG_WINDOWS] = { 5, 15, 60 };
+
+static inline guint window_buckets(gint w) {
+    return WINDOW_MINUTES[w] * 60 / AGG_BUCKET_SECONDS;
+}
+
+static void sketch_add(DwellSketch *s, gdouble seconds) {
+    guint bin = 0;
+    if (seconds >= AGG_SKETCH_MIN) {
+        bin = 1 + (guint)(log(seconds / AGG_SKETCH_MIN) / log(AGG_SKETCH_GAMMA));
+        if (bin >= AGG_SKETCH_BINS) bin = AGG_SKETCH_BINS - 1;
+    }
+    s->bins[bin]++;
+    s->count++;
+    s->sum += seconds;
+}
+
+static void sketch_subtract(DwellSketch *dst, const DwellSketch *src) {
+    if (src->count == 0) return;
+    for (guint i = 0; i < AGG_SKETCH_BINS; i++) dst->bins[i] -= src->bins[i];
+    dst->count -= src->count;
+    dst->sum -= src->sum;
+}
+
+// Centro geométrico del bin que contiene el cuantil q
+static gdouble sketch_quantile(const DwellSketch *s, gdouble q) {
+    if (s->count == 0) return 0.0;
+    guint64 rank = (guint64)(q * (s->count - 1));
+    guint64 seen = 0;
+    for (guint i = 0; i < AGG_SKETCH_BINS; i++) {
+        seen += s->bins[i];
+        if (seen > rank) {
+            if (i == 0) return AGG_SKETCH_MIN;
+            return AGG_SKETCH_MIN * pow(AGG_SKETCH_GAMMA, i - 0.5);
+        }
+    }
+    return AGG_SKETCH_MIN * pow(AGG_SKETCH_GAMMA, AGG_SKETCH_BINS - 1);
+}
+
+void aggregates_init(Aggregates *agg, guint log_interval_s) {
+    memset(agg->buckets, 0, sizeof(agg->buckets));
+    memset(agg->totals, 0, sizeof(agg->totals));
+    agg->started = FALSE;
+    agg->first_index = 0;
+    agg->current_index = 0;
+    agg->pts_s = 0;
+    agg->last_publish_s = G_MAXUINT64;
+    agg->log_interval_us = (gint64)log_interval_s * G_USEC_PER_SEC;
+    agg->next_log_us = g_get_monotonic_time() + agg->log_interval_us;
+    agg->seq.store(0, std::memory_order_relaxed);
+    memset(&agg->published, 0, sizeof(agg->published));
+    for (gint w = 0; w < AGG_WINDOWS; w++) {
+        agg->published.windows[w].minutes = WINDOW_MINUTES[w];
+    }
+}
+
+static void reset(Aggregates *agg, guint64 index) {
+    memset(agg->buckets, 0, sizeof(agg->buckets));
+    memset(agg->totals, 0, sizeof(agg->totals));
+    agg->first_index = index;
+    agg->current_index = index;
+    agg->buckets[index % AGG_BUCKETS].index = index;
+}
+
+// Abre el bucket index: lo que sale de cada ventana se resta de sus totales
+static void open_bucket(Aggregates *agg, guint64 index) {
+    for (gint w = 0; w < AGG_WINDOWS; w++) {
+        guint span = window_buckets(w);
+        if (index < agg->first_index + span) continue;
+        const AggBucket *old = &agg->buckets[(index - span) % AGG_BUCKETS];
+        if (old->index != index - span) continue;
+        AggTotals *t = &agg->totals[w];
+        t->entries -= old->entries;
+        t->alerts -= old->alerts;
+        t->frames -= old->frames;
+        t->occupancy_sum -= old->occupancy_sum;
+        sketch_subtract(&t->dwell, &old->dwell);
+    }
+    AggBucket *b = &agg->buckets[index % AGG_BUCKETS];
+    memset(b, 0, sizeof(*b));
+    b->index = index;
+    agg->current_index = index;
+}
+
+void aggregates_begin_frame(Aggregates *agg, GstClockTime pts) {
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return;
+    agg->pts_s = pts / GST_SECOND;
+    guint64 index = agg->pts_s / AGG_BUCKET_SECONDS;
+    if (!agg->started) {
+        agg->started = TRUE;
+        reset(agg, index);
+        return;
+    }
+    // Un salto hacia atrás (seek) o más largo que el anillo reinicia las ventanas
+    if (index < agg->current_index || index - agg->current_index >= AGG_BUCKETS) {
+        if (index != agg->current_index) reset(agg, index);
+        return;
+    }
+    while (agg->current_index < index) open_bucket(agg, agg->current_index + 1);
+}
+
+void aggregates_on_event(Aggregates *agg, TrackEvent event, gdouble dwell_seconds) {
+    if (!agg->started) return;
+    AggBucket *b = &agg->buckets[agg->current_index % AGG_BUCKETS];
+    switch (event) {
+        case TRACK_EVENT_ENTER:
+            b->entries++;
+            for (gint w = 0; w < AGG_WINDOWS; w++) agg->totals[w].entries++;
+            break;
+        case TRACK_EVENT_ALERT:
+            b->alerts++;
+            for (gint w = 0; w < AGG_WINDOWS; w++) agg->totals[w].alerts++;
+            break;
+        case TRACK_EVENT_EXIT:
+            sketch_add(&b->dwell, dwell_seconds);
+            for (gint w = 0; w < AGG_WINDOWS; w++) sketch_add(&agg->totals[w].dwell, dwell_seconds);
+            break;
+        default:
+            break;
+    }
+}
+
+static void compute_window(const Aggregates *agg, gint w, AggWindowStats *out) {
+    const AggTotals *t = &agg->totals[w];
+    guint span = window_buckets(w);
+    guint64 covered = MIN(agg->current_index - agg->first_index + 1, (guint64)span);
+
+    out->minutes = WINDOW_MINUTES[w];
+    out->covered_minutes = covered * AGG_BUCKET_SECONDS / 60.0;
+    out->entries = t->entries;
+    out->alerts = t->alerts;
+    out->entries_per_minute = t->entries / out->covered_minutes;
+    out->occupancy_mean = t->frames ? (gdouble)t->occupancy_sum / t->frames : 0.0;
+    out->occupancy_peak = 0;
+    for (guint64 i = 0; i < covered; i++) {
+        const AggBucket *b = &agg->buckets[(agg->current_index - i) % AGG_BUCKETS];
+        if (b->index == agg->current_index - i) {
+            out->occupancy_peak = MAX(out->occupancy_peak, b->peak_occupancy);
+        }
+    }
+    out->visits = t->dwell.count;
+    out->dwell_mean = t->dwell.count ? t->dwell.sum / t->dwell.count : 0.0;
+    out->dwell_p50 = sketch_quantile(&t->dwell, 0.50);
+    out->dwell_p95 = sketch_quantile(&t->dwell, 0.95);
+}
+
+void aggregates_format_window(const AggWindowStats *s, gchar *buf, gsize size) {
+    g_snprintf(buf, size,
+               "%um: %.1f entries/min, occupancy %.2f (peak %u), "
+               "dwell mean %.1f s p50 %.1f s p95 %.1f s, %u alerts",
+               s->minutes, s->entries_per_minute, s->occupancy_mean, s->occupancy_peak,
+               s->dwell_mean, s->dwell_p50, s->dwell_p95, s->alerts);
+}
+
+void aggregates_end_frame(Aggregates *agg, guint32 occupancy) {
+    if (!agg->started) return;
+    AggBucket *b = &agg->buckets[agg->current_index % AGG_BUCKETS];
+    b->frames++;
+    b->occupancy_sum += occupancy;
+    b->peak_occupancy = MAX(b->peak_occupancy, occupancy);
+    for (gint w = 0; w < AGG_WINDOWS; w++) {
+        agg->totals[w].frames++;
+        agg->totals[w].occupancy_sum += occupancy;
+    }
+
+    // Publicación una vez por segundo de video
+    if (agg->pts_s == agg->last_publish_s) return;
+    agg->last_publish_s = agg->pts_s;
+
+    guint32 seq = agg->seq.load(std::memory_order_relaxed);
+    agg->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    agg->published.occupancy = occupancy;
+    for (gint w = 0; w < AGG_WINDOWS; w++) compute_window(agg, w, &agg->published.windows[w]);
+    agg->seq.store(seq + 2, std::memory_order_release);
+
+    if (agg->log_interval_us > 0 && g_get_monotonic_time() >= agg->next_log_us) {
+        agg->next_log_us = g_get_monotonic_time() + agg->log_interval_us;
+        for (gint w = 0; w < AGG_WINDOWS; w++) {
+            gchar line[160];
+            aggregates_format_window(&agg->published.windows[w], line, sizeof(line));
+            ROI_LOG_INFO(LOG_CAT_APP, "Window %s", line);
+        }
+    }
+}
+
+void aggregates_read(const Aggregates *agg, AggView *view) {
+    guint32 before, after;
+    do {
+        before = agg->seq.load(std::memory_order_acquire);
+        memcpy(view, &agg->published, sizeof(*view));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = agg->seq.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
@@ -0,0 +1,114 @@
+/*
+ * aggregates.hpp
+ * Estadísticas en ventanas deslizantes (5, 15 y 60 minutos)
+ *
+ * El probe del OSD alimenta el módulo con las transiciones del tracker
+ * (entrada, alerta, salida con su tiempo en el ROI) y con la ocupación de
+ * cada frame. El tiempo es el del video (PTS) dividido en buckets de 10 s en
+ * un anillo que cubre la ventana más larga. Cada ventana mantiene totales
+ * acumulados: un evento suma en el bucket actual y en los totales (O(1)) y
+ * al rotar se resta el bucket que sale de cada ventana. Los tiempos en el
+ * ROI van a un sketch de bins logarítmicos (~5% de error relativo) que
+ * también se puede restar, así p50/p95 no dependen del largo de la historia.
+ *
+ * Una vez por segundo de video se calculan las estadísticas y se publican
+ * con un seqlock: las métricas y el log las leen sin bloquear al probe.
+ */
+
+#ifndef AGGREGATES_HPP
+#define AGGREGATES_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include <atomic>
+#include "config/track_info.hpp"
+
+#define AGG_BUCKET_SECONDS 10
+#define AGG_BUCKETS 360                 // 60 minutos
+#define AGG_WINDOWS 3
+#define AGG_SKETCH_BINS 128
+#define AGG_SKETCH_MIN 0.1              // s; el bin 0 agrupa lo menor
+#define AGG_SKETCH_GAMMA 1.1            // Razón entre bins consecutivos
+#define AGG_DEFAULT_LOG_INTERVAL_S 60
+
+// Tiempos en el ROI por bins logarítmicos
+struct DwellSketch {
+    guint32 bins[AGG_SKETCH_BINS];
+    guint32 count;
+    gdouble sum;
+};
+
+struct AggBucket {
+    guint64 index;                      // Número absoluto de bucket (PTS / 10 s)
+    guint32 entries;
+    guint32 alerts;
+    guint32 peak_occupancy;
+    guint32 frames;
+    guint64 occupancy_sum;              // Suma de la ocupación de cada frame
+    DwellSketch dwell;                  // Visitas terminadas
+};
+
+struct AggTotals {
+    guint32 entries;
+    guint32 alerts;
+    guint32 frames;
+    guint64 occupancy_sum;
+    DwellSketch dwell;
+};
+
+// Valores publicados de una ventana
+struct AggWindowStats {
+    guint minutes;
+    gdouble covered_minutes;            // Menor que minutes al inicio de la corrida
+    guint32 entries;
+    guint32 alerts;
+    gdouble entries_per_minute;
+    gdouble occupancy_mean;
+    guint32 occupancy_peak;
+    guint32 visits;                     // Salidas del ROI con tiempo medido
+    gdouble dwell_mean;
+    gdouble dwell_p50;
+    gdouble dwell_p95;
+};
+
+struct AggView {
+    guint32 occupancy;                  // Vehículos en el ROI en el último frame
+    AggWindowStats windows[AGG_WINDOWS];
+};
+
+struct Aggregates {
+    // Solo el probe
+    AggBucket buckets[AGG_BUCKETS];
+    AggTotals totals[AGG_WINDOWS];
+    gboolean started;
+    guint64 first_index;
+    guint64 current_index;
+    guint64 pts_s;                      // Segundo de video del frame actual
+    guint64 last_publish_s;
+    gint64 log_interval_us;             // 0 = sin log periódico
+    gint64 next_log_us;
+
+    // Publicado (seqlock: impar mientras se escribe)
+    std::atomic<guint32> seq;
+    AggView published;
+};
+
+// log_interval_s: segundos entre líneas de log (0 = sin log)
+void aggregates_init(Aggregates *agg, guint log_interval_s);
+
+// Al inicio de cada frame: rota los buckets hasta el PTS
+void aggregates_begin_frame(Aggregates *agg, GstClockTime pts);
+
+// Transición de un track; dwell_seconds solo con TRACK_EVENT_EXIT
+void aggregates_on_event(Aggregates *agg, TrackEvent event, gdouble dwell_seconds);
+
+// Al final del frame: ocupación y, una vez por segundo de video, publicación
+void aggregates_end_frame(Aggregates *agg, guint32 occupancy);
+
+// Copia consistente de lo publicado (desde cualquier hilo)
+void aggregates_read(const Aggregates *agg, AggView *view);
+
+// "5m: 2.4 entries/min, occupancy 1.30 (peak 4), dwell mean 6.1 s p50 5.0 s p95 12.3 s, 3 alerts"
+void aggregates_format_window(const AggWindowStats *stats, gchar *buf, gsize size);
+
+#endif // AGGREGATES_HPP
@@ -0,0 +1,132 @@
+/*
+ * heatmap.cpp
+ * Implementación del mapa de ocupación
+ */
+
+#include "heatmap.hpp"
+#include <stdio.h>
+
+gboolean heatmap_parse_grid(const gchar *spec, guint *width, guint *height) {
+    guint w, h;
+    gchar extra;
+    if (!spec || sscanf(spec, "%ux%u%c", &w, &h, &extra) != 2) return FALSE;
+    if (w == 0 || h == 0 || (gsize)w * h > HEATMAP_MAX_CELLS) return FALSE;
+    *width = w;
+    *height = h;
+    return TRUE;
+}
+
+static gpointer writer_thread(gpointer data) {
+    Heatmap *heatmap = (Heatmap *)data;
+    g_mutex_lock(&heatmap->lock);
+    while (heatmap->running) {
+        if (!heatmap->staged_pending) {
+            g_cond_wait(&heatmap->cond, &heatmap->lock);
+            continue;
+        }
+        // Con el lock tomado: el probe solo lo intenta con trylock
+        if (heatmap_grid_save(&heatmap->staged, heatmap->path)) {
+            heatmap->snapshots++;
+        } else {
+            g_printerr("Heatmap: could not write %s\n", heatmap->path);
+        }
+        heatmap->staged_pending = FALSE;
+    }
+    g_mutex_unlock(&heatmap->lock);
+    return NULL;
+}
+
+gboolean heatmap_init(Heatmap *heatmap, const gchar *path, guint width, guint height,
+                      guint interval_s) {
+    heatmap->path = g_strdup(path);
+    heatmap->thread = NULL;
+    g_mutex_init(&heatmap->lock);
+    g_cond_init(&heatmap->cond);
+    if (!heatmap_grid_init(&heatmap->grid, width, height) ||
+        !heatmap_grid_init(&heatmap->staged, width, height)) {
+        g_printerr("Heatmap: invalid grid %ux%u\n", width, height);
+        return FALSE;
+    }
+    heatmap->frame_count = 0;
+    heatmap->last_pts = GST_CLOCK_TIME_NONE;
+    heatmap->frame_us = HEATMAP_DEFAULT_FRAME_US;
+    heatmap->interval_us = (gint64)(interval_s > 0 ? interval_s : HEATMAP_DEFAULT_INTERVAL_S)
+                           * G_USEC_PER_SEC;
+    heatmap->next_snapshot_us = g_get_monotonic_time() + heatmap->interval_us;
+    heatmap->staged_pending = FALSE;
+    heatmap->snapshots = 0;
+    heatmap->running = TRUE;
+    heatmap->thread = g_thread_new("heatmap", writer_thread, heatmap);
+    g_print("Heatmap: %ux%u grid -> %s every %u s\n", width, height, path,
+            (guint)(heatmap->interval_us / G_USEC_PER_SEC));
+    return TRUE;
+}
+
+void heatmap_end_frame(Heatmap *heatmap, GstClockTime pts) {
+    // Duración del frame: diferencia de PTS; fuera de rango se usa la última
+    if (GST_CLOCK_TIME_IS_VALID(pts) && GST_CLOCK_TIME_IS_VALID(heatmap->last_pts) &&
+        pts > heatmap->last_pts) {
+        guint64 delta_us = (pts - heatmap->last_pts) / 1000;
+        if (delta_us <= HEATMAP_MAX_FRAME_GAP_US) heatmap->frame_us = delta_us;
+    }
+    heatmap->last_pts = pts;
+
+    HeatmapGrid *grid = &heatmap->grid;
+    guint32 *presence = grid->presence.data();
+    guint64 *dwell = grid->dwell_us.data();
+    guint64 frame_us = heatmap->frame_us;
+    for (guint i = 0; i < heatmap->frame_count; i++) {
+        guint32 cell = heatmap->frame_cells[i];
+        presence[cell]++;
+        dwell[cell] += frame_us;
+    }
+    heatmap->frame_count = 0;
+    grid->frames++;
+    grid->observed_us += frame_us;
+
+    if (g_get_monotonic_time() < heatmap->next_snapshot_us) return;
+    if (!g_mutex_trylock(&heatmap->lock)) return;
+    if (!heatmap->staged_pending) {
+        heatmap->staged.frames = grid->frames;
+        heatmap->staged.observed_us = grid->observed_us;
+        heatmap->staged.presence = grid->presence;
+        heatmap->staged.dwell_us = grid->dwell_us;
+        heatmap->staged_pending = TRUE;
+        heatmap->next_snapshot_us = g_get_monotonic_time() + heatmap->interval_us;
+        g_cond_signal(&heatmap->cond);
+    }
+    g_mutex_unlock(&heatmap->lock);
+}
+
+void heatmap_finish(Heatmap *heatmap) {
+    if (!heatmap->thread) return;
+    g_mutex_lock(&heatmap->lock);
+    heatmap->running = FALSE;
+    g_cond_signal(&heatmap->cond);
+    g_mutex_unlock(&heatmap->lock);
+    g_thread_join(heatmap->thread);
+    heatmap->thread = NULL;
+
+    if (heatmap_grid_save(&heatmap->grid, heatmap->path)) {
+        heatmap->snapshots++;
+    } else {
+        g_printerr("Heatmap: could not write %s\n", heatmap->path);
+    }
+    g_print("Heatmap: %llu frames, %u snapshots written to %s\n",
+            (unsigned long long)heatmap->grid.frames, heatmap->snapshots, heatmap->path);
+}
+
+void heatmap_destroy(Heatmap *heatmap) {
+    if (heatmap->thread) {
+        g_mutex_lock(&heatmap->lock);
+        heatmap->running = FALSE;
+        g_cond_signal(&heatmap->cond);
+        g_mutex_unlock(&heatmap->lock);
+        g_thread_join(heatmap->thread);
+        heatmap->thread = NULL;
+    }
+    g_mutex_clear(&heatmap->lock);
+    g_cond_clear(&heatmap->cond);
+    g_free(heatmap->path);
+    heatmap->path = NULL;
+}
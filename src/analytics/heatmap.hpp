@@ -0,0 +1,75 @@
+/*
+ * heatmap.hpp
+ * Mapa de ocupación acumulado por frame
+ *
+ * El probe del OSD anota la celda del centro de cada vehículo de las clases
+ * seguidas y al cerrar el frame suma, en una sola pasada por esas celdas,
+ * una observación y la duración del frame: O(objetos) por frame, sin
+ * memoria dinámica. Cada cierto tiempo copia la grilla para un hilo de fondo
+ * que la escribe en disco (ver heatmap_grid.hpp); si el hilo sigue
+ * escribiendo la copia se pospone al siguiente frame.
+ */
+
+#ifndef HEATMAP_HPP
+#define HEATMAP_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include "gstnvdsmeta.h"
+#include "heatmap_grid.hpp"
+
+#define HEATMAP_DEFAULT_WIDTH 64
+#define HEATMAP_DEFAULT_HEIGHT 36
+#define HEATMAP_DEFAULT_INTERVAL_S 60
+#define HEATMAP_FRAME_OBJECTS 256          // Observaciones por frame; el resto se ignora
+#define HEATMAP_DEFAULT_FRAME_US 33333     // Hasta medir el intervalo entre frames
+#define HEATMAP_MAX_FRAME_GAP_US 1000000   // Saltos mayores (seek, pausa) no suman
+
+struct Heatmap {
+    HeatmapGrid grid;                  // Solo el probe
+    guint32 frame_cells[HEATMAP_FRAME_OBJECTS];
+    guint frame_count;
+    GstClockTime last_pts;
+    guint64 frame_us;                  // Último intervalo entre frames válido
+    gchar *path;
+    gint64 interval_us;
+    gint64 next_snapshot_us;
+
+    // Copia para el hilo de escritura
+    HeatmapGrid staged;                // Protegido por lock
+    gboolean staged_pending;           // Protegido por lock
+    guint snapshots;                   // Protegido por lock
+    GThread *thread;
+    GMutex lock;
+    GCond cond;
+    gboolean running;                  // Protegido por lock
+};
+
+// Grilla "WxH"
+gboolean heatmap_parse_grid(const gchar *spec, guint *width, guint *height);
+
+gboolean heatmap_init(Heatmap *heatmap, const gchar *path, guint width, guint height,
+                      guint interval_s);
+
+// Anota el centro del bbox (en píxeles de un frame de frame_width x frame_height)
+static inline void heatmap_observe(Heatmap *heatmap, const NvOSD_RectParams *bbox,
+                                   gint frame_width, gint frame_height) {
+    if (heatmap->frame_count == HEATMAP_FRAME_OBJECTS) return;
+    gfloat cx = (bbox->left + bbox->width / 2.0f) / frame_width;
+    gfloat cy = (bbox->top + bbox->height / 2.0f) / frame_height;
+    gint col = (gint)(cx * heatmap->grid.width);
+    gint row = (gint)(cy * heatmap->grid.height);
+    col = CLAMP(col, 0, (gint)heatmap->grid.width - 1);
+    row = CLAMP(row, 0, (gint)heatmap->grid.height - 1);
+    heatmap->frame_cells[heatmap->frame_count++] = (guint32)(row * heatmap->grid.width + col);
+}
+
+// Suma las observaciones del frame y, si pasó el intervalo, publica una copia
+void heatmap_end_frame(Heatmap *heatmap, GstClockTime pts);
+
+// Al EOS: escribe la grilla completa
+void heatmap_finish(Heatmap *heatmap);
+
+void heatmap_destroy(Heatmap *heatmap);
+
+#endif // HEATMAP_HPP
@@ -0,0 +1,82 @@
+/*
+ * heatmap_grid.cpp
+ * Implementación de la grilla de ocupación y su archivo
+ */
+
+#include "heatmap_grid.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+bool heatmap_grid_init(HeatmapGrid *grid, uint32_t width, uint32_t height) {
+    if (width == 0 || height == 0 || (size_t)width * height > HEATMAP_MAX_CELLS) {
+        return false;
+    }
+    grid->width = width;
+    grid->height = height;
+    grid->frames = 0;
+    grid->observed_us = 0;
+    grid->runs = 1;
+    grid->presence.assign((size_t)width * height, 0);
+    grid->dwell_us.assign((size_t)width * height, 0);
+    return true;
+}
+
+bool heatmap_grid_save(const HeatmapGrid *grid, const char *path) {
+    std::string tmp = std::string(path) + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+
+    HeatmapFileHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, HEATMAP_MAGIC, sizeof(hdr.magic));
+    hdr.grid_width = grid->width;
+    hdr.grid_height = grid->height;
+    hdr.frames = grid->frames;
+    hdr.observed_us = grid->observed_us;
+    hdr.runs = grid->runs;
+
+    size_t cells = grid->presence.size();
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+              fwrite(grid->presence.data(), sizeof(uint32_t), cells, f) == cells &&
+              fwrite(grid->dwell_us.data(), sizeof(uint64_t), cells, f) == cells;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path) != 0) {
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool heatmap_grid_load(HeatmapGrid *grid, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+
+    HeatmapFileHeader hdr;
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+              memcmp(hdr.magic, HEATMAP_MAGIC, sizeof(hdr.magic)) == 0 &&
+              heatmap_grid_init(grid, hdr.grid_width, hdr.grid_height);
+    if (ok) {
+        size_t cells = grid->presence.size();
+        grid->frames = hdr.frames;
+        grid->observed_us = hdr.observed_us;
+        grid->runs = hdr.runs;
+        ok = fread(grid->presence.data(), sizeof(uint32_t), cells, f) == cells &&
+             fread(grid->dwell_us.data(), sizeof(uint64_t), cells, f) == cells;
+    }
+    fclose(f);
+    return ok;
+}
+
+bool heatmap_grid_merge(HeatmapGrid *dst, const HeatmapGrid *src) {
+    if (dst->width != src->width || dst->height != src->height) return false;
+    size_t cells = dst->presence.size();
+    for (size_t i = 0; i < cells; i++) {
+        dst->presence[i] += src->presence[i];
+        dst->dwell_us[i] += src->dwell_us[i];
+    }
+    dst->frames += src->frames;
+    dst->observed_us += src->observed_us;
+    dst->runs += src->runs;
+    return true;
+}
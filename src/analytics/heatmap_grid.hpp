@@ -0,0 +1,54 @@
+/*
+ * heatmap_grid.hpp
+ * Grilla de ocupación (presencia y permanencia por celda) y su archivo
+ *
+ * Compartido por roi_surveillance y tools/heatmap_tool; no depende de
+ * GLib/GStreamer. El archivo es un encabezado seguido de las dos matrices
+ * (fila por fila, celda (0,0) arriba a la izquierda):
+ *   HeatmapFileHeader | uint32 presence[w*h] | uint64 dwell_us[w*h]
+ * presence cuenta observaciones (un objeto en un frame) y dwell_us suma el
+ * tiempo de esos frames. Dos grillas del mismo tamaño se combinan sumando.
+ */
+
+#ifndef HEATMAP_GRID_HPP
+#define HEATMAP_GRID_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#define HEATMAP_MAGIC "ROIHEAT1"
+#define HEATMAP_MAX_CELLS (512 * 512)
+
+struct HeatmapFileHeader {
+    char     magic[8];
+    uint32_t grid_width;
+    uint32_t grid_height;
+    uint64_t frames;          // Frames acumulados
+    uint64_t observed_us;     // Tiempo de video acumulado
+    uint32_t runs;            // Corridas combinadas
+    uint32_t reserved;
+};
+
+struct HeatmapGrid {
+    uint32_t width;
+    uint32_t height;
+    uint64_t frames;
+    uint64_t observed_us;
+    uint32_t runs;
+    std::vector<uint32_t> presence;
+    std::vector<uint64_t> dwell_us;
+};
+
+// Grilla vacía de width x height (false si el tamaño no es válido)
+bool heatmap_grid_init(HeatmapGrid *grid, uint32_t width, uint32_t height);
+
+// Escribe en un temporal y lo renombra: un lector nunca ve un archivo a medias
+bool heatmap_grid_save(const HeatmapGrid *grid, const char *path);
+
+bool heatmap_grid_load(HeatmapGrid *grid, const char *path);
+
+// Suma src en dst (mismo tamaño)
+bool heatmap_grid_merge(HeatmapGrid *dst, const HeatmapGrid *src);
+
+#endif // HEATMAP_GRID_HPP
@@ -0,0 +1,169 @@
+/*
+ * trajectory.cpp
+ * Implementación del registro de trayectorias
+ */
+
+#include "trajectory.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+void trajectory_init(TrajectoryRecorder *rec, const gchar *path, guint max_memory_mb) {
+    rec->path = g_strdup(path);
+    rec->slab_used = TRAJECTORY_SLAB_CHUNKS;
+    gsize slab_bytes = TRAJECTORY_SLAB_CHUNKS * sizeof(TrajectoryChunk);
+    gsize max_bytes = (gsize)(max_memory_mb > 0 ? max_memory_mb : TRAJECTORY_DEFAULT_MEMORY_MB)
+                      * 1024 * 1024;
+    rec->max_slabs = MAX(max_bytes / slab_bytes, (gsize)1);
+    rec->samples = 0;
+    rec->dropped = 0;
+    rec->bytes = 0;
+    g_print("Trajectories: %s (max %u MB)\n", path,
+            (guint)(rec->max_slabs * slab_bytes / (1024 * 1024)));
+}
+
+// Siguiente chunk del pool (NULL si se alcanzó el tope)
+static TrajectoryChunk *alloc_chunk(TrajectoryRecorder *rec) {
+    if (rec->slab_used == TRAJECTORY_SLAB_CHUNKS) {
+        if (rec->slabs.size() >= rec->max_slabs) return NULL;
+        rec->slabs.push_back(g_new(TrajectoryChunk, TRAJECTORY_SLAB_CHUNKS));
+        rec->slab_used = 0;
+    }
+    TrajectoryChunk *chunk = &rec->slabs.back()[rec->slab_used++];
+    chunk->next = NULL;
+    chunk->used = 0;
+    return chunk;
+}
+
+// Agrega n bytes al track; una muestra nunca ocupa más de un chunk nuevo
+static gboolean append(TrajectoryRecorder *rec, TrajectoryTrack *track,
+                       const guint8 *bytes, gsize n) {
+    gsize room = track->tail ? sizeof(track->tail->data) - track->tail->used : 0;
+    TrajectoryChunk *extra = NULL;
+    if (room < n) {
+        extra = alloc_chunk(rec);
+        if (!extra) return FALSE;
+    }
+    gsize first = MIN(room, n);
+    if (first) {
+        memcpy(track->tail->data + track->tail->used, bytes, first);
+        track->tail->used += (guint32)first;
+    }
+    if (extra) {
+        memcpy(extra->data, bytes + first, n - first);
+        extra->used = (guint32)(n - first);
+        if (track->tail) track->tail->next = extra;
+        else track->head = extra;
+        track->tail = extra;
+    }
+    track->bytes += (guint32)n;
+    return TRUE;
+}
+
+void trajectory_record(TrajectoryRecorder *rec, const NvDsObjectMeta *obj_meta,
+                       TrackEvent event, gint frame_width, gint frame_height,
+                       GstClockTime pts) {
+    guint64 track_id = obj_meta->object_id;
+    auto it = rec->tracks.find(track_id);
+    if (it == rec->tracks.end()) {
+        // Sin espacio no tiene sentido registrar tracks nuevos
+        if (rec->slab_used == TRAJECTORY_SLAB_CHUNKS && rec->slabs.size() >= rec->max_slabs) {
+            rec->dropped++;
+            return;
+        }
+        TrajectoryTrack track;
+        memset(&track, 0, sizeof(track));
+        track.class_id = obj_meta->class_id;
+        track.first_pts_ms = GST_CLOCK_TIME_IS_VALID(pts) ? pts / GST_MSECOND : 0;
+        it = rec->tracks.emplace(track_id, track).first;
+    }
+    TrajectoryTrack *track = &it->second;
+
+    const NvOSD_RectParams *r = &obj_meta->rect_params;
+    TrajectorySample cur;
+    cur.pts_ms = GST_CLOCK_TIME_IS_VALID(pts) ? pts / GST_MSECOND : track->last.pts_ms;
+    cur.x = (gint32)(r->left * TRAJECTORY_SCALE / frame_width);
+    cur.y = (gint32)(r->top * TRAJECTORY_SCALE / frame_height);
+    cur.w = (gint32)(r->width * TRAJECTORY_SCALE / frame_width);
+    cur.h = (gint32)(r->height * TRAJECTORY_SCALE / frame_height);
+    switch (event) {
+        case TRACK_EVENT_ENTER: cur.state = STATE_INSIDE; break;
+        case TRACK_EVENT_ALERT: cur.state = STATE_ALERT; break;
+        case TRACK_EVENT_EXIT:  cur.state = STATE_OUTSIDE; break;
+        default:                cur.state = track->last.state; break;
+    }
+
+    guint8 encoded[TRAJECTORY_MAX_SAMPLE_BYTES];
+    gsize n = trajectory_encode(&track->last, &cur, encoded);
+    if (!append(rec, track, encoded, n)) {
+        rec->dropped++;
+        return;
+    }
+    track->last = cur;
+    track->samples++;
+    rec->samples++;
+    rec->bytes += n;
+}
+
+gboolean trajectory_finish(TrajectoryRecorder *rec) {
+    FILE *f = fopen(rec->path, "wb");
+    if (!f) {
+        g_printerr("Trajectories: could not write %s\n", rec->path);
+        return FALSE;
+    }
+
+    // Por orden de aparición
+    std::vector<std::pair<guint64, const TrajectoryTrack *>> order;
+    order.reserve(rec->tracks.size());
+    for (const auto &pair : rec->tracks) {
+        if (pair.second.samples > 0) order.emplace_back(pair.first, &pair.second);
+    }
+    std::sort(order.begin(), order.end(), [](const std::pair<guint64, const TrajectoryTrack *> &a,
+                                             const std::pair<guint64, const TrajectoryTrack *> &b) {
+        return a.second->first_pts_ms != b.second->first_pts_ms
+               ? a.second->first_pts_ms < b.second->first_pts_ms : a.first < b.first;
+    });
+
+    TrajectoryFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRAJECTORY_MAGIC, sizeof(header.magic));
+    header.scale = TRAJECTORY_SCALE;
+    header.num_tracks = (guint32)order.size();
+    header.samples = rec->samples;
+    header.dropped = rec->dropped;
+    gboolean ok = fwrite(&header, sizeof(header), 1, f) == 1;
+
+    for (const auto &entry : order) {
+        const TrajectoryTrack *track = entry.second;
+        TrajectoryTrackHeader th;
+        memset(&th, 0, sizeof(th));
+        th.track_id = entry.first & ~TRACKER_RESUMED_KEY;
+        th.class_id = track->class_id;
+        th.samples = track->samples;
+        th.first_pts_ms = track->first_pts_ms;
+        th.last_pts_ms = track->last.pts_ms;
+        th.bytes = track->bytes;
+        ok = ok && fwrite(&th, sizeof(th), 1, f) == 1;
+        for (const TrajectoryChunk *c = track->head; ok && c; c = c->next) {
+            ok = fwrite(c->data, 1, c->used, f) == c->used;
+        }
+    }
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        g_printerr("Trajectories: error writing %s\n", rec->path);
+        return FALSE;
+    }
+    g_print("Trajectories: %u tracks, %llu samples (%.1f B/sample), %llu dropped -> %s\n",
+            header.num_tracks, (unsigned long long)rec->samples,
+            rec->samples ? (gdouble)rec->bytes / rec->samples : 0.0,
+            (unsigned long long)rec->dropped, rec->path);
+    return TRUE;
+}
+
+void trajectory_destroy(TrajectoryRecorder *rec) {
+    for (TrajectoryChunk *slab : rec->slabs) g_free(slab);
+    rec->slabs.clear();
+    rec->tracks.clear();
+    g_free(rec->path);
+    rec->path = NULL;
+}
@@ -0,0 +1,68 @@
+/*
+ * trajectory.hpp
+ * Registro de la trayectoria de cada track (bbox y estado por frame)
+ *
+ * Cada muestra se codifica como diferencia con la anterior del mismo track
+ * (ver trajectory_file.hpp) y se agrega a una lista de chunks de tamaño fijo
+ * tomados de un pool de bloques grandes: no hay un vector por track ni
+ * memoria que se libere durante la corrida. El pool tiene un tope global;
+ * al alcanzarlo las muestras nuevas se descartan y se cuentan. Todo se
+ * escribe a disco al terminar (EOS).
+ */
+
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include <unordered_map>
+#include <vector>
+#include "gstnvdsmeta.h"
+#include "config/track_info.hpp"
+#include "trajectory_file.hpp"
+
+#define TRAJECTORY_CHUNK_SIZE 128
+#define TRAJECTORY_SLAB_CHUNKS 512          // 64 KiB por bloque del pool
+#define TRAJECTORY_DEFAULT_MEMORY_MB 64
+
+struct TrajectoryChunk {
+    TrajectoryChunk *next;
+    guint32 used;
+    guint8 data[TRAJECTORY_CHUNK_SIZE - sizeof(void *) - sizeof(guint32)];
+};
+
+struct TrajectoryTrack {
+    gint class_id;
+    guint32 samples;
+    guint32 bytes;
+    guint64 first_pts_ms;
+    TrajectorySample last;              // Base de la siguiente diferencia
+    TrajectoryChunk *head;
+    TrajectoryChunk *tail;
+};
+
+struct TrajectoryRecorder {
+    gchar *path;
+    std::unordered_map<guint64, TrajectoryTrack> tracks;
+    std::vector<TrajectoryChunk *> slabs;
+    guint slab_used;                    // Chunks entregados del último bloque
+    gsize max_slabs;
+    guint64 samples;
+    guint64 dropped;
+    guint64 bytes;
+};
+
+void trajectory_init(TrajectoryRecorder *rec, const gchar *path, guint max_memory_mb);
+
+// Desde el probe del OSD, para cada objeto de las clases seguidas; event es
+// lo que devolvió tracker_process_object para ese objeto
+void trajectory_record(TrajectoryRecorder *rec, const NvDsObjectMeta *obj_meta,
+                       TrackEvent event, gint frame_width, gint frame_height,
+                       GstClockTime pts);
+
+// Al EOS: escribe todas las trayectorias
+gboolean trajectory_finish(TrajectoryRecorder *rec);
+
+void trajectory_destroy(TrajectoryRecorder *rec);
+
+#endif // TRAJECTORY_HPP
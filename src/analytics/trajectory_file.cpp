@@ -0,0 +1,110 @@
+/*
+ * trajectory_file.cpp
+ * Implementación de la codificación de trayectorias y del lector
+ */
+
+#include "trajectory_file.hpp"
+#include <string.h>
+
+static size_t put_varint(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static bool get_varint(const uint8_t *data, size_t length, size_t *pos, uint64_t *value) {
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64 && *pos < length; shift += 7) {
+        uint8_t byte = data[(*pos)++];
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+size_t trajectory_encode(const TrajectorySample *prev, const TrajectorySample *cur,
+                         uint8_t *out) {
+    static const TrajectorySample zero = { 0, 0, 0, 0, 0, 0 };
+    if (!prev) prev = &zero;
+    uint64_t dt = cur->pts_ms >= prev->pts_ms ? cur->pts_ms - prev->pts_ms : 0;
+    bool state_changed = cur->state != prev->state;
+    size_t n = put_varint(out, (dt << 1) | (state_changed ? 1 : 0));
+    if (state_changed) out[n++] = cur->state;
+    n += put_varint(out + n, zigzag((int64_t)cur->x - prev->x));
+    n += put_varint(out + n, zigzag((int64_t)cur->y - prev->y));
+    n += put_varint(out + n, zigzag((int64_t)cur->w - prev->w));
+    n += put_varint(out + n, zigzag((int64_t)cur->h - prev->h));
+    return n;
+}
+
+bool trajectory_decode(const uint8_t *data, size_t length, uint32_t samples,
+                       std::vector<TrajectorySample> *out) {
+    TrajectorySample s;
+    memset(&s, 0, sizeof(s));
+    size_t pos = 0;
+    out->reserve(out->size() + samples);
+    for (uint32_t i = 0; i < samples; i++) {
+        uint64_t head, dx, dy, dw, dh;
+        if (!get_varint(data, length, &pos, &head)) return false;
+        if (head & 1) {
+            if (pos >= length) return false;
+            s.state = data[pos++];
+        }
+        if (!get_varint(data, length, &pos, &dx) || !get_varint(data, length, &pos, &dy) ||
+            !get_varint(data, length, &pos, &dw) || !get_varint(data, length, &pos, &dh)) {
+            return false;
+        }
+        s.pts_ms += head >> 1;
+        s.x += (int32_t)unzigzag(dx);
+        s.y += (int32_t)unzigzag(dy);
+        s.w += (int32_t)unzigzag(dw);
+        s.h += (int32_t)unzigzag(dh);
+        out->push_back(s);
+    }
+    return true;
+}
+
+bool trajectory_reader_open(TrajectoryReader *reader, const char *path) {
+    reader->next_track = 0;
+    reader->file = fopen(path, "rb");
+    if (!reader->file) return false;
+    if (fread(&reader->header, sizeof(reader->header), 1, reader->file) != 1 ||
+        memcmp(reader->header.magic, TRAJECTORY_MAGIC, sizeof(reader->header.magic)) != 0) {
+        fclose(reader->file);
+        reader->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool trajectory_reader_next(TrajectoryReader *reader, TrajectoryTrackHeader *track,
+                            std::vector<uint8_t> *data) {
+    if (!reader->file || reader->next_track >= reader->header.num_tracks) return false;
+    if (fread(track, sizeof(*track), 1, reader->file) != 1) return false;
+    data->resize(track->bytes);
+    if (track->bytes && fread(data->data(), 1, track->bytes, reader->file) != track->bytes) {
+        return false;
+    }
+    reader->next_track++;
+    return true;
+}
+
+void trajectory_reader_close(TrajectoryReader *reader) {
+    if (reader->file) fclose(reader->file);
+    reader->file = NULL;
+}
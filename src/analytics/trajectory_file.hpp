@@ -0,0 +1,76 @@
+/*
+ * trajectory_file.hpp
+ * Codificación de trayectorias y formato del archivo
+ *
+ * Compartido por roi_surveillance y tools/trajectory_reader; no depende de
+ * GLib/GStreamer. Cada muestra (un track en un frame) se guarda como
+ * diferencia con la muestra anterior del mismo track, en varints:
+ *   (dt_ms << 1 | cambio_de_estado) [estado] dx dy dw dh
+ * dx..dh en zigzag, en unidades de 1/TRAJECTORY_SCALE del frame. Un vehículo
+ * que se mueve unos píxeles por frame ocupa 5 o 6 bytes por muestra.
+ *
+ * Archivo: TrajectoryFileHeader y, por track, TrajectoryTrackHeader seguido
+ * de sus bytes codificados (la primera muestra es relativa a cero).
+ */
+
+#ifndef TRAJECTORY_FILE_HPP
+#define TRAJECTORY_FILE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+#define TRAJECTORY_MAGIC "ROITRAJ1"
+#define TRAJECTORY_SCALE 4096          // Unidades por ancho/alto del frame
+#define TRAJECTORY_MAX_SAMPLE_BYTES 40 // Peor caso de una muestra codificada
+
+struct TrajectorySample {
+    uint64_t pts_ms;
+    int32_t x, y, w, h;                // En 1/TRAJECTORY_SCALE del frame
+    uint8_t state;                     // ObjectState (fuera, dentro, alerta)
+};
+
+struct TrajectoryFileHeader {
+    char     magic[8];
+    uint32_t scale;
+    uint32_t num_tracks;
+    uint64_t samples;                  // Muestras guardadas
+    uint64_t dropped;                  // Descartadas por el límite de memoria
+};
+
+struct TrajectoryTrackHeader {
+    uint64_t track_id;
+    int32_t  class_id;
+    uint32_t samples;
+    uint64_t first_pts_ms;
+    uint64_t last_pts_ms;
+    uint32_t bytes;                    // Bytes codificados que siguen
+    uint32_t reserved;
+};
+
+// Codifica cur respecto a prev en out (TRAJECTORY_MAX_SAMPLE_BYTES); devuelve
+// los bytes escritos
+size_t trajectory_encode(const TrajectorySample *prev, const TrajectorySample *cur,
+                         uint8_t *out);
+
+// Decodifica todas las muestras de un track; false si los datos están truncados
+bool trajectory_decode(const uint8_t *data, size_t length, uint32_t samples,
+                       std::vector<TrajectorySample> *out);
+
+// Lectura secuencial del archivo
+struct TrajectoryReader {
+    FILE *file;
+    TrajectoryFileHeader header;
+    uint32_t next_track;
+};
+
+bool trajectory_reader_open(TrajectoryReader *reader, const char *path);
+
+// Siguiente track con sus bytes codificados; false al terminar o si hay error
+bool trajectory_reader_next(TrajectoryReader *reader, TrajectoryTrackHeader *track,
+                            std::vector<uint8_t> *data);
+
+void trajectory_reader_close(TrajectoryReader *reader);
+
+#endif // TRAJECTORY_FILE_HPP
@@ -0,0 +1,329 @@
+/*
+ * checkpoint.cpp
+ * Implementación de los checkpoints del tracker
+ */
+
+#include "checkpoint.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CHECKPOINT_PAGE 4096
+
+guint64 checkpoint_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000ULL + (guint64)ts.tv_nsec;
+}
+
+static guint64 fnv1a(guint64 hash, const void *data, gsize length) {
+    const guint8 *p = (const guint8 *)data;
+    for (gsize i = 0; i < length; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+#define FNV_OFFSET 14695981039346656037ULL
+
+guint64 checkpoint_input_key(const gchar *location, gboolean is_file) {
+    guint64 key = fnv1a(FNV_OFFSET, location, strlen(location));
+    struct stat st;
+    if (is_file && stat(location, &st) == 0) {
+        gint64 stamp[2] = { (gint64)st.st_mtime, (gint64)st.st_size };
+        key = fnv1a(key, stamp, sizeof(stamp));
+    }
+    return key;
+}
+
+static gsize slot_size(guint32 max_tracks) {
+    gsize size = sizeof(CheckpointSlot) + (gsize)max_tracks * sizeof(CheckpointTrack);
+    return (size + CHECKPOINT_PAGE - 1) / CHECKPOINT_PAGE * CHECKPOINT_PAGE;
+}
+
+static gsize file_size(guint32 max_tracks) {
+    return CHECKPOINT_PAGE + 2 * slot_size(max_tracks);
+}
+
+static CheckpointSlot *slot_at(guint8 *map, const CheckpointHeader *header, guint index) {
+    return (CheckpointSlot *)(map + header->slot_offset[index]);
+}
+
+static guint64 slot_checksum(const CheckpointSlot *slot, guint32 num_tracks) {
+    // Desde pts hasta el último track usado
+    const guint8 *start = (const guint8 *)&slot->pts;
+    gsize length = sizeof(CheckpointSlot) - offsetof(CheckpointSlot, pts) +
+                   (gsize)num_tracks * sizeof(CheckpointTrack);
+    return fnv1a(FNV_OFFSET, start, length);
+}
+
+// Mitad válida con la secuencia más alta (NULL si ninguna)
+static const CheckpointSlot *newest_slot(guint8 *map, gsize map_size,
+                                         const CheckpointHeader *header) {
+    const CheckpointSlot *best = NULL;
+    for (guint i = 0; i < 2; i++) {
+        if (header->slot_offset[i] + header->slot_size > map_size) continue;
+        const CheckpointSlot *slot = slot_at(map, header, i);
+        guint64 seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0 || slot->num_tracks > header->max_tracks) continue;
+        if (slot_checksum(slot, slot->num_tracks) != slot->checksum) continue;
+        if (!best || seq > best->seq) best = slot;
+    }
+    return best;
+}
+
+static gboolean header_valid(const CheckpointHeader *header, gsize map_size) {
+    return memcmp(header->magic, CHECKPOINT_MAGIC, 8) == 0 &&
+           header->max_tracks > 0 &&
+           header->slot_size == slot_size(header->max_tracks) &&
+           map_size >= file_size(header->max_tracks);
+}
+
+static void restore_track(TrackerContext *tracker, const CheckpointTrack *rec) {
+    TrackInfo info;
+    // Los IDs del tracker se reinician con el proceso: los restaurados usan
+    // claves aparte hasta que un track nuevo los adopte (ver track_info.cpp)
+    info.track_id = rec->track_id | TRACKER_RESUMED_KEY;
+    info.state = (ObjectState)rec->state;
+    info.timer = g_timer_new();
+    info.entry_timestamp = rec->entry_timestamp;
+    info.class_name = g_strndup(rec->class_name, CHECKPOINT_CLASS_NAME);
+    info.alert_triggered = rec->alert_triggered;
+    info.alert_start_time = rec->alert_start_time;
+    info.snapshot_path = rec->snapshot_path[0]
+                         ? g_strndup(rec->snapshot_path, CHECKPOINT_SNAPSHOT_PATH) : NULL;
+    info.class_id = rec->class_id;
+    info.zone = -1;
+    info.entry_zone = rec->entry_zone;
+    info.last_cx = rec->cx;
+    info.last_cy = rec->cy;
+    // Detenido hasta la adopción: el arranque del pipeline no suma permanencia
+    g_timer_stop(info.timer);
+    if (info.state == STATE_OUTSIDE) {
+        info.total_time = rec->time_in_roi;
+        info.resumed_seconds = 0.0;
+    } else {
+        info.total_time = 0.0;
+        info.resumed_seconds = rec->time_in_roi;
+        tracker->resumed_keys.push_back(info.track_id);
+    }
+    tracker->tracked_objects[info.track_id] = info;
+}
+
+gboolean checkpoint_resume(const gchar *path, guint64 input_key, TrackerContext *tracker,
+                           GstClockTime *pts) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return FALSE;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (gsize)st.st_size < CHECKPOINT_PAGE) {
+        close(fd);
+        return FALSE;
+    }
+    gsize map_size = (gsize)st.st_size;
+    guint8 *map = (guint8 *)mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return FALSE;
+
+    const CheckpointHeader *header = (const CheckpointHeader *)map;
+    gboolean resumed = FALSE;
+    if (!header_valid(header, map_size)) {
+        g_printerr("Checkpoint: %s is not a checkpoint file, starting fresh\n", path);
+    } else if (header->input_key != input_key) {
+        g_print("Checkpoint: %s belongs to another input, starting fresh\n", path);
+    } else if (header->finished) {
+        g_print("Checkpoint: previous run finished, starting fresh\n");
+    } else {
+        const CheckpointSlot *slot = newest_slot(map, map_size, header);
+        if (slot) {
+            const CheckpointTrack *tracks = (const CheckpointTrack *)(slot + 1);
+            for (guint32 i = 0; i < slot->num_tracks; i++) restore_track(tracker, &tracks[i]);
+            tracker->total_detected = slot->total_detected;
+            tracker->total_alerts = slot->total_alerts;
+            tracker->time_offset = slot->app_time;
+            *pts = slot->pts;
+            resumed = TRUE;
+            g_print("Checkpoint: resuming at %.1f s (PTS %.3f s): %u detected, %u alerts, "
+                    "%zu tracks in ROI\n",
+                    slot->app_time,
+                    GST_CLOCK_TIME_IS_VALID(slot->pts) ? slot->pts / 1e9 : 0.0,
+                    slot->total_detected, slot->total_alerts, tracker->resumed_keys.size());
+        }
+    }
+    munmap(map, map_size);
+    return resumed;
+}
+
+static gpointer sync_thread(gpointer data) {
+    CheckpointWriter *writer = (CheckpointWriter *)data;
+    guint64 synced = 0;
+    g_mutex_lock(&writer->lock);
+    while (writer->running) {
+        gint64 deadline = g_get_monotonic_time() + (gint64)(writer->interval_ns / 1000);
+        g_cond_wait_until(&writer->cond, &writer->lock, deadline);
+        guint64 sealed = writer->sealed_seq.load(std::memory_order_acquire);
+        if (sealed == synced) continue;
+        g_mutex_unlock(&writer->lock);
+        msync(writer->map, writer->map_size, MS_SYNC);
+        synced = sealed;
+        g_mutex_lock(&writer->lock);
+    }
+    g_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+gboolean checkpoint_init(CheckpointWriter *writer, const gchar *path, guint64 input_key,
+                         guint max_tracks, guint interval_ms, gboolean resumed) {
+    writer->path = g_strdup(path);
+    writer->max_tracks = max_tracks > 0 ? max_tracks : CHECKPOINT_DEFAULT_TRACKS;
+    writer->interval_ns = (guint64)(interval_ms > 0 ? interval_ms : CHECKPOINT_DEFAULT_INTERVAL_MS)
+                          * 1000000ULL;
+    writer->last_write_ns = checkpoint_now_ns();
+    writer->seq = 0;
+    writer->last_pts = GST_CLOCK_TIME_NONE;
+    writer->written = 0;
+    writer->map = NULL;
+    writer->map_size = file_size(writer->max_tracks);
+    writer->thread = NULL;
+    writer->running = FALSE;
+    writer->sealed_seq.store(0, std::memory_order_relaxed);
+    g_mutex_init(&writer->lock);
+    g_cond_init(&writer->cond);
+
+    writer->fd = open(path, O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if (writer->fd < 0 || fstat(writer->fd, &st) != 0) {
+        g_printerr("Checkpoint: could not open %s: %s\n", path, strerror(errno));
+        return FALSE;
+    }
+    // Un archivo con otro tamaño (otro --checkpoint-tracks) se recrea
+    if ((gsize)st.st_size != writer->map_size &&
+        (ftruncate(writer->fd, 0) != 0 || ftruncate(writer->fd, writer->map_size) != 0)) {
+        g_printerr("Checkpoint: could not size %s: %s\n", path, strerror(errno));
+        return FALSE;
+    }
+    void *map = mmap(NULL, writer->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+    if (map == MAP_FAILED) {
+        g_printerr("Checkpoint: mmap failed: %s\n", strerror(errno));
+        return FALSE;
+    }
+    writer->map = (guint8 *)map;
+
+    CheckpointHeader *header = (CheckpointHeader *)writer->map;
+    if (resumed && header_valid(header, writer->map_size) &&
+        header->max_tracks == writer->max_tracks && header->input_key == input_key) {
+        // La mitad más reciente sigue válida hasta que se selle la siguiente
+        const CheckpointSlot *slot = newest_slot(writer->map, writer->map_size, header);
+        writer->seq = slot ? slot->seq : 0;
+    } else {
+        // Sin reanudar se invalidan ambas mitades (seq 0, checksum en cero): un
+        // corte antes del primer checkpoint no debe revivir la corrida anterior
+        memset(writer->map, 0, writer->map_size);
+        memcpy(header->magic, CHECKPOINT_MAGIC, 8);
+        header->max_tracks = writer->max_tracks;
+        header->input_key = input_key;
+        header->slot_size = slot_size(writer->max_tracks);
+        header->slot_offset[0] = CHECKPOINT_PAGE;
+        header->slot_offset[1] = CHECKPOINT_PAGE + header->slot_size;
+    }
+    header->finished = 0;
+    msync(writer->map, writer->map_size, MS_SYNC);
+
+    writer->running = TRUE;
+    writer->thread = g_thread_new("checkpoint", sync_thread, writer);
+    g_print("Checkpoint: %s every %u ms (max %u tracks)\n", path,
+            (guint)(writer->interval_ns / 1000000ULL), writer->max_tracks);
+    return TRUE;
+}
+
+static void fill_track(CheckpointTrack *rec, const TrackInfo &info) {
+    memset(rec, 0, sizeof(*rec));
+    rec->track_id = info.track_id & ~TRACKER_RESUMED_KEY;
+    rec->state = info.state;
+    rec->class_id = info.class_id;
+    rec->alert_triggered = info.alert_triggered;
+    rec->cx = info.last_cx;
+    rec->cy = info.last_cy;
+    rec->entry_zone = info.entry_zone;
+    rec->entry_timestamp = info.entry_timestamp;
+    rec->alert_start_time = info.alert_start_time;
+    rec->time_in_roi = info.state != STATE_OUTSIDE ? tracker_time_in_roi(&info) : info.total_time;
+    if (info.class_name) g_strlcpy(rec->class_name, info.class_name, sizeof(rec->class_name));
+    if (info.snapshot_path) {
+        g_strlcpy(rec->snapshot_path, info.snapshot_path, sizeof(rec->snapshot_path));
+    }
+}
+
+void checkpoint_write(CheckpointWriter *writer, const TrackerContext *tracker,
+                      GstClockTime pts) {
+    CheckpointHeader *header = (CheckpointHeader *)writer->map;
+    guint64 seq = writer->seq + 1;
+    CheckpointSlot *slot = slot_at(writer->map, header, (guint)(seq & 1));
+    CheckpointTrack *tracks = (CheckpointTrack *)(slot + 1);
+
+    // Se invalida antes de escribir: una caída a medias deja solo la otra mitad
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELEASE);
+
+    // Primero los tracks en el ROI (los que importa reanudar), después las
+    // visitas terminadas que aparecen en el reporte
+    guint32 n = 0, dropped = 0;
+    for (gint pass = 0; pass < 2; pass++) {
+        for (const auto &pair : tracker->tracked_objects) {
+            const TrackInfo &info = pair.second;
+            gboolean inside = info.state != STATE_OUTSIDE;
+            if (pass == 0 ? !inside : (inside || info.total_time <= 0.1)) continue;
+            if (n == writer->max_tracks) {
+                dropped++;
+                continue;
+            }
+            fill_track(&tracks[n++], info);
+        }
+    }
+
+    slot->pts = pts;
+    slot->app_time = tracker_now(tracker);
+    slot->total_detected = tracker->total_detected;
+    slot->total_alerts = tracker->total_alerts;
+    slot->num_tracks = n;
+    slot->dropped_tracks = dropped;
+    slot->checksum = slot_checksum(slot, n);
+    __atomic_store_n(&slot->seq, seq, __ATOMIC_RELEASE);
+
+    writer->seq = seq;
+    writer->written++;
+    writer->sealed_seq.store(seq, std::memory_order_release);
+}
+
+void checkpoint_finish(CheckpointWriter *writer, const TrackerContext *tracker) {
+    if (!writer->map) return;
+    checkpoint_write(writer, tracker, writer->last_pts);
+    CheckpointHeader *header = (CheckpointHeader *)writer->map;
+    header->finished = 1;
+    msync(writer->map, writer->map_size, MS_SYNC);
+    g_print("Checkpoint: %u written, run marked finished\n", writer->written);
+}
+
+void checkpoint_destroy(CheckpointWriter *writer) {
+    if (writer->thread) {
+        g_mutex_lock(&writer->lock);
+        writer->running = FALSE;
+        g_cond_signal(&writer->cond);
+        g_mutex_unlock(&writer->lock);
+        g_thread_join(writer->thread);
+        writer->thread = NULL;
+    }
+    if (writer->map) {
+        msync(writer->map, writer->map_size, MS_SYNC);
+        munmap(writer->map, writer->map_size);
+        writer->map = NULL;
+    }
+    if (writer->fd >= 0) close(writer->fd);
+    writer->fd = -1;
+    g_mutex_clear(&writer->lock);
+    g_cond_clear(&writer->cond);
+    g_free(writer->path);
+    writer->path = NULL;
+}
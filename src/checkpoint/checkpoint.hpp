@@ -0,0 +1,124 @@
+/*
+ * checkpoint.hpp
+ * Checkpoints del tracker en un archivo mapeado en memoria
+ *
+ * El archivo tiene un encabezado y dos mitades. El probe del OSD escribe el
+ * estado (contadores, tracks y PTS) en la mitad que no contiene el último
+ * checkpoint y lo sella con un número de secuencia y un checksum; la otra
+ * mitad queda intacta mientras tanto. Como el mapeo es compartido, lo
+ * escrito sobrevive a la caída del proceso sin llamadas al sistema en el
+ * hilo de streaming; un hilo de fondo hace msync para sobrevivir también a
+ * un corte de energía.
+ *
+ * Al arrancar con el mismo archivo y la misma entrada, si la corrida
+ * anterior no terminó, se restaura el tracker desde la mitad válida más
+ * reciente y se devuelve el PTS para reanudar los archivos desde ahí.
+ */
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+#include "config/track_info.hpp"
+
+#define CHECKPOINT_MAGIC "ROICKPT1"
+#define CHECKPOINT_DEFAULT_INTERVAL_MS 1000
+#define CHECKPOINT_DEFAULT_TRACKS 4096
+#define CHECKPOINT_CLASS_NAME 32
+#define CHECKPOINT_SNAPSHOT_PATH 128
+
+struct CheckpointTrack {
+    uint64_t track_id;
+    int32_t  state;               // ObjectState
+    int32_t  class_id;
+    int32_t  alert_triggered;
+    float    cx, cy;              // Último centro del bbox (normalizado)
+    int32_t  entry_zone;          // ROI de la última entrada (-1 = nunca)
+    double   entry_timestamp;     // Tiempo de la aplicación al entrar
+    double   alert_start_time;
+    double   time_in_roi;         // Dentro: acumulado; fuera: total de la visita
+    char     class_name[CHECKPOINT_CLASS_NAME];
+    char     snapshot_path[CHECKPOINT_SNAPSHOT_PATH];
+};
+
+// Una mitad del archivo; válida si seq != 0 y el checksum coincide
+struct CheckpointSlot {
+    uint64_t seq;
+    uint64_t checksum;            // FNV-1a de lo que sigue a este campo
+    uint64_t pts;                 // GST_CLOCK_TIME_NONE si aún no hubo frames
+    double   app_time;            // tracker_now() al escribir
+    uint32_t total_detected;
+    uint32_t total_alerts;
+    uint32_t num_tracks;
+    uint32_t dropped_tracks;      // No cupieron (los que están fuera del ROI)
+    // Siguen max_tracks CheckpointTrack
+};
+
+struct CheckpointHeader {
+    char     magic[8];
+    uint32_t max_tracks;
+    uint32_t finished;            // La corrida terminó (EOS): no se reanuda
+    uint64_t input_key;           // Identifica la entrada (ver checkpoint_input_key)
+    uint64_t slot_offset[2];
+    uint64_t slot_size;
+};
+
+struct CheckpointWriter {
+    gchar *path;
+    int fd;
+    guint8 *map;
+    gsize map_size;
+    guint32 max_tracks;
+    guint64 interval_ns;
+    guint64 last_write_ns;
+    guint64 seq;                  // Último sellado (solo el probe)
+    GstClockTime last_pts;        // Último frame visto por el probe
+    guint written;
+
+    // Hilo de msync
+    GThread *thread;
+    GMutex lock;
+    GCond cond;
+    gboolean running;             // Protegido por lock
+    std::atomic<guint64> sealed_seq;
+};
+
+// Clave de la entrada: ubicación y, para archivos, fecha de modificación y tamaño
+guint64 checkpoint_input_key(const gchar *location, gboolean is_file);
+
+// Restaura el tracker desde un checkpoint sin terminar de la misma entrada;
+// devuelve FALSE (sin cambios) si no hay nada que reanudar
+gboolean checkpoint_resume(const gchar *path, guint64 input_key, TrackerContext *tracker,
+                           GstClockTime *pts);
+
+// Abre (o crea) el archivo; si se reanudó (resultado de checkpoint_resume)
+// conserva el último checkpoint hasta el siguiente, si no lo invalida
+gboolean checkpoint_init(CheckpointWriter *writer, const gchar *path, guint64 input_key,
+                         guint max_tracks, guint interval_ms, gboolean resumed);
+
+// Escribe y sella un checkpoint en la mitad inactiva
+void checkpoint_write(CheckpointWriter *writer, const TrackerContext *tracker,
+                      GstClockTime pts);
+
+guint64 checkpoint_now_ns(void);
+
+// Desde el probe del OSD: escribe si pasó el intervalo
+static inline void checkpoint_maybe_write(CheckpointWriter *writer,
+                                          const TrackerContext *tracker, GstClockTime pts) {
+    writer->last_pts = pts;
+    guint64 now = checkpoint_now_ns();
+    if (now - writer->last_write_ns < writer->interval_ns) return;
+    writer->last_write_ns = now;
+    checkpoint_write(writer, tracker, pts);
+}
+
+// Al EOS: último checkpoint marcado como terminado y msync
+void checkpoint_finish(CheckpointWriter *writer, const TrackerContext *tracker);
+
+void checkpoint_destroy(CheckpointWriter *writer);
+
+#endif // CHECKPOINT_HPP
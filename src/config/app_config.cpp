@@ -4,8 +4,24 @@
  */
 
 #include "app_config.hpp"
+#include "log/logger.hpp"
+#include "pipeline/geometry.hpp"
 #include <string.h>
 
+// Entero de una opción dentro de [min, max]; imprime el error si no lo es
+static gboolean parse_int_option(const gchar *option, const gchar *value,
+                                 gint min, gint max, gint *out) {
+    gchar *end = NULL;
+    gint64 v = g_ascii_strtoll(value, &end, 10);
+    if (end == value || *end != '\0' || v < min || v > max) {
+        g_printerr("ERROR: Valor invalido para %s: '%s' (entero entre %d y %d)\n",
+                   option, value, min, max);
+        return FALSE;
+    }
+    *out = (gint)v;
+    return TRUE;
+}
+
 gboolean parse_arguments(int argc, char *argv[], AppConfig *config, ROIParams *roi) {
     // Valores por defecto
     config->roi_width = 0.4f;
@@ -19,10 +35,63 @@ gboolean parse_arguments(int argc, char *argv[], AppConfig *config, ROIParams *r
     config->udp_port = 5000;
     config->udp_host = g_strdup("127.0.0.1");
     config->input_file = NULL;
+    config->udp_clients = NULL;
+    config->udp_multicast = NULL;
+    config->num_renditions = 0;
+    config->shm_name = NULL;
+    config->shm_slots = 4;
+    config->snapshot_dir = NULL;
+    config->snapshot_workers = 2;
+    config->snapshot_queue = 8;
+    config->snapshot_full = FALSE;
+    config->encoder = g_strdup("hw");
+    config->adaptive_bitrate = FALSE;
+    config->bitrate_active = 4000000;
+    config->bitrate_idle = 500000;
+    config->gop_active = 30;
+    config->gop_idle = 300;
+    config->idle_hold = 3.0;
+    config->profile = g_strdup("throughput");
+    config->latency_log = NULL;
+    config->media_cache = NULL;
+    config->decoder = g_strdup("auto");
+    config->jitter_latency = 200;
+    config->rtsp_tcp = FALSE;
+    config->topology = NULL;
+    config->bench_out = NULL;
+    config->metrics = NULL;
+    config->trace = NULL;
+    config->trace_buffer = 65536;
+    config->resource_log = NULL;
+    config->resource_interval = 500;
+    config->log_level = NULL;
+    config->log_format = NULL;
+    config->log_rate = NULL;
+    config->log_file = NULL;
+    config->classes = NULL;
+    config->class_time = NULL;
+    config->class_color = NULL;
+    config->checkpoint = NULL;
+    config->checkpoint_interval = 1000;
+    config->checkpoint_tracks = 4096;
+    config->config_file = NULL;
+    config->control_socket = NULL;
+    config->process_size = NULL;
+    config->tracker_size = NULL;
+    config->output_size = NULL;
+    config->heatmap = NULL;
+    config->heatmap_grid = NULL;
+    config->heatmap_interval = 60;
+    config->report_store = NULL;
+    config->trajectories = NULL;
+    config->trajectory_memory = 64;
+    config->window_stats = FALSE;
+    config->window_log = 60;
     
     gboolean center_roi = FALSE;
     gboolean left_specified = FALSE;
     gboolean top_specified = FALSE;
+    gboolean bitrate_idle_specified = FALSE;
     
     for (int i = 1; i < argc; i++) {
         if (g_strcmp0(argv[i], "--left") == 0 && i + 1 < argc) {
@@ -42,6 +111,9 @@ gboolean parse_arguments(int argc, char *argv[], AppConfig *config, ROIParams *r
         } else if (g_strcmp0(argv[i], "--file-name") == 0 && i + 1 < argc) {
             g_free(config->report_file);
             config->report_file = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--report-store") == 0 && i + 1 < argc) {
+            g_free(config->report_store);
+            config->report_store = g_strdup(argv[++i]);
         } else if (g_strcmp0(argv[i], "vi-file") == 0 && i + 1 < argc) {
             config->input_file = g_strdup(argv[++i]);
         } else if (g_strcmp0(argv[i], "vo-file") == 0 && i + 1 < argc) {
@@ -55,12 +127,185 @@ gboolean parse_arguments(int argc, char *argv[], AppConfig *config, ROIParams *r
             config->udp_host = g_strdup(argv[++i]);
         } else if (g_strcmp0(argv[i], "--udp-port") == 0 && i + 1 < argc) {
             config->udp_port = atoi(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--udp-clients") == 0 && i + 1 < argc) {
+            g_free(config->udp_clients);
+            config->udp_clients = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--udp-multicast") == 0 && i + 1 < argc) {
+            g_free(config->udp_multicast);
+            config->udp_multicast = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--rendition") == 0 && i + 1 < argc) {
+            if (config->num_renditions >= MAX_RENDITIONS) {
+                g_printerr("ERROR: Maximo %d renditions\n", MAX_RENDITIONS);
+                return FALSE;
+            }
+            UdpRendition check;
+            if (!udp_rendition_parse(argv[i + 1], &check)) {
+                g_printerr("ERROR: Rendition invalida '%s' (use WxH@kbps=host:port[,host:port])\n",
+                           argv[i + 1]);
+                return FALSE;
+            }
+            udp_rendition_clear(&check);
+            config->renditions[config->num_renditions++] = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--shm-export") == 0 && i + 1 < argc) {
+            g_free(config->shm_name);
+            config->shm_name = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--shm-slots") == 0 && i + 1 < argc) {
+            if (!parse_int_option(argv[i], argv[i + 1], 2, 256, &config->shm_slots)) {
+                return FALSE;
+            }
+            i++;
+        } else if (g_strcmp0(argv[i], "--snapshot-dir") == 0 && i + 1 < argc) {
+            g_free(config->snapshot_dir);
+            config->snapshot_dir = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--snapshot-workers") == 0 && i + 1 < argc) {
+            if (!parse_int_option(argv[i], argv[i + 1], 1, 64, &config->snapshot_workers)) {
+                return FALSE;
+            }
+            i++;
+        } else if (g_strcmp0(argv[i], "--snapshot-queue") == 0 && i + 1 < argc) {
+            if (!parse_int_option(argv[i], argv[i + 1], 1, 1024, &config->snapshot_queue)) {
+                return FALSE;
+            }
+            i++;
+        } else if (g_strcmp0(argv[i], "--snapshot-full") == 0) {
+            config->snapshot_full = TRUE;
+        } else if (g_strcmp0(argv[i], "--encoder") == 0 && i + 1 < argc) {
+            g_free(config->encoder);
+            config->encoder = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--adaptive-bitrate") == 0) {
+            config->adaptive_bitrate = TRUE;
+        } else if (g_strcmp0(argv[i], "--bitrate") == 0 && i + 1 < argc) {
+            if (!parse_int_option(argv[i], argv[i + 1], 10000, 100000000, &config->bitrate_active)) {
+                return FALSE;
+            }
+            i++;
+        } else if (g_strcmp0(argv[i], "--bitrate-idle") == 0 && i + 1 < argc) {
+            if (!parse_int_option(argv[i], argv[i + 1], 10000, 100000000, &config->bitrate_idle)) {
+                return FALSE;
+            }
+            bitrate_idle_specified = TRUE;
+            i++;
+        } else if (g_strcmp0(argv[i], "--gop") == 0 && i + 1 < argc) {
+            if (!parse_int_option(argv[i], argv[i + 1], 1, 3600, &config->gop_active)) {
+                return FALSE;
+            }
+            i++;
+        } else if (g_strcmp0(argv[i], "--gop-idle") == 0 && i + 1 < argc) {
+            if (!parse_int_option(argv[i], argv[i + 1], 1, 3600, &config->gop_idle)) {
+                return FALSE;
+            }
+            i++;
+        } else if (g_strcmp0(argv[i], "--idle-hold") == 0 && i + 1 < argc) {
+            config->idle_hold = g_strtod(argv[++i], NULL);
+        } else if (g_strcmp0(argv[i], "--profile") == 0 && i + 1 < argc) {
+            g_free(config->profile);
+            config->profile = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--latency-log") == 0 && i + 1 < argc) {
+            g_free(config->latency_log);
+            config->latency_log = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--media-cache") == 0 && i + 1 < argc) {
+            g_free(config->media_cache);
+            config->media_cache = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--decoder") == 0 && i + 1 < argc) {
+            g_free(config->decoder);
+            config->decoder = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--jitter-latency") == 0 && i + 1 < argc) {
+            config->jitter_latency = atoi(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--rtsp-tcp") == 0) {
+            config->rtsp_tcp = TRUE;
+        } else if (g_strcmp0(argv[i], "--topology") == 0 && i + 1 < argc) {
+            g_free(config->topology);
+            config->topology = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--bench-out") == 0 && i + 1 < argc) {
+            g_free(config->bench_out);
+            config->bench_out = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            g_free(config->metrics);
+            config->metrics = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--trace") == 0 && i + 1 < argc) {
+            g_free(config->trace);
+            config->trace = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--trace-buffer") == 0 && i + 1 < argc) {
+            config->trace_buffer = atoi(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--resource-log") == 0 && i + 1 < argc) {
+            g_free(config->resource_log);
+            config->resource_log = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--resource-interval") == 0 && i + 1 < argc) {
+            config->resource_interval = atoi(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            g_free(config->log_level);
+            config->log_level = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--log-format") == 0 && i + 1 < argc) {
+            g_free(config->log_format);
+            config->log_format = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--log-rate") == 0 && i + 1 < argc) {
+            g_free(config->log_rate);
+            config->log_rate = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--log-file") == 0 && i + 1 < argc) {
+            g_free(config->log_file);
+            config->log_file = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--classes") == 0 && i + 1 < argc) {
+            g_free(config->classes);
+            config->classes = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--class-time") == 0 && i + 1 < argc) {
+            g_free(config->class_time);
+            config->class_time = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--class-color") == 0 && i + 1 < argc) {
+            g_free(config->class_color);
+            config->class_color = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            g_free(config->checkpoint);
+            config->checkpoint = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--checkpoint-interval") == 0 && i + 1 < argc) {
+            config->checkpoint_interval = atoi(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--checkpoint-tracks") == 0 && i + 1 < argc) {
+            config->checkpoint_tracks = atoi(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--config") == 0 && i + 1 < argc) {
+            g_free(config->config_file);
+            config->config_file = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--control-socket") == 0 && i + 1 < argc) {
+            g_free(config->control_socket);
+            config->control_socket = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--process-size") == 0 && i + 1 < argc) {
+            g_free(config->process_size);
+            config->process_size = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--tracker-size") == 0 && i + 1 < argc) {
+            g_free(config->tracker_size);
+            config->tracker_size = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--output-size") == 0 && i + 1 < argc) {
+            g_free(config->output_size);
+            config->output_size = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--heatmap") == 0 && i + 1 < argc) {
+            g_free(config->heatmap);
+            config->heatmap = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--heatmap-grid") == 0 && i + 1 < argc) {
+            g_free(config->heatmap_grid);
+            config->heatmap_grid = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--heatmap-interval") == 0 && i + 1 < argc) {
+            config->heatmap_interval = atoi(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--trajectories") == 0 && i + 1 < argc) {
+            g_free(config->trajectories);
+            config->trajectories = g_strdup(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--trajectory-memory") == 0 && i + 1 < argc) {
+            config->trajectory_memory = atoi(argv[++i]);
+        } else if (g_strcmp0(argv[i], "--window-stats") == 0) {
+            config->window_stats = TRUE;
+        } else if (g_strcmp0(argv[i], "--window-log") == 0 && i + 1 < argc) {
+            config->window_stats = TRUE;
+            config->window_log = atoi(argv[++i]);
         }
     }
     
     if (!config->input_file) {
         g_printerr("Error: Debe especificar vi-file <input>\n");
         g_printerr("Uso: %s vi-file <input.mp4> [opciones]\n", argv[0]);
+        g_printerr("\nEntrada (vi-file):\n");
+        g_printerr("  <archivo>|file://...  : MP4, MKV, TS... con H.264 o H.265\n");
+        g_printerr("  rtsp://host/ruta      : Camara RTSP\n");
+        g_printerr("  rtp://host:puerto[?codec=h265] : RTP por UDP (unicast o multicast)\n");
+        g_printerr("  --decoder auto|hw|sw  : Decodificador (default: auto)\n");
+        g_printerr("  --jitter-latency <ms> : Jitterbuffer RTSP/RTP (default: 200)\n");
+        g_printerr("  --rtsp-tcp            : RTSP intercalado sobre TCP\n");
         g_printerr("\nOpciones de ROI:\n");
         g_printerr("  --width <0-1>     : Ancho del ROI normalizado (default: 0.4)\n");
         g_printerr("  --height <0-1>    : Alto del ROI normalizado (default: 0.4)\n");
@@ -68,6 +313,15 @@ gboolean parse_arguments(int argc, char *argv[], AppConfig *config, ROIParams *r
         g_printerr("  --top <0-1>       : Posicion Y del ROI\n");
         g_printerr("  --center          : Centrar el ROI automaticamente\n");
         g_printerr("  --time <seg>      : Tiempo maximo en ROI (default: 5)\n");
+        g_printerr("  --classes <lista> : Clases seguidas: \"vehicles\" o ids \"0,2,5,7\" (default: 0)\n");
+        g_printerr("  --class-time <id>=<seg>,...    : Tiempo maximo por clase\n");
+        g_printerr("  --class-color <id>=RRGGBB,...  : Color del borde fuera del ROI por clase\n");
+        g_printerr("  --config <ini>    : ROI, tiempo y clases desde archivo; se recarga al cambiar\n");
+        g_printerr("  --control-socket <ruta> : Socket Unix para cambiar la configuracion en caliente\n");
+        g_printerr("\nResolucion (auto, source o WxH; siempre con el aspecto de la fuente):\n");
+        g_printerr("  --process-size <tam>  : Inferencia y OSD (default: auto, hasta 1280x736)\n");
+        g_printerr("  --tracker-size <tam>  : nvtracker (default: auto, hasta 640x368)\n");
+        g_printerr("  --output-size <tam>   : Video codificado (default: la de proceso)\n");
         g_printerr("\nModos de salida:\n");
         g_printerr("  --mode video      : Guardar a archivo (default)\n");
         g_printerr("  --mode udp        : Streaming por UDP/RTP\n");
@@ -75,8 +329,61 @@ gboolean parse_arguments(int argc, char *argv[], AppConfig *config, ROIParams *r
         g_printerr("  vo-file <archivo> : Archivo de salida (modo video)\n");
         g_printerr("  --udp-host <host> : Host para UDP (default: 127.0.0.1)\n");
         g_printerr("  --udp-port <port> : Puerto para UDP (default: 5000)\n");
+        g_printerr("  --udp-clients <lista>     : Clientes extra host:port[,host:port]\n");
+        g_printerr("  --udp-multicast <grupo:port> : Enviar tambien a un grupo multicast\n");
+        g_printerr("  --rendition WxH@kbps=<lista> : Rendition extra para clientes lentos (max 4)\n");
+        g_printerr("\nCodificacion:\n");
+        g_printerr("  --encoder hw|x264     : Encoder por hardware o CPU (default: hw)\n");
+        g_printerr("  --bitrate <bps>       : Bitrate con actividad, 10000-100000000 (default: 4000000)\n");
+        g_printerr("  --gop <frames>        : Frames entre keyframes, 1-3600 (default: 30)\n");
+        g_printerr("  --adaptive-bitrate    : Bajar bitrate y alargar GOP sin actividad en el ROI\n");
+        g_printerr("  --bitrate-idle <bps>  : Bitrate en reposo, hasta --bitrate (default: 500000)\n");
+        g_printerr("  --gop-idle <frames>   : Frames entre keyframes en reposo, 1-3600 (default: 300)\n");
+        g_printerr("  --idle-hold <seg>     : Espera sin actividad antes de bajar (default: 3)\n");
+        g_printerr("\nLatencia:\n");
+        g_printerr("  --profile live        : Perfil de baja latencia (default: throughput)\n");
+        g_printerr("  --latency-log <arch>  : Registrar marcas de ingreso para tools/latency_probe\n");
+        g_printerr("\nTopologia de hilos:\n");
+        g_printerr("  --topology <spec>     : Queues por etapa, p.ej. \"infer:4,osd:2:leaky@2\"\n");
+        g_printerr("                          etapas: mux, infer, track, osd, encode, output; \"none\"\n");
+        g_printerr("  --bench-out <csv>     : Agregar FPS, latencia por frame y etapa, RSS y CPU al CSV\n");
+        g_printerr("\nMetricas:\n");
+        g_printerr("  --metrics <endpoint>  : Metricas Prometheus por HTTP: <puerto>, <host:puerto>\n");
+        g_printerr("                          o unix:<ruta> (p.ej. --metrics 9100)\n");
+        g_printerr("  --trace <json>        : Traza por frame para Perfetto/chrome://tracing\n");
+        g_printerr("  --trace-buffer <n>    : Eventos por hilo en la traza (default: 65536)\n");
+        g_printerr("  --resource-log <csv>  : Muestrear RSS, CPU por hilo y GPU/EMC (Jetson) al CSV\n");
+        g_printerr("  --resource-interval <ms> : Intervalo de muestreo (default: 500)\n");
+        g_printerr("\nLog:\n");
+        g_printerr("  --log-level <nivel>   : debug, info, warn o error (default: info)\n");
+        g_printerr("  --log-format plain|json : Formato de cada linea (default: plain)\n");
+        g_printerr("  --log-rate <spec>     : Limites por categoria, p.ej. \"tracker=5/1,render=1/60\"\n");
+        g_printerr("                          categorias: app, pipeline, tracker, render; n=0 sin limite\n");
+        g_printerr("  --log-file <archivo>  : Escribir el log a un archivo (default: stdout)\n");
+        g_printerr("\nCheckpoints:\n");
+        g_printerr("  --checkpoint <archivo> : Guardar el estado del tracker y reanudar tras una caida\n");
+        g_printerr("  --checkpoint-interval <ms> : Intervalo entre checkpoints (default: 1000)\n");
+        g_printerr("  --checkpoint-tracks <n> : Tracks maximos por checkpoint (default: 4096)\n");
+        g_printerr("\nMapa de ocupacion:\n");
+        g_printerr("  --heatmap <archivo>   : Acumular presencia y permanencia por celda\n");
+        g_printerr("  --heatmap-grid <WxH>  : Celdas de la grilla (default: 64x36)\n");
+        g_printerr("  --heatmap-interval <s>: Segundos entre copias a disco (default: 60)\n");
+        g_printerr("\nTrayectorias:\n");
+        g_printerr("  --trajectories <arch> : Registrar bbox y estado de cada track por frame\n");
+        g_printerr("  --trajectory-memory <MB> : Memoria maxima para trayectorias (default: 64)\n");
+        g_printerr("\nVentanas deslizantes:\n");
+        g_printerr("  --window-stats        : Entradas/min, ocupacion y permanencia en 5/15/60 min\n");
+        g_printerr("  --window-log <s>      : Segundos entre lineas de log (default: 60, 0 = sin log)\n");
         g_printerr("\nOtras opciones:\n");
         g_printerr("  --file-name <archivo> : Nombre del archivo de reporte\n");
+        g_printerr("  --report-store <arch> : Reporte columnar por tiempo de entrada (ver report_query)\n");
+        g_printerr("  --media-cache <arch>  : Cache de resolucion por archivo (ruta+mtime+tamano)\n");
+        g_printerr("  --shm-export <nombre> : Exportar frames y metadatos a memoria compartida\n");
+        g_printerr("  --shm-slots <n>       : Slots del anillo compartido, 2-256 (default: 4)\n");
+        g_printerr("  --snapshot-dir <dir>  : Guardar JPEG de cada vehiculo al entrar en alerta\n");
+        g_printerr("  --snapshot-workers <n>: Hilos de codificacion JPEG, 1-64 (default: 2)\n");
+        g_printerr("  --snapshot-queue <n>  : Capturas en cola antes de descartar, 1-1024 (default: 8)\n");
+        g_printerr("  --snapshot-full       : Guardar el frame completo en vez del recorte\n");
         g_printerr("\nEjemplos:\n");
         g_printerr("  # Guardar a archivo\n");
         g_printerr("  %s vi-file input.mp4 vo-file output.mp4\n", argv[0]);
@@ -92,6 +399,62 @@ gboolean parse_arguments(int argc, char *argv[], AppConfig *config, ROIParams *r
         return FALSE;
     }
     
+    // Validar encoder
+    if (g_strcmp0(config->encoder, "hw") != 0 &&
+        g_strcmp0(config->encoder, "x264") != 0) {
+        g_printerr("ERROR: Encoder invalido '%s'. Use 'hw' o 'x264'\n", config->encoder);
+        return FALSE;
+    }
+    
+    // Validar decodificador
+    if (g_strcmp0(config->decoder, "auto") != 0 &&
+        g_strcmp0(config->decoder, "hw") != 0 &&
+        g_strcmp0(config->decoder, "sw") != 0) {
+        g_printerr("ERROR: Decodificador invalido '%s'. Use 'auto', 'hw' o 'sw'\n", config->decoder);
+        return FALSE;
+    }
+    
+    // Validar perfil
+    if (g_strcmp0(config->profile, "throughput") != 0 &&
+        g_strcmp0(config->profile, "live") != 0) {
+        g_printerr("ERROR: Perfil invalido '%s'. Use 'throughput' o 'live'\n", config->profile);
+        return FALSE;
+    }
+    
+    // Validar resoluciones
+    const gchar *size_specs[] = { config->process_size, config->tracker_size,
+                                  config->output_size };
+    for (const gchar *spec : size_specs) {
+        SizeSpec size;
+        if (!geometry_parse_size(spec, &size)) {
+            g_printerr("ERROR: Resolucion invalida '%s'. Use 'auto', 'source' o WxH\n", spec);
+            return FALSE;
+        }
+    }
+    
+    // Validar bitrate: el de reposo no puede superar al de actividad (el
+    // default se ajusta a un --bitrate menor)
+    if (!bitrate_idle_specified) {
+        config->bitrate_idle = MIN(config->bitrate_idle, config->bitrate_active);
+    } else if (config->bitrate_idle > config->bitrate_active) {
+        g_printerr("ERROR: --bitrate-idle (%d) mayor que --bitrate (%d)\n",
+                   config->bitrate_idle, config->bitrate_active);
+        return FALSE;
+    }
+    
+    // Validar log
+    LogLevel log_level;
+    if (config->log_level && !logger_parse_level(config->log_level, &log_level)) {
+        g_printerr("ERROR: Nivel de log invalido '%s'. Use 'debug', 'info', 'warn' o 'error'\n",
+                   config->log_level);
+        return FALSE;
+    }
+    if (config->log_format && g_strcmp0(config->log_format, "plain") != 0 &&
+        g_strcmp0(config->log_format, "json") != 0) {
+        g_printerr("ERROR: Formato de log invalido '%s'. Use 'plain' o 'json'\n", config->log_format);
+        return FALSE;
+    }
+    
     // Aplicar centrado si: --center O no se especificaron left/top
     if (center_roi || (!left_specified && !top_specified)) {
         config->roi_left = (1.0f - config->roi_width) / 2.0f;
@@ -8,10 +8,11 @@
 
 #include <gst/gst.h>
 #include <glib.h>
+#include "stream/udp_outputs.hpp"
 
 // Parámetros de la aplicación
 struct AppConfig {
-    gchar *input_file;
+    gchar *input_file;      // Ruta o URI (file://, rtsp://, rtp://host:puerto)
     gchar *output_file;
     gchar *report_file;
     gfloat roi_left;
@@ -22,6 +23,59 @@ struct AppConfig {
     gchar *mode;
     gint udp_port;
     gchar *udp_host;
+    gchar *udp_clients;     // Clientes unicast extra "host:port,host:port"
+    gchar *udp_multicast;   // Grupo multicast "grupo:port" (o NULL)
+    gchar *renditions[MAX_RENDITIONS];  // Especificaciones de renditions extra
+    gint num_renditions;
+    gchar *shm_name;        // Segmento de memoria compartida (NULL = desactivado)
+    gint shm_slots;         // Slots del anillo de memoria compartida
+    gchar *snapshot_dir;    // Directorio de capturas de alertas (NULL = desactivado)
+    gint snapshot_workers;  // Hilos de codificación JPEG
+    gint snapshot_queue;    // Trabajos máximos en cola antes de descartar
+    gboolean snapshot_full; // Frame completo en vez de recorte del bbox
+    gchar *encoder;         // "hw" (nvv4l2h264enc) o "x264" (CPU)
+    gboolean adaptive_bitrate;
+    gint bitrate_active;    // bit/s con actividad en la escena
+    gint bitrate_idle;      // bit/s en reposo
+    gint gop_active;        // Frames entre keyframes con actividad
+    gint gop_idle;          // Frames entre keyframes en reposo
+    gdouble idle_hold;      // Segundos sin actividad antes de bajar el bitrate
+    gchar *profile;         // "throughput" (default) o "live" (baja latencia)
+    gchar *latency_log;     // Archivo de marcas de ingreso (o NULL)
+    gchar *media_cache;     // Cache de resolución/framerate por archivo (o NULL)
+    gchar *decoder;         // "auto", "hw" (nvv4l2decoder) o "sw" (avdec)
+    gint jitter_latency;    // ms de jitterbuffer para RTSP/RTP
+    gboolean rtsp_tcp;      // RTSP sobre TCP
+    gchar *topology;        // Fronteras de hilo (NULL = según el perfil)
+    gchar *bench_out;       // CSV de benchmark (o NULL)
+    gchar *metrics;         // Endpoint de métricas (puerto, host:puerto o unix:ruta)
+    gchar *trace;           // Archivo JSON de trazas Chrome/Perfetto (o NULL)
+    gint trace_buffer;      // Eventos por hilo en el anillo de trazas
+    gchar *resource_log;    // CSV de muestras de recursos (o NULL)
+    gint resource_interval; // ms entre muestras de recursos
+    gchar *log_level;       // "debug", "info" (default), "warn" o "error"
+    gchar *log_format;      // "plain" (default) o "json"
+    gchar *log_rate;        // Límites "<categoría>=<n>/<seg>,..." (o NULL)
+    gchar *log_file;        // Archivo de log (NULL = stdout)
+    gchar *classes;         // Clases seguidas: "vehicles" o "0,2,..." (NULL = Car)
+    gchar *class_time;      // Umbral por clase "<id>=<seg>,..." (o NULL)
+    gchar *class_color;     // Color fuera del ROI "<id>=RRGGBB,..." (o NULL)
+    gchar *checkpoint;      // Archivo de checkpoints del tracker (o NULL)
+    gint checkpoint_interval; // ms entre checkpoints
+    gint checkpoint_tracks; // Tracks máximos por checkpoint
+    gchar *config_file;     // ROI/umbral/clases, vigilado en caliente (o NULL)
+    gchar *control_socket;  // Socket Unix de reconfiguración (o NULL)
+    gchar *process_size;    // Resolución del muxer: "auto", "source" o "WxH" (NULL = auto)
+    gchar *tracker_size;    // Resolución de nvtracker (NULL = auto)
+    gchar *output_size;     // Resolución del encoder (NULL = la de proceso)
+    gchar *heatmap;         // Archivo de la grilla de ocupación (o NULL)
+    gchar *heatmap_grid;    // Celdas "WxH" (NULL = 64x36)
+    gint heatmap_interval;  // s entre copias a disco
+    gchar *report_store;    // Reporte columnar para report_query (o NULL)
+    gchar *trajectories;    // Archivo de trayectorias (o NULL)
+    gint trajectory_memory; // MB máximos para trayectorias en memoria
+    gboolean window_stats;  // Estadísticas en ventanas de 5/15/60 min
+    gint window_log;        // s entre líneas de log de las ventanas (0 = sin log)
 };
 
 // ROI normalizado (0-1)
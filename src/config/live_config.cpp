@@ -0,0 +1,362 @@
+/*
+ * live_config.cpp
+ * Implementación de la reconfiguración en caliente
+ */
+
+#include "live_config.hpp"
+#include "log/logger.hpp"
+#include <errno.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static gboolean fail(gchar **error, const gchar *format, ...) G_GNUC_PRINTF(2, 3);
+
+static gboolean fail(gchar **error, const gchar *format, ...) {
+    va_list args;
+    va_start(args, format);
+    *error = g_strdup_vprintf(format, args);
+    va_end(args);
+    return FALSE;
+}
+
+// Lee un valor normalizado (0-1) obligatorio de un grupo de ROI
+static gboolean read_fraction(GKeyFile *kf, const gchar *group, const gchar *key,
+                              gfloat *value, gchar **error) {
+    GError *err = NULL;
+    gdouble v = g_key_file_get_double(kf, group, key, &err);
+    if (err) {
+        g_error_free(err);
+        return fail(error, "[%s] %s missing or not a number", group, key);
+    }
+    if (v < 0.0 || v > 1.0) return fail(error, "[%s] %s=%.3f out of range 0-1", group, key, v);
+    *value = (gfloat)v;
+    return TRUE;
+}
+
+static gboolean parse_tracker_group(GKeyFile *kf, TrackerConfig *cfg, gchar **error) {
+    GError *err = NULL;
+    if (g_key_file_has_key(kf, "tracker", "time", NULL)) {
+        gint seconds = g_key_file_get_integer(kf, "tracker", "time", &err);
+        if (err || seconds <= 0) {
+            if (err) g_error_free(err);
+            return fail(error, "[tracker] time must be an integer > 0");
+        }
+        cfg->max_time_seconds = seconds;
+    }
+    if (g_key_file_has_key(kf, "tracker", "classes", NULL)) {
+        gchar *classes = g_key_file_get_string(kf, "tracker", "classes", NULL);
+        gboolean ok = classes && tracker_parse_classes(classes, &cfg->class_mask);
+        g_free(classes);
+        if (!ok) {
+            return fail(error, "[tracker] classes must be \"vehicles\" or class ids (0;2;5)");
+        }
+    }
+    return TRUE;
+}
+
+// [class <id>]: umbral y color propios de una clase
+static gboolean parse_class_group(GKeyFile *kf, const gchar *group, TrackerConfig *cfg,
+                                  gchar **error) {
+    gchar *end = NULL;
+    gint64 id = g_ascii_strtoll(group + 6, &end, 10);
+    if (end == group + 6 || *end != '\0' || id < 0 || id >= TRACKER_MAX_CLASSES) {
+        return fail(error, "[%s] class id out of range 0-%d", group, TRACKER_MAX_CLASSES - 1);
+    }
+    GError *err = NULL;
+    if (g_key_file_has_key(kf, group, "time", NULL)) {
+        gint seconds = g_key_file_get_integer(kf, group, "time", &err);
+        if (err || seconds < 0) {
+            if (err) g_error_free(err);
+            return fail(error, "[%s] time must be an integer >= 0 (0 = tracker time)", group);
+        }
+        cfg->class_time[id] = seconds;
+    }
+    if (g_key_file_has_key(kf, group, "color", NULL)) {
+        gchar *color = g_key_file_get_string(kf, group, "color", NULL);
+        gboolean ok = color && tracker_parse_color(color, &cfg->class_color[id]);
+        g_free(color);
+        if (!ok) return fail(error, "[%s] color must be RRGGBB", group);
+        cfg->class_has_color[id] = TRUE;
+    }
+    return TRUE;
+}
+
+gboolean live_config_parse(const gchar *data, gsize length, TrackerConfig *base,
+                           gchar **error) {
+    GKeyFile *kf = g_key_file_new();
+    GError *err = NULL;
+    if (!g_key_file_load_from_data(kf, data, length, G_KEY_FILE_NONE, &err)) {
+        fail(error, "%s", err->message);
+        g_error_free(err);
+        g_key_file_free(kf);
+        return FALSE;
+    }
+
+    // Se arma sobre una copia: un error no deja cambios a medias
+    TrackerConfig cfg = *base;
+    guint num_rois = 0;
+    gboolean ok = TRUE;
+    gchar **groups = g_key_file_get_groups(kf, NULL);
+    for (gint i = 0; groups[i] && ok; i++) {
+        const gchar *group = groups[i];
+        if (g_strcmp0(group, "tracker") == 0) {
+            ok = parse_tracker_group(kf, &cfg, error);
+        } else if (g_strcmp0(group, "roi") == 0 || g_str_has_prefix(group, "roi ")) {
+            if (num_rois == TRACKER_MAX_ROIS) {
+                ok = fail(error, "more than %d ROI groups", TRACKER_MAX_ROIS);
+                break;
+            }
+            ROIParams *roi = &cfg.rois[num_rois];
+            ok = read_fraction(kf, group, "left", &roi->x, error) &&
+                 read_fraction(kf, group, "top", &roi->y, error) &&
+                 read_fraction(kf, group, "width", &roi->w, error) &&
+                 read_fraction(kf, group, "height", &roi->h, error);
+            if (ok && (roi->w <= 0.0f || roi->h <= 0.0f)) {
+                ok = fail(error, "[%s] width and height must be > 0", group);
+            }
+            if (ok) {
+                // Mismo ajuste que parse_arguments: el ROI no sale del frame
+                if (roi->x + roi->w > 1.0f) roi->x = 1.0f - roi->w;
+                if (roi->y + roi->h > 1.0f) roi->y = 1.0f - roi->h;
+                num_rois++;
+            }
+        } else if (g_str_has_prefix(group, "class ")) {
+            ok = parse_class_group(kf, group, &cfg, error);
+        } else {
+            ok = fail(error, "unknown group [%s]", group);
+        }
+    }
+    g_strfreev(groups);
+    g_key_file_free(kf);
+
+    if (!ok) return FALSE;
+    if (num_rois > 0) cfg.num_rois = num_rois;
+    tracker_config_finalize(&cfg);
+    *base = cfg;
+    return TRUE;
+}
+
+// Publica el resultado de aplicar data sobre la última configuración
+static gboolean apply_text(LiveConfig *live, const gchar *data, gsize length,
+                           const gchar *origin, gchar **error) {
+    TrackerConfig next = live->latest;
+    if (!live_config_parse(data, length, &next, error)) {
+        live->rejected++;
+        ROI_LOG_WARN(LOG_CAT_APP, "Live config from %s rejected: %s", origin, *error);
+        return FALSE;
+    }
+    next.version = live->latest.version + 1;
+    next.next_retired = NULL;
+    live->latest = next;
+
+    TrackerConfig *published = g_new(TrackerConfig, 1);
+    *published = next;
+    tracker_publish_config(live->tracker, published);
+    live->applied++;
+    ROI_LOG_INFO(LOG_CAT_APP, "Live config v%u published from %s", next.version, origin);
+    return TRUE;
+}
+
+static gboolean load_file(LiveConfig *live, gchar **error) {
+    struct stat st;
+    if (stat(live->file_path, &st) == 0) {
+        live->file_mtime = st.st_mtim;
+        live->file_size = st.st_size;
+    }
+    gchar *contents = NULL;
+    gsize length = 0;
+    GError *err = NULL;
+    if (!g_file_get_contents(live->file_path, &contents, &length, &err)) {
+        fail(error, "%s", err->message);
+        g_error_free(err);
+        live->rejected++;
+        return FALSE;
+    }
+    gboolean ok = apply_text(live, contents, length, live->file_path, error);
+    g_free(contents);
+    return ok;
+}
+
+// Recarga el archivo si cambió su fecha de modificación o su tamaño
+static void check_file(LiveConfig *live) {
+    struct stat st;
+    if (stat(live->file_path, &st) != 0) return;
+    if (st.st_mtim.tv_sec == live->file_mtime.tv_sec &&
+        st.st_mtim.tv_nsec == live->file_mtime.tv_nsec &&
+        st.st_size == live->file_size) {
+        return;
+    }
+    gchar *error = NULL;
+    load_file(live, &error);
+    g_free(error);
+}
+
+static void append_config(GString *out, const TrackerConfig *cfg) {
+    g_string_append_printf(out, "[tracker]\nversion=%u\ntime=%d\nclasses=",
+                           cfg->version, cfg->max_time_seconds);
+    for (gint c = 0; c < TRACKER_MAX_CLASSES; c++) {
+        if ((cfg->class_mask >> c) & 1) g_string_append_printf(out, "%d;", c);
+    }
+    g_string_append(out, "\n");
+    for (gint c = 0; c < TRACKER_MAX_CLASSES; c++) {
+        if (!cfg->class_time[c] && !cfg->class_has_color[c]) continue;
+        g_string_append_printf(out, "\n[class %d]\ntime=%d\n", c, cfg->class_time[c]);
+        if (cfg->class_has_color[c]) {
+            g_string_append_printf(out, "color=%02x%02x%02x\n",
+                                   (guint)(cfg->class_color[c].red * 255.0 + 0.5),
+                                   (guint)(cfg->class_color[c].green * 255.0 + 0.5),
+                                   (guint)(cfg->class_color[c].blue * 255.0 + 0.5));
+        }
+    }
+    for (guint z = 0; z < cfg->num_rois; z++) {
+        g_string_append_printf(out, "\n[roi %u]\nleft=%.4f\ntop=%.4f\nwidth=%.4f\nheight=%.4f\n",
+                               z, cfg->rois[z].x, cfg->rois[z].y, cfg->rois[z].w, cfg->rois[z].h);
+    }
+}
+
+// Petición: "show", "reload" o un GKeyFile completo; termina al cerrar el
+// cliente su escritura o tras un segundo sin datos
+static void serve_client(LiveConfig *live, int fd) {
+    GString *request = g_string_new(NULL);
+    gchar buf[4096];
+    gboolean too_large = FALSE;
+    for (;;) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 1000) <= 0) break;
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        g_string_append_len(request, buf, n);
+        if (request->len > LIVE_CONFIG_MAX_REQUEST) {
+            too_large = TRUE;
+            break;
+        }
+    }
+
+    GString *reply = g_string_new(NULL);
+    gchar *command = g_strstrip(g_strdup(request->str));
+    gchar *error = NULL;
+    if (too_large) {
+        g_string_append(reply, "ERROR request too large\n");
+    } else if (g_strcmp0(command, "show") == 0) {
+        append_config(reply, &live->latest);
+    } else if (g_strcmp0(command, "reload") == 0 && !live->file_path) {
+        g_string_append(reply, "ERROR no config file to reload\n");
+    } else if (g_strcmp0(command, "reload") == 0 ? load_file(live, &error)
+               : apply_text(live, request->str, request->len, "control socket", &error)) {
+        g_string_append_printf(reply, "OK v%u\n", live->latest.version);
+    } else {
+        g_string_append_printf(reply, "ERROR %s\n", error);
+    }
+    g_free(error);
+    g_free(command);
+    g_string_free(request, TRUE);
+
+    gsize sent = 0;
+    while (sent < reply->len) {
+        ssize_t n = send(fd, reply->str + sent, reply->len - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += (gsize)n;
+    }
+    g_string_free(reply, TRUE);
+}
+
+static gpointer control_thread(gpointer data) {
+    LiveConfig *live = (LiveConfig *)data;
+    while (live->running.load(std::memory_order_acquire)) {
+        struct pollfd pfd = { live->listen_fd, POLLIN, 0 };
+        // Sin socket, poll con fd negativo solo espera el intervalo
+        if (poll(&pfd, 1, LIVE_CONFIG_POLL_MS) > 0 && (pfd.revents & POLLIN)) {
+            int client = accept(live->listen_fd, NULL, NULL);
+            if (client >= 0) {
+                serve_client(live, client);
+                close(client);
+            }
+        }
+        if (live->file_path) check_file(live);
+        tracker_reclaim_configs(live->tracker);
+    }
+    return NULL;
+}
+
+static int open_socket(const gchar *path) {
+    struct sockaddr_un addr;
+    if (strlen(path) == 0 || strlen(path) >= sizeof(addr.sun_path)) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+gboolean live_config_init(LiveConfig *live, TrackerContext *tracker,
+                          const gchar *file_path, const gchar *socket_path) {
+    live->tracker = tracker;
+    live->file_path = g_strdup(file_path);
+    live->socket_path = NULL;
+    live->listen_fd = -1;
+    live->file_mtime.tv_sec = 0;
+    live->file_mtime.tv_nsec = 0;
+    live->file_size = -1;
+    live->latest = *tracker->config;
+    live->applied = 0;
+    live->rejected = 0;
+    live->thread = NULL;
+    live->running.store(false, std::memory_order_relaxed);
+
+    if (file_path) {
+        gchar *error = NULL;
+        if (!load_file(live, &error)) {
+            g_printerr("Config: %s: %s\n", file_path, error);
+            g_free(error);
+            return FALSE;
+        }
+        // El pipeline aún no corre: se aplica ya para que el resumen inicial
+        // y el primer frame usen la configuración del archivo
+        tracker_swap_config(tracker);
+        tracker_reclaim_configs(tracker);
+    }
+
+    if (socket_path) {
+        live->listen_fd = open_socket(socket_path);
+        if (live->listen_fd < 0) {
+            g_printerr("Config: could not listen on %s: %s\n", socket_path, strerror(errno));
+            return FALSE;
+        }
+        live->socket_path = g_strdup(socket_path);
+    }
+
+    live->running.store(true, std::memory_order_release);
+    live->thread = g_thread_new("live-config", control_thread, live);
+    g_print("Live config:%s%s%s%s\n",
+            file_path ? " watching " : "", file_path ? file_path : "",
+            socket_path ? " socket " : "", socket_path ? socket_path : "");
+    return TRUE;
+}
+
+void live_config_destroy(LiveConfig *live) {
+    if (live->thread) {
+        live->running.store(false, std::memory_order_release);
+        g_thread_join(live->thread);
+        live->thread = NULL;
+    }
+    if (live->listen_fd >= 0) close(live->listen_fd);
+    live->listen_fd = -1;
+    if (live->socket_path) unlink(live->socket_path);
+    if (live->applied || live->rejected) {
+        g_print("Live config: %u change(s) applied, %u rejected\n", live->applied, live->rejected);
+    }
+    g_free(live->file_path);
+    g_free(live->socket_path);
+    live->file_path = NULL;
+    live->socket_path = NULL;
+}
@@ -0,0 +1,67 @@
+/*
+ * live_config.hpp
+ * Reconfiguración en caliente de ROI, umbral de tiempo y clases
+ *
+ * Un hilo de control vigila un archivo de configuración (formato GKeyFile) y
+ * atiende un socket Unix. Cada cambio válido se arma como una TrackerConfig
+ * nueva a partir de la última publicada y se publica con un puntero atómico;
+ * el probe del OSD la toma al inicio del siguiente frame, sin locks. Las
+ * configuraciones reemplazadas se liberan desde este mismo hilo.
+ *
+ *   [tracker]
+ *   time=8
+ *   classes=0;2          (o "vehicles")
+ *
+ *   [class 2]
+ *   time=3
+ *   color=00ffff
+ *
+ *   [roi entrada]
+ *   left=0.1
+ *   top=0.2
+ *   width=0.3
+ *   height=0.4
+ *
+ * Los grupos "roi ..." (hasta TRACKER_MAX_ROIS) reemplazan el conjunto de
+ * ROI completo; las claves que no aparecen conservan su valor actual.
+ */
+
+#ifndef LIVE_CONFIG_HPP
+#define LIVE_CONFIG_HPP
+
+#include <glib.h>
+#include <sys/types.h>
+#include <time.h>
+#include <atomic>
+#include "track_info.hpp"
+
+#define LIVE_CONFIG_POLL_MS 500
+#define LIVE_CONFIG_MAX_REQUEST (64 * 1024)
+
+struct LiveConfig {
+    TrackerContext *tracker;
+    gchar *file_path;           // Archivo vigilado (o NULL)
+    gchar *socket_path;         // Socket de control (o NULL)
+    int listen_fd;
+    struct timespec file_mtime;
+    off_t file_size;
+    TrackerConfig latest;       // Última publicada; solo la usa el hilo de control
+    guint applied;              // Cambios aceptados
+    guint rejected;             // Cambios con errores
+    GThread *thread;
+    std::atomic<bool> running;
+};
+
+// Aplica la configuración inicial del archivo (si hay) antes de arrancar el
+// pipeline y lanza el hilo de control
+gboolean live_config_init(LiveConfig *live, TrackerContext *tracker,
+                          const gchar *file_path, const gchar *socket_path);
+
+// Aplica sobre base el contenido de un GKeyFile; en error devuelve FALSE,
+// deja base sin cambios y describe el problema en *error
+gboolean live_config_parse(const gchar *data, gsize length, TrackerConfig *base,
+                           gchar **error);
+
+void live_config_destroy(LiveConfig *live);
+
+#endif // LIVE_CONFIG_HPP
@@ -4,22 +4,215 @@
  */
 
 #include "track_info.hpp"
+#include "log/logger.hpp"
+#include <stdlib.h>
 #include <string.h>
 
-void tracker_init(TrackerContext *ctx, const ROIParams *roi, gint max_time, GTimer *app_timer) {
-    ctx->roi = *roi;
-    ctx->max_time_seconds = max_time;
+void tracker_config_defaults(TrackerConfig *config, const ROIParams *roi, gint max_time) {
+    memset(config, 0, sizeof(*config));
+    config->rois[0] = *roi;
+    config->num_rois = 1;
+    config->max_time_seconds = max_time;
+    config->class_mask = 1ULL << 0;   // Car
+    tracker_config_finalize(config);
+}
+
+void tracker_config_finalize(TrackerConfig *config) {
+    guint64 mask = config->class_mask;
+    if (mask != 0 && (mask & (mask - 1)) == 0) {
+        config->class_mode = CLASS_MODE_SINGLE;
+        config->single_class = __builtin_ctzll(mask);
+    } else {
+        config->class_mode = (mask == TRACKER_VEHICLE_CLASSES) ? CLASS_MODE_VEHICLES
+                                                               : CLASS_MODE_SET;
+        config->single_class = -1;
+    }
+    
+    // Tablas resueltas: el probe no consulta valores por defecto
+    for (gint c = 0; c < TRACKER_MAX_CLASSES; c++) {
+        config->dwell_seconds[c] = config->class_time[c] > 0 ? config->class_time[c]
+                                                             : config->max_time_seconds;
+        if (config->class_has_color[c]) {
+            config->outside_color[c] = config->class_color[c];
+        } else {
+            // Verde por defecto
+            config->outside_color[c].red = 0.0f;
+            config->outside_color[c].green = 1.0f;
+            config->outside_color[c].blue = 0.0f;
+            config->outside_color[c].alpha = 1.0f;
+        }
+    }
+}
+
+gboolean tracker_parse_classes(const gchar *spec, guint64 *mask) {
+    if (g_strcmp0(spec, "vehicles") == 0) {
+        *mask = TRACKER_VEHICLE_CLASSES;
+        return TRUE;
+    }
+    gchar **items = g_strsplit_set(spec, ",;", -1);
+    guint64 result = 0;
+    gboolean ok = TRUE;
+    for (gint i = 0; items[i] && ok; i++) {
+        gchar *item = g_strstrip(items[i]);
+        if (*item == '\0') continue;
+        gchar *end = NULL;
+        gint64 id = g_ascii_strtoll(item, &end, 10);
+        ok = *end == '\0' && id >= 0 && id < TRACKER_MAX_CLASSES;
+        if (ok) result |= 1ULL << id;
+    }
+    g_strfreev(items);
+    if (!ok || result == 0) return FALSE;
+    *mask = result;
+    return TRUE;
+}
+
+gboolean tracker_parse_color(const gchar *spec, NvOSD_ColorParams *color) {
+    if (*spec == '#') spec++;
+    if (strlen(spec) != 6) return FALSE;
+    gint rgb[3];
+    for (gint i = 0; i < 3; i++) {
+        gint hi = g_ascii_xdigit_value(spec[2 * i]);
+        gint lo = g_ascii_xdigit_value(spec[2 * i + 1]);
+        if (hi < 0 || lo < 0) return FALSE;
+        rgb[i] = hi * 16 + lo;
+    }
+    color->red = rgb[0] / 255.0f;
+    color->green = rgb[1] / 255.0f;
+    color->blue = rgb[2] / 255.0f;
+    color->alpha = 1.0f;
+    return TRUE;
+}
+
+// Recorre "<id>=<valor>,..." llamando a parse_value por cada par
+template <typename ParseValue>
+static gboolean parse_class_pairs(const gchar *spec, const gchar *what, gchar **error,
+                                  ParseValue parse_value) {
+    gchar **items = g_strsplit(spec, ",", -1);
+    gboolean ok = TRUE;
+    for (gint i = 0; items[i] && ok; i++) {
+        gchar **pair = g_strsplit(items[i], "=", 2);
+        gchar *end = NULL;
+        gint64 id = pair[0] ? g_ascii_strtoll(g_strstrip(pair[0]), &end, 10) : -1;
+        ok = pair[0] && pair[1] && end && *end == '\0' && id >= 0 && id < TRACKER_MAX_CLASSES &&
+             parse_value((gint)id, g_strstrip(pair[1]));
+        if (!ok) {
+            *error = g_strdup_printf("invalid %s '%s' (expected <class_id>=<value>)",
+                                     what, items[i]);
+        }
+        g_strfreev(pair);
+    }
+    g_strfreev(items);
+    return ok;
+}
+
+gboolean tracker_config_set_classes(TrackerConfig *config, const gchar *classes,
+                                    const gchar *class_times, const gchar *class_colors,
+                                    gchar **error) {
+    if (classes && !tracker_parse_classes(classes, &config->class_mask)) {
+        *error = g_strdup_printf("invalid class list '%s' (expected \"vehicles\" or ids 0-%d)",
+                                 classes, TRACKER_MAX_CLASSES - 1);
+        return FALSE;
+    }
+    if (class_times && !parse_class_pairs(class_times, "class time", error,
+                                          [config](gint id, const gchar *value) {
+            gint seconds = atoi(value);
+            config->class_time[id] = seconds;
+            return seconds > 0;
+        })) {
+        return FALSE;
+    }
+    if (class_colors && !parse_class_pairs(class_colors, "class color", error,
+                                           [config](gint id, const gchar *value) {
+            config->class_has_color[id] = tracker_parse_color(value, &config->class_color[id]);
+            return config->class_has_color[id];
+        })) {
+        return FALSE;
+    }
+    tracker_config_finalize(config);
+    return TRUE;
+}
+
+void tracker_init(TrackerContext *ctx, const TrackerConfig *initial, GTimer *app_timer) {
+    TrackerConfig *config = g_new(TrackerConfig, 1);
+    *config = *initial;
+    config->version = 0;
+    config->next_retired = NULL;
+    ctx->config = config;
+    ctx->pending.store(NULL, std::memory_order_relaxed);
+    ctx->retired.store(NULL, std::memory_order_relaxed);
     ctx->app_timer = app_timer;
+    ctx->time_offset = 0.0;
     ctx->total_detected = 0;
     ctx->total_alerts = 0;
     ctx->source_width = 0;
     ctx->source_height = 0;
+    ctx->frame_width = 0;
+    ctx->frame_height = 0;
     ctx->roi_has_objects = FALSE;
     ctx->roi_has_alerts = FALSE;
+    ctx->objects_in_roi = 0;
+    ctx->zones_with_objects = 0;
+    ctx->zones_with_alerts = 0;
     ctx->tracked_objects.clear();
+    ctx->resumed_keys.clear();
+    ctx->resume_deadline = -1.0;
+    ctx->closed_dwell.clear();
     
+    const ROIParams *roi = &config->rois[0];
     g_print("Tracker initialized with ROI: x=%.3f, y=%.3f, w=%.3f, h=%.3f\n",
-            ctx->roi.x, ctx->roi.y, ctx->roi.w, ctx->roi.h);
+            roi->x, roi->y, roi->w, roi->h);
+}
+
+void tracker_publish_config(TrackerContext *ctx, TrackerConfig *next) {
+    // Una pendiente que el probe todavía no tomó nunca fue visible: se libera aquí
+    TrackerConfig *stale = ctx->pending.exchange(next, std::memory_order_acq_rel);
+    g_free(stale);
+}
+
+gboolean tracker_swap_config(TrackerContext *ctx) {
+    TrackerConfig *next = ctx->pending.exchange(NULL, std::memory_order_acquire);
+    if (!next) return FALSE;
+    
+    TrackerConfig *old = (TrackerConfig *)ctx->config;
+    ctx->config = next;
+    
+    // El probe es el único lector: desde aquí nadie usa la anterior y el hilo
+    // de control puede liberarla
+    old->next_retired = ctx->retired.load(std::memory_order_relaxed);
+    while (!ctx->retired.compare_exchange_weak(old->next_retired, old,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+    }
+    
+    // Tracks de clases que dejaron de seguirse salen del ROI; el resto se
+    // evalúa contra los ROI nuevos al procesarse en este mismo frame
+    guint closed = 0;
+    for (auto &pair : ctx->tracked_objects) {
+        TrackInfo &info = pair.second;
+        gboolean tracked = info.class_id >= 0 && info.class_id < TRACKER_MAX_CLASSES &&
+                           (next->class_mask >> info.class_id) & 1;
+        if (!tracked && info.state != STATE_OUTSIDE) {
+            info.total_time = tracker_time_in_roi(&info);
+            g_timer_stop(info.timer);
+            info.state = STATE_OUTSIDE;
+            info.zone = -1;
+            ctx->closed_dwell.push_back(info.total_time);
+            closed++;
+        }
+    }
+    
+    ROI_LOG_INFO(LOG_CAT_APP, "Config v%u applied: %u ROI(s), time %d s, %u track(s) closed",
+                 next->version, next->num_rois, next->max_time_seconds, closed);
+    return TRUE;
+}
+
+void tracker_reclaim_configs(TrackerContext *ctx) {
+    TrackerConfig *list = ctx->retired.exchange(NULL, std::memory_order_acquire);
+    while (list) {
+        TrackerConfig *next = list->next_retired;
+        g_free(list);
+        list = next;
+    }
 }
 
 gboolean is_bbox_in_roi(NvOSD_RectParams *bbox, const ROIParams *roi, 
@@ -30,36 +223,118 @@ gboolean is_bbox_in_roi(NvOSD_RectParams *bbox, const ROIParams *roi,
             cy >= roi->y && cy <= (roi->y + roi->h));
 }
 
-void tracker_process_object(TrackerContext *ctx, NvDsObjectMeta *obj_meta,
-                           gint frame_width, gint frame_height) {
-    if (!obj_meta) return;
+// Filtros de clase resueltos en compilación: el caso de una sola clase es
+// una comparación y el de vehículos una máscara constante
+struct SingleClassFilter {
+    static inline bool accepts(const TrackerConfig *config, gint class_id) {
+        return class_id == config->single_class;
+    }
+};
+
+struct VehicleFilter {
+    static inline bool accepts(const TrackerConfig *, gint class_id) {
+        return (guint)class_id < TRACKER_MAX_CLASSES &&
+               ((TRACKER_VEHICLE_CLASSES >> class_id) & 1);
+    }
+};
+
+struct ClassSetFilter {
+    static inline bool accepts(const TrackerConfig *config, gint class_id) {
+        return (guint)class_id < TRACKER_MAX_CLASSES && ((config->class_mask >> class_id) & 1);
+    }
+};
+
+static inline void set_border(NvOSD_RectParams &rect, const NvOSD_ColorParams &color,
+                              guint width) {
+    rect.border_color = color;
+    rect.border_width = width;
+    rect.has_bg_color = 0;  // Sin fondo
+}
+
+// Busca el track restaurado más cercano de la misma clase y lo pasa a la
+// clave track_id
+static gboolean adopt_resumed(TrackerContext *ctx, guint64 track_id, gint class_id,
+                              gfloat cx, gfloat cy) {
+    gint best = -1;
+    gfloat best_d2 = TRACKER_RESUME_RADIUS * TRACKER_RESUME_RADIUS;
+    for (gsize i = 0; i < ctx->resumed_keys.size(); i++) {
+        const TrackInfo &info = ctx->tracked_objects[ctx->resumed_keys[i]];
+        gfloat dx = info.last_cx - cx, dy = info.last_cy - cy;
+        gfloat d2 = dx * dx + dy * dy;
+        if (info.class_id == class_id && d2 <= best_d2) {
+            best = (gint)i;
+            best_d2 = d2;
+        }
+    }
+    if (best < 0) return FALSE;
     
-    // FILTRO: Solo procesar vehículos (class_id 0 = Car, 2 = Bicycle, 5 = Bus, 7 = Truck)
-    // Las personas son class_id 1 (Person)
-    gboolean is_vehicle = (obj_meta->class_id == 0);  // Car
-                           //obj_meta->class_id == 2 ||  // Bicycle  
-                           //obj_meta->class_id == 5 ||  // Bus
-                           //obj_meta->class_id == 7);   // Truck
+    guint64 key = ctx->resumed_keys[best];
+    ctx->resumed_keys[best] = ctx->resumed_keys.back();
+    ctx->resumed_keys.pop_back();
+    TrackInfo info = ctx->tracked_objects[key];
+    ctx->tracked_objects.erase(key);
+    info.track_id = track_id;
+    g_timer_start(info.timer);
+    ctx->tracked_objects[track_id] = info;
+    return TRUE;
+}
+
+void tracker_expire_resumed(TrackerContext *ctx) {
+    gdouble now = tracker_now(ctx);
+    if (ctx->resume_deadline < 0.0) {
+        // La ventana empieza con el primer frame, no al arrancar el pipeline
+        ctx->resume_deadline = now + TRACKER_RESUME_WINDOW_S;
+        return;
+    }
+    if (now < ctx->resume_deadline) return;
+    
+    for (guint64 key : ctx->resumed_keys) {
+        TrackInfo &info = ctx->tracked_objects[key];
+        info.total_time = tracker_time_in_roi(&info);
+        g_timer_stop(info.timer);
+        info.state = STATE_OUTSIDE;
+        ctx->closed_dwell.push_back(info.total_time);
+    }
+    ROI_LOG_INFO(LOG_CAT_TRACKER, "Resume: %zu restored track(s) not seen again, closed",
+                 ctx->resumed_keys.size());
+    ctx->resumed_keys.clear();
+}
+
+template <typename Filter>
+static TrackEvent process_object(TrackerContext *ctx, NvDsObjectMeta *obj_meta,
+                                 gint frame_width, gint frame_height) {
+    const TrackerConfig *config = ctx->config;
     
-    if (!is_vehicle) {
+    // Clases fuera del conjunto se descartan antes de tocar la tabla de tracks
+    if (!Filter::accepts(config, obj_meta->class_id)) {
         // Si es persona u otro objeto, dibujar borde verde y salir
-        obj_meta->rect_params.border_color.red = 0.0f;
-        obj_meta->rect_params.border_color.green = 1.0f;
-        obj_meta->rect_params.border_color.blue = 0.0f;
-        obj_meta->rect_params.border_color.alpha = 1.0f;
-        obj_meta->rect_params.border_width = 2;
-        obj_meta->rect_params.has_bg_color = 0;  // Sin fondo
-        return;
+        static const NvOSD_ColorParams GREEN = { 0.0f, 1.0f, 0.0f, 1.0f };
+        set_border(obj_meta->rect_params, GREEN, 2);
+        return TRACK_EVENT_NONE;
     }
     
     guint64 track_id = obj_meta->object_id;
-    gboolean inside_roi = is_bbox_in_roi(&obj_meta->rect_params, &ctx->roi,
-                                         frame_width, frame_height);
+    gint zone = -1;
+    for (guint z = 0; z < config->num_rois && zone < 0; z++) {
+        if (is_bbox_in_roi(&obj_meta->rect_params, &config->rois[z], frame_width, frame_height)) {
+            zone = (gint)z;
+        }
+    }
+    gboolean inside_roi = zone >= 0;
+    
+    NvOSD_RectParams *bbox = &obj_meta->rect_params;
+    gfloat cx = (bbox->left + bbox->width / 2.0f) / frame_width;
+    gfloat cy = (bbox->top + bbox->height / 2.0f) / frame_height;
     
     TrackInfo *track_info;
+    TrackEvent event = TRACK_EVENT_NONE;
     auto it = ctx->tracked_objects.find(track_id);
     
-    if (it == ctx->tracked_objects.end()) {
+    if (it == ctx->tracked_objects.end() && !ctx->resumed_keys.empty() &&
+        adopt_resumed(ctx, track_id, obj_meta->class_id, cx, cy)) {
+        // Continúa la permanencia de un track restaurado; no cuenta como nuevo
+        track_info = &ctx->tracked_objects[track_id];
+    } else if (it == ctx->tracked_objects.end()) {
         TrackInfo new_track;
         new_track.track_id = track_id;
         new_track.state = STATE_OUTSIDE;
@@ -69,6 +344,13 @@ void tracker_process_object(TrackerContext *ctx, NvDsObjectMeta *obj_meta,
         new_track.class_name = g_strdup(obj_meta->obj_label);
         new_track.alert_triggered = FALSE;
         new_track.alert_start_time = 0.0;  // Inicializar nuevo campo
+        new_track.snapshot_path = NULL;
+        new_track.class_id = obj_meta->class_id;
+        new_track.zone = -1;
+        new_track.entry_zone = -1;
+        new_track.resumed_seconds = 0.0;
+        new_track.last_cx = cx;
+        new_track.last_cy = cy;
         ctx->tracked_objects[track_id] = new_track;
         track_info = &ctx->tracked_objects[track_id];
         ctx->total_detected++;
@@ -76,35 +358,44 @@ void tracker_process_object(TrackerContext *ctx, NvDsObjectMeta *obj_meta,
         track_info = &it->second;
     }
     
+    track_info->zone = zone;
+    track_info->last_cx = cx;
+    track_info->last_cy = cy;
     if (inside_roi) {
         ctx->roi_has_objects = TRUE;
+        ctx->objects_in_roi++;
+        ctx->zones_with_objects |= 1u << zone;
         
         if (track_info->state == STATE_OUTSIDE) {
             track_info->state = STATE_INSIDE;
             g_timer_start(track_info->timer);
-            track_info->entry_timestamp = g_timer_elapsed(ctx->app_timer, NULL);
+            track_info->resumed_seconds = 0.0;
+            track_info->entry_timestamp = tracker_now(ctx);
+            track_info->entry_zone = zone;
+            event = TRACK_EVENT_ENTER;
         } else if (track_info->state == STATE_INSIDE) {
-            gdouble elapsed = g_timer_elapsed(track_info->timer, NULL);
-            if (elapsed >= ctx->max_time_seconds) {
+            gdouble elapsed = tracker_time_in_roi(track_info);
+            if (elapsed >= config->dwell_seconds[obj_meta->class_id]) {
                 track_info->state = STATE_ALERT;
                 track_info->alert_triggered = TRUE;
-                track_info->alert_start_time = g_timer_elapsed(ctx->app_timer, NULL);
+                track_info->alert_start_time = tracker_now(ctx);
                 ctx->total_alerts++;
+                event = TRACK_EVENT_ALERT;
             }
         }
         
         if (track_info->state == STATE_ALERT) {
             ctx->roi_has_alerts = TRUE;
+            ctx->zones_with_alerts |= 1u << zone;
             
             // Calcular tiempo desde que se activó la alerta
-            gdouble time_since_alert = g_timer_elapsed(ctx->app_timer, NULL) - track_info->alert_start_time;
+            gdouble time_since_alert = tracker_now(ctx) - track_info->alert_start_time;
             
-            // Debug: imprimir estado
-            static gint debug_counter = 0;
-            if (debug_counter++ % 30 == 0) {  // Cada ~30 frames
-                g_print("ALERT: Vehicle ID %lu - Time in alert: %.1fs - Inside ROI: YES\n", 
-                        track_id, time_since_alert);
-            }
+            // Estado de la alerta; el límite de la categoría tracker evita
+            // imprimir en cada frame
+            ROI_LOG_INFO(LOG_CAT_TRACKER,
+                         "ALERT: Vehicle ID %" G_GUINT64_FORMAT " - Time in alert: %.1fs - Inside ROI: YES",
+                         track_id, time_since_alert);
             
             // Efecto de parpadeo: alternar entre relleno y sin relleno cada 0.3 segundos
             // Durante los primeros 3 segundos (CAMBIA 3.0 POR EL TIEMPO QUE QUIERAS)
@@ -145,18 +436,31 @@ void tracker_process_object(TrackerContext *ctx, NvDsObjectMeta *obj_meta,
     } else {
         // El vehículo SALIÓ del ROI
         if (track_info->state != STATE_OUTSIDE) {
-            track_info->total_time = g_timer_elapsed(track_info->timer, NULL);
+            track_info->total_time = tracker_time_in_roi(track_info);
             g_timer_stop(track_info->timer);
             track_info->state = STATE_OUTSIDE;
             // Aquí es donde se resetea el estado, ya no está en alerta
+            event = TRACK_EVENT_EXIT;
         }
-        // Verde para vehículo fuera del ROI (vuelve a verde después de salir)
-        obj_meta->rect_params.border_color.red = 0.0f;
-        obj_meta->rect_params.border_color.green = 1.0f;
-        obj_meta->rect_params.border_color.blue = 0.0f;
-        obj_meta->rect_params.border_color.alpha = 1.0f;
-        obj_meta->rect_params.border_width = 2;
-        obj_meta->rect_params.has_bg_color = 0;  // Sin fondo
+        // Color de la clase fuera del ROI (verde por defecto; vuelve a él al salir)
+        set_border(obj_meta->rect_params, config->outside_color[obj_meta->class_id], 2);
+    }
+    
+    return event;
+}
+
+TrackEvent tracker_process_object(TrackerContext *ctx, NvDsObjectMeta *obj_meta,
+                                  gint frame_width, gint frame_height) {
+    if (!obj_meta) return TRACK_EVENT_NONE;
+    
+    // El modo no cambia dentro de un frame: la rama es predecible
+    switch (ctx->config->class_mode) {
+        case CLASS_MODE_SINGLE:
+            return process_object<SingleClassFilter>(ctx, obj_meta, frame_width, frame_height);
+        case CLASS_MODE_VEHICLES:
+            return process_object<VehicleFilter>(ctx, obj_meta, frame_width, frame_height);
+        default:
+            return process_object<ClassSetFilter>(ctx, obj_meta, frame_width, frame_height);
     }
 }
 
@@ -164,6 +468,13 @@ void tracker_destroy(TrackerContext *ctx) {
     for (auto &pair : ctx->tracked_objects) {
         if (pair.second.timer) g_timer_destroy(pair.second.timer);
         if (pair.second.class_name) g_free(pair.second.class_name);
+        if (pair.second.snapshot_path) g_free(pair.second.snapshot_path);
     }
     ctx->tracked_objects.clear();
+    ctx->resumed_keys.clear();
+    
+    tracker_reclaim_configs(ctx);
+    g_free(ctx->pending.exchange(NULL));
+    g_free((TrackerConfig *)ctx->config);
+    ctx->config = NULL;
 }
@@ -8,7 +8,9 @@
 
 #include <gst/gst.h>
 #include <glib.h>
+#include <atomic>
 #include <unordered_map>
+#include <vector>
 #include "app_config.hpp"
 #include "gstnvdsmeta.h"
 
@@ -19,6 +21,14 @@ enum ObjectState {
     STATE_ALERT
 };
 
+// Transición de estado producida al procesar un objeto
+enum TrackEvent {
+    TRACK_EVENT_NONE,
+    TRACK_EVENT_ENTER,   // OUTSIDE -> INSIDE
+    TRACK_EVENT_ALERT,   // INSIDE -> ALERT
+    TRACK_EVENT_EXIT     // INSIDE/ALERT -> OUTSIDE
+};
+
 // Información de seguimiento por objeto
 struct TrackInfo {
     guint64 track_id;
@@ -29,31 +39,148 @@ struct TrackInfo {
     gchar *class_name;
     gboolean alert_triggered;
     gdouble alert_start_time;  // Tiempo cuando se activó la alerta
+    gchar *snapshot_path;      // Imagen capturada al entrar en alerta (o NULL)
+    gint class_id;
+    gint zone;                 // Índice del ROI que lo contiene (-1 = fuera)
+    gint entry_zone;           // ROI de la última entrada (-1 = nunca); se conserva al salir
+    gdouble resumed_seconds;   // Tiempo en el ROI antes de reanudar (checkpoint)
+    gfloat last_cx, last_cy;   // Último centro del bbox (normalizado)
+};
+
+// Tracks restaurados de un checkpoint: los IDs de nvtracker se reinician con
+// el proceso, así que un track nuevo de la misma clase cuyo centro caiga a
+// menos de TRACKER_RESUME_RADIUS adopta el estado de uno restaurado; los no
+// adoptados tras TRACKER_RESUME_WINDOW_S se dan por salidos del ROI
+#define TRACKER_RESUMED_KEY (1ULL << 63)
+#define TRACKER_RESUME_RADIUS 0.05f
+#define TRACKER_RESUME_WINDOW_S 3.0
+
+#define TRACKER_MAX_ROIS 8
+#define TRACKER_MAX_CLASSES 64
+
+// Vehículos: class_id 0 = Car, 2 = Bicycle, 5 = Bus, 7 = Truck
+#define TRACKER_VEHICLE_CLASSES ((1ULL << 0) | (1ULL << 2) | (1ULL << 5) | (1ULL << 7))
+
+// Variante del filtro de clases; las dos primeras tienen código especializado
+enum TrackerClassMode {
+    CLASS_MODE_SINGLE,      // Una sola clase (caso común: solo Car)
+    CLASS_MODE_VEHICLES,    // Exactamente TRACKER_VEHICLE_CLASSES
+    CLASS_MODE_SET          // Cualquier otro conjunto
+};
+
+// Parámetros que se pueden cambiar sin reiniciar (ver live_config.hpp). Una
+// vez publicada la configuración es inmutable: cada cambio crea una copia
+struct TrackerConfig {
+    ROIParams rois[TRACKER_MAX_ROIS];
+    guint num_rois;
+    gint max_time_seconds;         // Umbral de las clases sin uno propio
+    guint64 class_mask;            // Bit i: se sigue class_id i
+    gint class_time[TRACKER_MAX_CLASSES];    // Umbral propio en s (0 = el general)
+    gboolean class_has_color[TRACKER_MAX_CLASSES];
+    NvOSD_ColorParams class_color[TRACKER_MAX_CLASSES];  // Borde fuera del ROI
+
+    // Derivados por tracker_config_finalize
+    TrackerClassMode class_mode;
+    gint single_class;             // Con CLASS_MODE_SINGLE
+    gint dwell_seconds[TRACKER_MAX_CLASSES];
+    NvOSD_ColorParams outside_color[TRACKER_MAX_CLASSES];
+
+    guint version;
+    TrackerConfig *next_retired;   // Enlace en la lista de reemplazadas
 };
 
 // Contexto del tracker
 struct TrackerContext {
     std::unordered_map<guint64, TrackInfo> tracked_objects;
-    ROIParams roi;
-    gint max_time_seconds;
+    // Activa: la lee y la reemplaza solo el probe del OSD, entre frames
+    const TrackerConfig *config;
+    std::atomic<TrackerConfig *> pending;   // Publicada por el hilo de control
+    std::atomic<TrackerConfig *> retired;   // Reemplazadas, aún sin liberar
     GTimer *app_timer;
+    gdouble time_offset;           // Segundos de la corrida reanudada (checkpoint)
     guint total_detected;
     guint total_alerts;
-    gint source_width;
+    gint source_width;             // Resolución de la fuente (para el reporte)
     gint source_height;
+    gint frame_width;              // Resolución de proceso: la de los bbox
+    gint frame_height;
     gboolean roi_has_objects;
     gboolean roi_has_alerts;
+    guint objects_in_roi;          // Objetos dentro de algún ROI en el frame actual
+    guint32 zones_with_objects;    // Bit por ROI en el frame actual
+    guint32 zones_with_alerts;
+    std::vector<guint64> resumed_keys;   // Restaurados dentro del ROI sin adoptar
+    gdouble resume_deadline;             // < 0 hasta el primer frame
+    std::vector<gdouble> closed_dwell;   // Salidas sin TRACK_EVENT_EXIT (config, reanudación)
 };
 
-// Inicializa el contexto del tracker
-void tracker_init(TrackerContext *ctx, const ROIParams *roi, gint max_time, GTimer *app_timer);
+// Configuración inicial: un ROI, un umbral y solo Car
+void tracker_config_defaults(TrackerConfig *config, const ROIParams *roi, gint max_time);
+
+// Calcula los campos derivados; llamar después de cada cambio
+void tracker_config_finalize(TrackerConfig *config);
+
+// Clases "vehicles" o lista de class_id separada por comas o punto y coma
+gboolean tracker_parse_classes(const gchar *spec, guint64 *mask);
+
+// Color "RRGGBB" (hexadecimal, opcionalmente con #)
+gboolean tracker_parse_color(const gchar *spec, NvOSD_ColorParams *color);
+
+// Opciones de línea de comandos: clases, "<id>=<seg>,..." y "<id>=RRGGBB,..."
+// (cualquiera puede ser NULL); en error describe el problema en *error
+gboolean tracker_config_set_classes(TrackerConfig *config, const gchar *classes,
+                                    const gchar *class_times, const gchar *class_colors,
+                                    gchar **error);
+
+// Inicializa el contexto del tracker con una copia de la configuración
+void tracker_init(TrackerContext *ctx, const TrackerConfig *config, GTimer *app_timer);
+
+// Publica una configuración nueva (tomada con g_new); se aplica al inicio del
+// siguiente frame. Si otra seguía pendiente sin aplicar, se descarta
+void tracker_publish_config(TrackerContext *ctx, TrackerConfig *next);
+
+// Aplica la configuración pendiente y reevalúa los tracks existentes
+gboolean tracker_swap_config(TrackerContext *ctx);
+
+// Desde el probe del OSD antes de procesar el frame: una carga atómica si no
+// hay cambios
+static inline gboolean tracker_poll_config(TrackerContext *ctx) {
+    if (!ctx->pending.load(std::memory_order_relaxed)) return FALSE;
+    return tracker_swap_config(ctx);
+}
+
+// Cierra los tracks restaurados que ningún track nuevo adoptó a tiempo
+void tracker_expire_resumed(TrackerContext *ctx);
+
+// Desde el probe del OSD al inicio de cada frame
+static inline void tracker_poll_resumed(TrackerContext *ctx) {
+    if (!ctx->resumed_keys.empty()) tracker_expire_resumed(ctx);
+}
+
+// Libera las configuraciones reemplazadas (hilo de control o al destruir)
+void tracker_reclaim_configs(TrackerContext *ctx);
+
+// Tiempo de la aplicación, continuo entre corridas reanudadas
+static inline gdouble tracker_now(const TrackerContext *ctx) {
+    return ctx->time_offset + g_timer_elapsed(ctx->app_timer, NULL);
+}
+
+// Tiempo del track en el ROI desde su última entrada
+static inline gdouble tracker_time_in_roi(const TrackInfo *info) {
+    return info->resumed_seconds + g_timer_elapsed(info->timer, NULL);
+}
+
+// La clase está entre las seguidas
+static inline gboolean tracker_tracks_class(const TrackerConfig *config, gint class_id) {
+    return (guint)class_id < TRACKER_MAX_CLASSES && ((config->class_mask >> class_id) & 1);
+}
 
 // Verifica si un bbox está dentro del ROI
 gboolean is_bbox_in_roi(NvOSD_RectParams *bbox, const ROIParams *roi, 
                         gint frame_width, gint frame_height);
 
-// Procesa un objeto detectado
-void tracker_process_object(TrackerContext *ctx, NvDsObjectMeta *obj_meta,
+// Procesa un objeto detectado y devuelve la transición de estado
+TrackEvent tracker_process_object(TrackerContext *ctx, NvDsObjectMeta *obj_meta,
                            gint frame_width, gint frame_height);
 
 // Limpia objetos inactivos
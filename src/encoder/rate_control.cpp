@@ -0,0 +1,143 @@
+/*
+ * rate_control.cpp
+ * Implementación del control adaptativo de bitrate
+ */
+
+#include "rate_control.hpp"
+#include <gst/video/video.h>
+
+static void set_encoder_bitrate(RateController *rc, guint bitrate) {
+    rc->current_bitrate = bitrate;
+    if (!rc->encoder) return;
+    if (rc->kind == ENCODER_X264) {
+        g_object_set(G_OBJECT(rc->encoder), "bitrate", (guint)(bitrate / 1000), NULL);
+    } else {
+        g_object_set(G_OBJECT(rc->encoder), "bitrate", bitrate, NULL);
+    }
+}
+
+// Keyframe pedido con un evento upstream: no es serializado y ambos
+// encoders (GstVideoEncoder) lo atienden en el siguiente frame
+static void force_keyframe(RateController *rc) {
+    if (!rc->encoder) return;
+    GstPad *src = gst_element_get_static_pad(rc->encoder, "src");
+    if (!src) return;
+    GstEvent *event = gst_video_event_new_upstream_force_key_unit(GST_CLOCK_TIME_NONE,
+                                                                  TRUE, 0);
+    gst_pad_send_event(src, event);
+    gst_object_unref(src);
+    rc->frames_since_key = 0;
+    rc->keyframes_forced++;
+}
+
+void rate_control_init(RateController *rc, const RateControlConfig *cfg, EncoderKind kind) {
+    rc->cfg = *cfg;
+    if (rc->cfg.idle_bitrate > rc->cfg.active_bitrate) {
+        rc->cfg.idle_bitrate = rc->cfg.active_bitrate;
+    }
+    if (rc->cfg.active_gop < 1) rc->cfg.active_gop = 1;
+    if (rc->cfg.idle_gop < rc->cfg.active_gop) rc->cfg.idle_gop = rc->cfg.active_gop;
+
+    rc->encoder = NULL;
+    rc->kind = kind;
+    rc->active = TRUE;
+    rc->current_bitrate = rc->cfg.active_bitrate;
+    rc->frames_since_key = 0;
+    rc->last_detected = 0;
+    rc->last_pts = GST_CLOCK_TIME_NONE;
+    rc->last_activity_pts = GST_CLOCK_TIME_NONE;
+    rc->last_step_pts = GST_CLOCK_TIME_NONE;
+    rc->bits_used = 0.0;
+    rc->bits_baseline = 0.0;
+    rc->idle_seconds = 0.0;
+    rc->total_seconds = 0.0;
+    rc->keyframes_forced = 0;
+}
+
+void rate_control_attach(RateController *rc, GstElement *encoder) {
+    rc->encoder = encoder;
+    guint gop = rc->cfg.enabled ? rc->cfg.idle_gop : rc->cfg.active_gop;
+
+    // El GOP del encoder es el de reposo; con actividad se fuerzan keyframes
+    // cada active_gop frames (iframeinterval/key-int-max no cambian en PLAYING)
+    if (rc->kind == ENCODER_X264) {
+        g_object_set(G_OBJECT(encoder), "key-int-max", gop, NULL);
+    } else {
+        g_object_set(G_OBJECT(encoder), "iframeinterval", gop, NULL);
+    }
+    set_encoder_bitrate(rc, rc->cfg.active_bitrate);
+
+    if (rc->cfg.enabled) {
+        g_print("Adaptive bitrate: %u-%u kbit/s, GOP %u-%u, hold %.1fs\n",
+                rc->cfg.idle_bitrate / 1000, rc->cfg.active_bitrate / 1000,
+                rc->cfg.active_gop, rc->cfg.idle_gop, rc->cfg.idle_hold);
+    }
+}
+
+void rate_control_update(RateController *rc, gboolean roi_active,
+                         guint total_detected, GstClockTime pts) {
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return;
+    // idle_hold cuenta desde el inicio del stream, no desde el primer frame ocioso
+    if (!GST_CLOCK_TIME_IS_VALID(rc->last_activity_pts)) rc->last_activity_pts = pts;
+
+    // Contabilidad del ancho de banda con el bitrate vigente
+    if (GST_CLOCK_TIME_IS_VALID(rc->last_pts) && pts > rc->last_pts) {
+        gdouble dt = (gdouble)(pts - rc->last_pts) / GST_SECOND;
+        rc->bits_used += rc->current_bitrate * dt;
+        rc->bits_baseline += rc->cfg.active_bitrate * dt;
+        rc->total_seconds += dt;
+        if (!rc->active) rc->idle_seconds += dt;
+    }
+    rc->last_pts = pts;
+    rc->frames_since_key++;
+
+    if (!rc->cfg.enabled) return;
+
+    // Actividad: vehículos en el ROI o tracks nuevos en escena
+    gboolean activity = roi_active || total_detected != rc->last_detected;
+    rc->last_detected = total_detected;
+
+    if (activity) {
+        rc->last_activity_pts = pts;
+        if (!rc->active) {
+            rc->active = TRUE;
+            set_encoder_bitrate(rc, rc->cfg.active_bitrate);
+            force_keyframe(rc);
+        } else if (rc->frames_since_key >= rc->cfg.active_gop) {
+            force_keyframe(rc);
+        }
+        return;
+    }
+
+    if (rc->active) {
+        if ((gdouble)(pts - rc->last_activity_pts) / GST_SECOND < rc->cfg.idle_hold) {
+            if (rc->frames_since_key >= rc->cfg.active_gop) force_keyframe(rc);
+            return;
+        }
+        rc->active = FALSE;
+        rc->last_step_pts = pts;
+    }
+
+    // Bajada gradual: la mitad por segundo hasta el bitrate de reposo
+    if (rc->current_bitrate > rc->cfg.idle_bitrate &&
+        pts - rc->last_step_pts >= GST_SECOND) {
+        guint next = MAX(rc->current_bitrate / 2, rc->cfg.idle_bitrate);
+        set_encoder_bitrate(rc, next);
+        rc->last_step_pts = pts;
+    }
+}
+
+gdouble rate_control_saved_mb_per_hour(const RateController *rc) {
+    if (rc->total_seconds <= 0.0) return 0.0;
+    gdouble saved_mb = (rc->bits_baseline - rc->bits_used) / 8.0 / (1024.0 * 1024.0);
+    return saved_mb * 3600.0 / rc->total_seconds;
+}
+
+void rate_control_print_summary(const RateController *rc) {
+    if (!rc->cfg.enabled) return;
+    gdouble idle_pct = rc->total_seconds > 0.0 ? 100.0 * rc->idle_seconds / rc->total_seconds : 0.0;
+    g_print("Adaptive bitrate: idle %.1f%% of %.1fs, %u keyframes forced, "
+            "saved %.1f MB/h\n",
+            idle_pct, rc->total_seconds, rc->keyframes_forced,
+            rate_control_saved_mb_per_hour(rc));
+}
@@ -0,0 +1,67 @@
+/*
+ * rate_control.hpp
+ * Control adaptativo de bitrate según la actividad de la escena
+ *
+ * Mientras el ROI está vacío y no aparecen vehículos nuevos, el bitrate baja
+ * por pasos hasta el valor de reposo y el GOP se alarga. Al detectar
+ * actividad se vuelve de inmediato al bitrate activo forzando un keyframe.
+ */
+
+#ifndef RATE_CONTROL_HPP
+#define RATE_CONTROL_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+
+// Encoders soportados
+enum EncoderKind {
+    ENCODER_NVV4L2,    // nvv4l2h264enc (bitrate en bit/s)
+    ENCODER_X264       // x264enc (bitrate en kbit/s)
+};
+
+// Límites configurables
+struct RateControlConfig {
+    gboolean enabled;
+    guint active_bitrate;    // bit/s con actividad
+    guint idle_bitrate;      // bit/s en reposo
+    guint active_gop;        // Frames entre keyframes con actividad
+    guint idle_gop;          // Frames entre keyframes en reposo
+    gdouble idle_hold;       // Segundos sin actividad antes de bajar
+};
+
+// Estado del controlador (solo lo usa el hilo del OSD)
+struct RateController {
+    RateControlConfig cfg;
+    GstElement *encoder;
+    EncoderKind kind;
+    gboolean active;
+    guint current_bitrate;
+    guint frames_since_key;
+    guint last_detected;         // total_detected del frame anterior
+    GstClockTime last_pts;
+    GstClockTime last_activity_pts;
+    GstClockTime last_step_pts;
+    gdouble bits_used;           // Integral del bitrate configurado
+    gdouble bits_baseline;       // Lo que se habría usado a bitrate fijo
+    gdouble idle_seconds;
+    gdouble total_seconds;
+    guint keyframes_forced;
+};
+
+// Inicializa el controlador (el encoder se asigna al crear el pipeline)
+void rate_control_init(RateController *rc, const RateControlConfig *cfg, EncoderKind kind);
+
+// Configura las propiedades iniciales del encoder
+void rate_control_attach(RateController *rc, GstElement *encoder);
+
+// Actualiza el estado con la actividad del frame (hilo del OSD)
+void rate_control_update(RateController *rc, gboolean roi_active,
+                         guint total_detected, GstClockTime pts);
+
+// Ancho de banda ahorrado, en MB por hora de video
+gdouble rate_control_saved_mb_per_hour(const RateController *rc);
+
+// Imprime el resumen del controlador
+void rate_control_print_summary(const RateController *rc);
+
+#endif // RATE_CONTROL_HPP
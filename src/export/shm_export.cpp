@@ -0,0 +1,233 @@
+/*
+ * shm_export.cpp
+ * Implementación del escritor del anillo de memoria compartida
+ */
+
+#include "shm_export.hpp"
+#include <gst/video/video.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+#include <unistd.h>
+
+static guint64 monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000ULL + (guint64)ts.tv_nsec;
+}
+
+static void futex_wake_all(std::atomic<guint32> *word) {
+    syscall(SYS_futex, (guint32 *)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+gboolean shm_export_init(ShmExporter *exp, const gchar *name, guint slot_count) {
+    exp->name = g_strdup_printf("%s%s", name[0] == '/' ? "" : "/", name);
+    exp->slot_count = slot_count < 2 ? 2 : slot_count;
+    exp->fd = -1;
+    exp->header = NULL;
+    exp->map_size = 0;
+    exp->frame_capacity = 0;
+    exp->staging_count = 0;
+    exp->frames_published = 0;
+    exp->frames_without_meta = 0;
+    for (guint i = 0; i < SHM_STAGING_SIZE; i++) {
+        exp->staging[i].seq.store(0, std::memory_order_relaxed);
+        exp->staging[i].pts = GST_CLOCK_TIME_NONE;
+    }
+
+    // El segmento se abre aquí para fallar al arrancar (nombre inválido,
+    // permisos de /dev/shm); el tamaño se fija con el primer frame.
+    // Un escritor anterior pudo terminar sin limpiar
+    shm_unlink(exp->name);
+    exp->fd = shm_open(exp->name, O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (exp->fd < 0) {
+        g_printerr("shm export: no se pudo crear %s\n", exp->name);
+        return FALSE;
+    }
+
+    g_print("Shared memory export: %s (%u slots)\n", exp->name, exp->slot_count);
+    return TRUE;
+}
+
+// Crea el segmento con el tamaño del primer frame negociado
+static gboolean shm_export_create_ring(ShmExporter *exp, gint width, gint height) {
+    gsize stride = (gsize)width * 4;
+    exp->frame_capacity = stride * (gsize)height;
+    gsize slot_stride = shm_ring_slot_stride(exp->frame_capacity);
+    exp->map_size = shm_ring_total_size(exp->slot_count, slot_stride);
+
+    if (ftruncate(exp->fd, (off_t)exp->map_size) != 0) {
+        g_printerr("shm export: ftruncate fallo (%" G_GSIZE_FORMAT " bytes)\n", exp->map_size);
+        close(exp->fd);
+        exp->fd = -1;
+        shm_unlink(exp->name);
+        return FALSE;
+    }
+
+    void *addr = mmap(NULL, exp->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, exp->fd, 0);
+    if (addr == MAP_FAILED) {
+        g_printerr("shm export: mmap fallo\n");
+        close(exp->fd);
+        exp->fd = -1;
+        shm_unlink(exp->name);
+        return FALSE;
+    }
+
+    // ftruncate deja el segmento en cero: slots con seq 0 = vacíos
+    ShmRingHeader *hdr = (ShmRingHeader *)addr;
+    hdr->version = SHM_RING_VERSION;
+    hdr->slot_count = exp->slot_count;
+    hdr->slot_stride = (guint32)slot_stride;
+    hdr->width = (guint32)width;
+    hdr->height = (guint32)height;
+    hdr->stride = (guint32)stride;
+    hdr->format = SHM_FORMAT_RGBA;
+    hdr->writer_pid = (guint32)getpid();
+    hdr->write_seq.store(0, std::memory_order_relaxed);
+    hdr->futex_word.store(0, std::memory_order_relaxed);
+    hdr->waiters.store(0, std::memory_order_relaxed);
+    hdr->closed.store(0, std::memory_order_relaxed);
+    // El magic se publica al final: los lectores lo usan para saber que está listo
+    std::atomic_thread_fence(std::memory_order_release);
+    hdr->magic = SHM_RING_MAGIC;
+
+    exp->header = hdr;
+    g_print("Shared memory ring %s: %dx%d RGBA, %u slots, %.1f MB\n",
+            exp->name, width, height, exp->slot_count, exp->map_size / (1024.0 * 1024.0));
+    return TRUE;
+}
+
+void shm_export_stage_frame(ShmExporter *exp, const TrackerContext *tracker,
+                            NvDsFrameMeta *fmeta, guint64 pts) {
+    guint64 n = exp->staging_count++;
+    ShmStagedMeta *rec = &exp->staging[n & (SHM_STAGING_SIZE - 1)];
+
+    rec->seq.store((n << 1) | 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    rec->pts = pts;
+    rec->flags = SHM_FRAME_HAS_META;
+    if (tracker->roi_has_objects) rec->flags |= SHM_FRAME_ROI_OBJECTS;
+    if (tracker->roi_has_alerts) rec->flags |= SHM_FRAME_ROI_ALERTS;
+
+    guint32 count = 0;
+    for (NvDsMetaList *l_obj = fmeta->obj_meta_list;
+         l_obj && count < SHM_RING_MAX_OBJECTS; l_obj = l_obj->next) {
+        NvDsObjectMeta *obj_meta = (NvDsObjectMeta *)l_obj->data;
+        if (!obj_meta) continue;
+
+        ShmObjectRecord &o = rec->objects[count++];
+        o.track_id = obj_meta->object_id;
+        o.class_id = obj_meta->class_id;
+        auto it = tracker->tracked_objects.find(obj_meta->object_id);
+        o.state = (it != tracker->tracked_objects.end()) ? (guint32)it->second.state
+                                                          : (guint32)STATE_OUTSIDE;
+        o.left = obj_meta->rect_params.left;
+        o.top = obj_meta->rect_params.top;
+        o.width = obj_meta->rect_params.width;
+        o.height = obj_meta->rect_params.height;
+    }
+    rec->num_objects = count;
+
+    rec->seq.store((n + 1) << 1, std::memory_order_release);
+}
+
+// Busca los metadatos del PTS dado; FALSE si ya se sobrescribieron o no llegaron
+static gboolean shm_export_find_meta(ShmExporter *exp, guint64 pts, ShmSlotHeader *slot) {
+    for (guint i = 0; i < SHM_STAGING_SIZE; i++) {
+        ShmStagedMeta *rec = &exp->staging[i];
+        guint64 s1 = rec->seq.load(std::memory_order_acquire);
+        if ((s1 & 1) || s1 == 0 || rec->pts != pts) continue;
+
+        guint32 count = MIN(rec->num_objects, (guint32)SHM_RING_MAX_OBJECTS);
+        slot->flags = rec->flags;
+        slot->num_objects = count;
+        memcpy(slot->objects, rec->objects, count * sizeof(ShmObjectRecord));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (rec->seq.load(std::memory_order_relaxed) == s1) return TRUE;
+    }
+    slot->flags = 0;
+    slot->num_objects = 0;
+    return FALSE;
+}
+
+GstPadProbeReturn shm_export_sink_probe(GstPad *pad, GstPadProbeInfo *info,
+                                        gpointer u_data) {
+    ShmExporter *exp = (ShmExporter *)u_data;
+    GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!exp || !buf) return GST_PAD_PROBE_OK;
+
+    // Resolución de los caps negociados en la rama; el stride del buffer
+    // (GstVideoMeta o caps) puede tener relleno por fila
+    GstVideoInfo vinfo;
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    if (!caps) return GST_PAD_PROBE_OK;
+    gboolean have_info = gst_video_info_from_caps(&vinfo, caps);
+    gst_caps_unref(caps);
+    if (!have_info) return GST_PAD_PROBE_OK;
+    if (!exp->header &&
+        !shm_export_create_ring(exp, GST_VIDEO_INFO_WIDTH(&vinfo), GST_VIDEO_INFO_HEIGHT(&vinfo))) {
+        return GST_PAD_PROBE_REMOVE;
+    }
+
+    GstVideoFrame frame;
+    if (!gst_video_frame_map(&frame, &vinfo, buf, GST_MAP_READ)) return GST_PAD_PROBE_OK;
+
+    ShmRingHeader *hdr = exp->header;
+    guint64 s = hdr->write_seq.load(std::memory_order_relaxed);
+    ShmSlotHeader *slot = shm_ring_slot(hdr, s);
+
+    slot->seq.store(((s + 1) << 1) | 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    guint64 pts = GST_BUFFER_PTS(buf);
+    slot->pts = pts;
+    // Segunda copia del frame (la primera es la de nvvideoconvert a memoria
+    // del sistema): filas contiguas en el anillo
+    const guint8 *src = (const guint8 *)GST_VIDEO_FRAME_PLANE_DATA(&frame, 0);
+    gsize src_stride = (gsize)GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 0);
+    guint rows = MIN((guint)GST_VIDEO_FRAME_HEIGHT(&frame), hdr->height);
+    gsize row_bytes = MIN((gsize)GST_VIDEO_FRAME_WIDTH(&frame) * 4, (gsize)hdr->stride);
+    guint8 *dst = shm_ring_slot_pixels(slot);
+    for (guint y = 0; y < rows; y++) {
+        memcpy(dst + (gsize)y * hdr->stride, src + (gsize)y * src_stride, row_bytes);
+    }
+    slot->frame_size = (guint32)((gsize)rows * hdr->stride);
+    if (!shm_export_find_meta(exp, pts, slot)) exp->frames_without_meta++;
+    slot->publish_ns = monotonic_ns();
+
+    slot->seq.store((s + 1) << 1, std::memory_order_release);
+    hdr->write_seq.store(s + 1, std::memory_order_release);
+    hdr->futex_word.fetch_add(1, std::memory_order_release);
+    if (hdr->waiters.load(std::memory_order_acquire) > 0) {
+        futex_wake_all(&hdr->futex_word);
+    }
+
+    gst_video_frame_unmap(&frame);
+    exp->frames_published++;
+    return GST_PAD_PROBE_OK;
+}
+
+void shm_export_destroy(ShmExporter *exp) {
+    if (exp->header) {
+        exp->header->closed.store(1, std::memory_order_release);
+        exp->header->futex_word.fetch_add(1, std::memory_order_release);
+        futex_wake_all(&exp->header->futex_word);
+        g_print("Shared memory export: %" G_GUINT64_FORMAT " frames (%" G_GUINT64_FORMAT
+                " sin metadatos)\n", exp->frames_published, exp->frames_without_meta);
+        munmap(exp->header, exp->map_size);
+        exp->header = NULL;
+    }
+    if (exp->fd >= 0) {
+        close(exp->fd);
+        exp->fd = -1;
+        shm_unlink(exp->name);
+    }
+    g_free(exp->name);
+    exp->name = NULL;
+}
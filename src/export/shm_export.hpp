@@ -0,0 +1,57 @@
+/*
+ * shm_export.hpp
+ * Exportación de frames y metadatos a memoria compartida (escritor)
+ */
+
+#ifndef SHM_EXPORT_HPP
+#define SHM_EXPORT_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include <atomic>
+#include "shm_ring.hpp"
+#include "config/track_info.hpp"
+#include "gstnvdsmeta.h"
+
+// Registros de metadatos pendientes (potencia de 2)
+#define SHM_STAGING_SIZE 16
+
+// Metadatos de un frame preparados por el probe del OSD
+struct ShmStagedMeta {
+    std::atomic<guint64> seq;   // Seqlock: impar mientras se escribe
+    guint64 pts;
+    guint32 flags;
+    guint32 num_objects;
+    ShmObjectRecord objects[SHM_RING_MAX_OBJECTS];
+};
+
+// Contexto del exportador
+struct ShmExporter {
+    gchar *name;                // Nombre del segmento (shm_open)
+    guint slot_count;
+    gint fd;
+    ShmRingHeader *header;      // NULL hasta recibir el primer frame
+    gsize map_size;
+    gsize frame_capacity;       // Bytes de pixeles por slot
+    ShmStagedMeta staging[SHM_STAGING_SIZE];
+    guint64 staging_count;      // Solo lo modifica el hilo del OSD
+    guint64 frames_published;
+    guint64 frames_without_meta;
+};
+
+// Inicializa el exportador y abre el segmento (su tamaño se fija con el
+// primer frame); FALSE si no se pudo crear
+gboolean shm_export_init(ShmExporter *exp, const gchar *name, guint slot_count);
+
+// Guarda los metadatos del frame procesado por el tracker (hilo del OSD)
+void shm_export_stage_frame(ShmExporter *exp, const TrackerContext *tracker,
+                            NvDsFrameMeta *fmeta, guint64 pts);
+
+// Probe del fakesink de la rama de exportación: copia el frame al anillo
+GstPadProbeReturn shm_export_sink_probe(GstPad *pad, GstPadProbeInfo *info,
+                                        gpointer u_data);
+
+// Cierra y elimina el segmento
+void shm_export_destroy(ShmExporter *exp);
+
+#endif // SHM_EXPORT_HPP
@@ -0,0 +1,147 @@
+/*
+ * shm_reader.cpp
+ * Implementación del lector del anillo de memoria compartida
+ */
+
+#include "shm_reader.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+
+static int futex_wait(std::atomic<uint32_t> *word, uint32_t expected, int timeout_ms) {
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+    return (int)syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT, expected,
+                        timeout_ms >= 0 ? &ts : NULL, NULL, 0);
+}
+
+bool shm_reader_open(ShmReader *reader, const char *name) {
+    reader->fd = -1;
+    reader->header = NULL;
+    reader->map_size = 0;
+    reader->next_seq = 0;
+    reader->frames_read = 0;
+    reader->frames_lost = 0;
+
+    std::string path = (name[0] == '/') ? name : std::string("/") + name;
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmRingHeader)) {
+        close(fd);
+        return false;
+    }
+
+    void *addr = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    ShmRingHeader *hdr = (ShmRingHeader *)addr;
+    bool valid = hdr->magic == SHM_RING_MAGIC;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    valid = valid && hdr->version == SHM_RING_VERSION && hdr->slot_count > 0 &&
+            shm_ring_total_size(hdr->slot_count, hdr->slot_stride) <= (size_t)st.st_size;
+    if (!valid) {
+        munmap(addr, (size_t)st.st_size);
+        close(fd);
+        return false;
+    }
+
+    reader->fd = fd;
+    reader->header = hdr;
+    reader->map_size = (size_t)st.st_size;
+    // Un lector nuevo empieza en el frame más reciente
+    shm_reader_skip_to_latest(reader);
+    return true;
+}
+
+void shm_reader_skip_to_latest(ShmReader *reader) {
+    uint64_t w = reader->header->write_seq.load(std::memory_order_acquire);
+    reader->next_seq = (w > 0) ? w - 1 : 0;
+}
+
+int shm_reader_next(ShmReader *reader, ShmFrameView *view, int timeout_ms) {
+    ShmRingHeader *hdr = reader->header;
+    if (!hdr) return -1;
+
+    for (;;) {
+        uint32_t word = hdr->futex_word.load(std::memory_order_acquire);
+        uint64_t w = hdr->write_seq.load(std::memory_order_acquire);
+
+        if (reader->next_seq >= w) {
+            if (hdr->closed.load(std::memory_order_acquire)) return -1;
+            if (timeout_ms == 0) return 0;
+            hdr->waiters.fetch_add(1, std::memory_order_acq_rel);
+            int rc = futex_wait(&hdr->futex_word, word, timeout_ms);
+            int err = errno;
+            hdr->waiters.fetch_sub(1, std::memory_order_acq_rel);
+            if (rc != 0 && err == ETIMEDOUT) return 0;
+            continue;
+        }
+
+        // El slot de w será el próximo en sobrescribirse: quedarse a distancia
+        uint64_t oldest = (w >= hdr->slot_count) ? w - hdr->slot_count + 1 : 0;
+        if (reader->next_seq < oldest) {
+            reader->frames_lost += oldest - reader->next_seq;
+            reader->next_seq = oldest;
+        }
+
+        uint64_t seq = reader->next_seq;
+        ShmSlotHeader *slot = shm_ring_slot(hdr, seq);
+        uint64_t expected = (seq + 1) << 1;
+        uint64_t s1 = slot->seq.load(std::memory_order_acquire);
+        if (s1 != expected) {
+            // Sobrescrito entre la lectura de write_seq y la del slot
+            reader->frames_lost++;
+            reader->next_seq++;
+            continue;
+        }
+
+        view->seq = seq;
+        view->pts = slot->pts;
+        view->publish_ns = slot->publish_ns;
+        view->width = hdr->width;
+        view->height = hdr->height;
+        view->stride = hdr->stride;
+        view->format = hdr->format;
+        view->flags = slot->flags;
+        view->num_objects = slot->num_objects < SHM_RING_MAX_OBJECTS ? slot->num_objects
+                                                                     : SHM_RING_MAX_OBJECTS;
+        view->frame_size = slot->frame_size;
+        view->objects = slot->objects;
+        view->pixels = shm_ring_slot_pixels(slot);
+
+        reader->next_seq++;
+        reader->frames_read++;
+        return 1;
+    }
+}
+
+bool shm_reader_release(const ShmReader *reader, const ShmFrameView *view) {
+    if (!reader->header) return false;
+    ShmSlotHeader *slot = shm_ring_slot(reader->header, view->seq);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->seq.load(std::memory_order_relaxed) == ((view->seq + 1) << 1);
+}
+
+void shm_reader_close(ShmReader *reader) {
+    if (reader->header) {
+        munmap(reader->header, reader->map_size);
+        reader->header = NULL;
+    }
+    if (reader->fd >= 0) {
+        close(reader->fd);
+        reader->fd = -1;
+    }
+}
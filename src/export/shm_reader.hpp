@@ -0,0 +1,57 @@
+/*
+ * shm_reader.hpp
+ * Librería de lectura del anillo de memoria compartida
+ *
+ * No depende de GLib/GStreamer. Los lectores pueden conectarse o
+ * desconectarse en cualquier momento; el escritor nunca espera por ellos.
+ */
+
+#ifndef SHM_READER_HPP
+#define SHM_READER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "shm_ring.hpp"
+
+// Vista de un frame dentro del anillo (sin copias)
+struct ShmFrameView {
+    uint64_t seq;
+    uint64_t pts;
+    uint64_t publish_ns;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t format;
+    uint32_t flags;
+    uint32_t num_objects;
+    uint32_t frame_size;
+    const ShmObjectRecord *objects;
+    const uint8_t *pixels;
+};
+
+// Estado de un lector
+struct ShmReader {
+    int fd;
+    ShmRingHeader *header;
+    size_t map_size;
+    uint64_t next_seq;
+    uint64_t frames_read;
+    uint64_t frames_lost;     // Sobrescritos antes de leerlos
+};
+
+// Se conecta al segmento; devuelve false si el escritor aún no lo creó
+bool shm_reader_open(ShmReader *reader, const char *name);
+
+// Obtiene el siguiente frame: 1 = frame, 0 = timeout, -1 = escritor cerrado
+int shm_reader_next(ShmReader *reader, ShmFrameView *view, int timeout_ms);
+
+// Verifica que el frame no se sobrescribió mientras se usaba
+bool shm_reader_release(const ShmReader *reader, const ShmFrameView *view);
+
+// Salta al frame más reciente (descarta el atraso acumulado)
+void shm_reader_skip_to_latest(ShmReader *reader);
+
+// Se desconecta del segmento
+void shm_reader_close(ShmReader *reader);
+
+#endif // SHM_READER_HPP
@@ -0,0 +1,101 @@
+/*
+ * shm_ring.hpp
+ * Formato del anillo de memoria compartida para exportar frames y metadatos
+ *
+ * Este header es compartido por el escritor (roi_surveillance) y por la
+ * librería de lectura. No depende de GLib/GStreamer para que los consumidores
+ * puedan compilarlo sin DeepStream.
+ *
+ * Protocolo: un escritor, N lectores. Cada slot usa un seqlock: el escritor
+ * marca el slot como ocupado (bit 0 en 1), copia el frame y lo publica con el
+ * número de secuencia par. Un lector valida que la secuencia no cambió
+ * después de usar los datos; si cambió, el frame fue sobrescrito.
+ */
+
+#ifndef SHM_RING_HPP
+#define SHM_RING_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define SHM_RING_MAGIC        0x4952534dU   // "MSRI"
+#define SHM_RING_VERSION      1U
+#define SHM_RING_MAX_OBJECTS  64
+#define SHM_RING_ALIGN        64
+
+// Formatos de pixel soportados
+enum ShmPixelFormat : uint32_t {
+    SHM_FORMAT_RGBA = 1
+};
+
+// Flags por frame
+enum ShmFrameFlags : uint32_t {
+    SHM_FRAME_HAS_META    = 1u << 0,  // Hay registro de tracking para este PTS
+    SHM_FRAME_ROI_OBJECTS = 1u << 1,  // Hay vehículos dentro del ROI
+    SHM_FRAME_ROI_ALERTS  = 1u << 2   // Hay vehículos en alerta
+};
+
+// Registro compacto por objeto
+struct ShmObjectRecord {
+    uint64_t track_id;
+    int32_t  class_id;
+    uint32_t state;          // ObjectState (0 = fuera, 1 = dentro, 2 = alerta)
+    float    left, top, width, height;
+};
+
+// Encabezado de cada slot; los pixeles siguen en el mismo slot
+struct alignas(SHM_RING_ALIGN) ShmSlotHeader {
+    std::atomic<uint64_t> seq;       // (frame_seq << 1) | ocupado
+    uint64_t pts;                    // PTS del buffer (ns)
+    uint64_t publish_ns;             // CLOCK_MONOTONIC al publicar
+    uint32_t frame_size;             // Bytes válidos de pixeles
+    uint32_t flags;                  // ShmFrameFlags
+    uint32_t num_objects;
+    uint32_t reserved;
+    ShmObjectRecord objects[SHM_RING_MAX_OBJECTS];
+};
+
+// Encabezado global del segmento
+struct alignas(SHM_RING_ALIGN) ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_stride;            // Bytes entre slots (encabezado + pixeles)
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;                 // Bytes por fila
+    uint32_t format;                 // ShmPixelFormat
+    uint32_t writer_pid;
+    uint32_t reserved;
+    std::atomic<uint64_t> write_seq; // Próxima secuencia a publicar
+    std::atomic<uint32_t> futex_word;// Se incrementa en cada publicación
+    std::atomic<uint32_t> waiters;   // Lectores bloqueados en futex_word
+    std::atomic<uint32_t> closed;    // El escritor terminó
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "El anillo requiere atomicos de 64 bits sin locks");
+
+static inline size_t shm_ring_align(size_t n) {
+    return (n + SHM_RING_ALIGN - 1) & ~(size_t)(SHM_RING_ALIGN - 1);
+}
+
+static inline size_t shm_ring_slot_stride(size_t frame_bytes) {
+    return shm_ring_align(sizeof(ShmSlotHeader) + frame_bytes);
+}
+
+static inline size_t shm_ring_total_size(uint32_t slot_count, size_t slot_stride) {
+    return shm_ring_align(sizeof(ShmRingHeader)) + (size_t)slot_count * slot_stride;
+}
+
+static inline ShmSlotHeader *shm_ring_slot(ShmRingHeader *hdr, uint64_t seq) {
+    uint8_t *base = (uint8_t *)hdr + shm_ring_align(sizeof(ShmRingHeader));
+    return (ShmSlotHeader *)(base + (size_t)(seq % hdr->slot_count) * hdr->slot_stride);
+}
+
+static inline uint8_t *shm_ring_slot_pixels(ShmSlotHeader *slot) {
+    return (uint8_t *)slot + sizeof(ShmSlotHeader);
+}
+
+#endif // SHM_RING_HPP
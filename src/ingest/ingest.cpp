@@ -0,0 +1,331 @@
+/*
+ * ingest.cpp
+ * Implementación de la etapa de entrada genérica
+ */
+
+#include "ingest.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+gboolean ingest_parse_input(IngestStage *stage, const gchar *input) {
+    stage->location = NULL;
+    stage->port = 0;
+    stage->rtp_codec = NULL;
+    stage->decoder_mode = DECODER_AUTO;
+    stage->jitter_ms = 200;
+    stage->rtsp_tcp = FALSE;
+    stage->pace = FALSE;
+    stage->decode_queue = NULL;
+    stage->pipeline = NULL;
+    stage->mux_sink = NULL;
+    stage->linked = FALSE;
+    stage->on_decoder = NULL;
+    stage->user_data = NULL;
+
+    if (g_str_has_prefix(input, "rtsp://") || g_str_has_prefix(input, "rtsps://")) {
+        stage->kind = INGEST_RTSP;
+        stage->location = g_strdup(input);
+        return TRUE;
+    }
+
+    if (g_str_has_prefix(input, "rtp://") || g_str_has_prefix(input, "udp://")) {
+        // rtp://host:puerto[?codec=h264|h265]; host vacío = todas las interfaces
+        stage->kind = INGEST_RTP;
+        const gchar *addr = strstr(input, "://") + 3;
+        const gchar *query = strchr(addr, '?');
+        gchar *hostport = query ? g_strndup(addr, query - addr) : g_strdup(addr);
+        gchar *colon = strrchr(hostport, ':');
+        if (!colon || atoi(colon + 1) <= 0 || atoi(colon + 1) > 65535) {
+            g_free(hostport);
+            return FALSE;
+        }
+        stage->port = atoi(colon + 1);
+        *colon = '\0';
+        stage->location = g_strdup(*hostport ? hostport : "0.0.0.0");
+        g_free(hostport);
+
+        stage->rtp_codec = g_strdup("H264");
+        if (query && strstr(query, "codec=")) {
+            const gchar *codec = strstr(query, "codec=") + 6;
+            if (g_ascii_strncasecmp(codec, "h265", 4) == 0) {
+                g_free(stage->rtp_codec);
+                stage->rtp_codec = g_strdup("H265");
+            } else if (g_ascii_strncasecmp(codec, "h264", 4) != 0) {
+                ingest_clear(stage);
+                return FALSE;
+            }
+        }
+        return TRUE;
+    }
+
+    stage->kind = INGEST_FILE;
+    if (g_str_has_prefix(input, "file://")) {
+        stage->location = g_filename_from_uri(input, NULL, NULL);
+        return stage->location != NULL;
+    }
+    stage->location = g_strdup(input);
+    return TRUE;
+}
+
+gboolean ingest_is_live(const IngestStage *stage) {
+    return stage->kind != INGEST_FILE;
+}
+
+// Crea un elemento con nombre, registrando el error si la fábrica no existe
+static GstElement *make_element(const gchar *factory, const gchar *name) {
+    GstElement *elem = gst_element_factory_make(factory, name);
+    if (!elem) g_printerr("Ingest: element '%s' not available\n", factory);
+    return elem;
+}
+
+static gboolean hw_decoder_available(void) {
+    GstElementFactory *factory = gst_element_factory_find("nvv4l2decoder");
+    if (!factory) return FALSE;
+    gst_object_unref(factory);
+    return TRUE;
+}
+
+// Error en el bus: el pipeline termina igual que con cualquier otro error
+static void post_error(IngestStage *stage, const gchar *message) {
+    GError *error = g_error_new_literal(GST_STREAM_ERROR,
+                                        GST_STREAM_ERROR_CODEC_NOT_FOUND, message);
+    gst_element_post_message(stage->pipeline,
+                             gst_message_new_error(GST_OBJECT(stage->pipeline), error, NULL));
+    g_error_free(error);
+}
+
+// Las pads que no se usan (audio, segundo video) van a un fakesink para que
+// el demuxer no se detenga con not-linked
+static void discard_pad(IngestStage *stage, GstPad *pad) {
+    GstElement *sink = gst_element_factory_make("fakesink", NULL);
+    if (!sink) return;
+    g_object_set(G_OBJECT(sink), "sync", FALSE, "async", FALSE, NULL);
+    gst_bin_add(GST_BIN(stage->pipeline), sink);
+    gst_element_sync_state_with_parent(sink);
+    GstPad *sinkpad = gst_element_get_static_pad(sink, "sink");
+    gst_pad_link(pad, sinkpad);
+    gst_object_unref(sinkpad);
+}
+
+/*
+ * Conecta [depay] -> parser -> [pacer] -> decoder -> [cola] -> [conversión
+ * a NVMM] -> streammux a partir de la pad que entrega el stream.
+ * codec: "H264" o "H265"; rtp indica si el stream aún viene en paquetes RTP.
+ */
+static gboolean link_video_stream(IngestStage *stage, GstPad *pad,
+                                  const gchar *codec, gboolean rtp) {
+    gboolean h265 = g_strcmp0(codec, "H265") == 0;
+    gboolean use_hw = stage->decoder_mode == DECODER_HW ||
+                      (stage->decoder_mode == DECODER_AUTO && hw_decoder_available());
+
+    GstElement *chain[7];
+    guint n = 0;
+    if (rtp) {
+        chain[n] = make_element(h265 ? "rtph265depay" : "rtph264depay", "ingest-depay");
+        if (!chain[n++]) return FALSE;
+    }
+    chain[n] = make_element(h265 ? "h265parse" : "h264parse", "ingest-parser");
+    if (!chain[n++]) return FALSE;
+    if (stage->pace) {
+        chain[n] = make_element("identity", "live-pacer");
+        if (!chain[n]) return FALSE;
+        g_object_set(G_OBJECT(chain[n++]), "sync", TRUE, NULL);
+    }
+
+    const gchar *decoder_factory = use_hw ? "nvv4l2decoder"
+                                          : (h265 ? "avdec_h265" : "avdec_h264");
+    GstElement *decoder = make_element(decoder_factory, "decoder");
+    if (!decoder) return FALSE;
+    chain[n++] = decoder;
+
+    if (stage->decode_queue) chain[n++] = stage->decode_queue;
+    if (!use_hw) {
+        // El decoder por software entrega memoria de sistema; el muxer espera NVMM
+        GstElement *conv = make_element("nvvideoconvert", "ingest-conv");
+        GstElement *caps_elem = make_element("capsfilter", "ingest-caps");
+        if (!conv || !caps_elem) return FALSE;
+        GstCaps *caps = gst_caps_from_string("video/x-raw(memory:NVMM), format=NV12");
+        g_object_set(G_OBJECT(caps_elem), "caps", caps, NULL);
+        gst_caps_unref(caps);
+        chain[n++] = conv;
+        chain[n++] = caps_elem;
+    }
+
+    for (guint i = 0; i < n; i++) {
+        // El queue de decode ya está en el bin desde ingest_build
+        if (chain[i] != stage->decode_queue) gst_bin_add(GST_BIN(stage->pipeline), chain[i]);
+        if (i > 0 && !gst_element_link(chain[i - 1], chain[i])) {
+            g_printerr("Ingest: failed to link %s -> %s\n",
+                       GST_ELEMENT_NAME(chain[i - 1]), GST_ELEMENT_NAME(chain[i]));
+            return FALSE;
+        }
+    }
+
+    GstPad *tail = gst_element_get_static_pad(chain[n - 1], "src");
+    GstPadLinkReturn ret = gst_pad_link(tail, stage->mux_sink);
+    gst_object_unref(tail);
+    if (ret != GST_PAD_LINK_OK) {
+        g_printerr("Ingest: failed to link decoder -> streammux\n");
+        return FALSE;
+    }
+
+    if (stage->on_decoder) stage->on_decoder(decoder, stage->user_data);
+
+    // Estados primero y la pad de entrada al final: ningún buffer llega a un
+    // elemento que todavía está en NULL
+    for (guint i = n; i > 0; i--) gst_element_sync_state_with_parent(chain[i - 1]);
+
+    GstPad *head = gst_element_get_static_pad(chain[0], "sink");
+    ret = gst_pad_link(pad, head);
+    gst_object_unref(head);
+    if (ret != GST_PAD_LINK_OK) {
+        g_printerr("Ingest: failed to link source pad -> %s\n", GST_ELEMENT_NAME(chain[0]));
+        return FALSE;
+    }
+
+    stage->linked = TRUE;
+    g_print("Linked: %s%s -> %s -> streammux\n", rtp ? "RTP " : "",
+            h265 ? "H.265" : "H.264", decoder_factory);
+    return TRUE;
+}
+
+// Codec de unos caps: "H264", "H265" o NULL si no es video soportado
+static const gchar *codec_from_caps(GstCaps *caps, gboolean *rtp, gboolean *is_video) {
+    const GstStructure *str = gst_caps_get_structure(caps, 0);
+    const gchar *name = gst_structure_get_name(str);
+    *rtp = FALSE;
+    *is_video = g_str_has_prefix(name, "video/");
+
+    if (g_strcmp0(name, "application/x-rtp") == 0) {
+        *rtp = TRUE;
+        *is_video = g_strcmp0(gst_structure_get_string(str, "media"), "video") == 0;
+        const gchar *encoding = gst_structure_get_string(str, "encoding-name");
+        if (g_strcmp0(encoding, "H264") == 0) return "H264";
+        if (g_strcmp0(encoding, "H265") == 0) return "H265";
+        return NULL;
+    }
+    if (g_strcmp0(name, "video/x-h264") == 0) return "H264";
+    if (g_strcmp0(name, "video/x-h265") == 0) return "H265";
+    return NULL;
+}
+
+// pad-added de parsebin (archivos) y rtspsrc
+static void on_source_pad_added(GstElement *element, GstPad *pad, gpointer data) {
+    IngestStage *stage = (IngestStage *)data;
+
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    if (!caps) caps = gst_pad_query_caps(pad, NULL);
+    if (!caps || gst_caps_is_empty(caps)) {
+        if (caps) gst_caps_unref(caps);
+        discard_pad(stage, pad);
+        return;
+    }
+
+    gboolean rtp, is_video;
+    const gchar *codec = codec_from_caps(caps, &rtp, &is_video);
+    gchar *caps_str = gst_caps_to_string(caps);
+    gst_caps_unref(caps);
+
+    if (!stage->linked && codec) {
+        g_print("Ingest: %s stream from %s\n", codec, GST_ELEMENT_NAME(element));
+        if (!link_video_stream(stage, pad, codec, rtp)) {
+            post_error(stage, "Could not build the decode chain for the input stream");
+        }
+    } else {
+        if (is_video && !stage->linked) {
+            g_printerr("Ingest: unsupported video stream (%s)\n", caps_str);
+        }
+        discard_pad(stage, pad);
+    }
+    g_free(caps_str);
+}
+
+// Sin más pads y sin video conectado: el archivo no tiene H.264/H.265
+static void on_no_more_pads(GstElement *element, gpointer data) {
+    IngestStage *stage = (IngestStage *)data;
+    if (!stage->linked) {
+        post_error(stage, "Input has no H.264/H.265 video stream");
+    }
+}
+
+gboolean ingest_build(IngestStage *stage, GstElement *pipeline, GstPad *mux_sink) {
+    stage->pipeline = pipeline;
+    stage->mux_sink = mux_sink;
+    stage->linked = FALSE;
+    // Al bin desde el inicio: si la fuente nunca expone video, el pipeline
+    // lo libera igual que al resto
+    if (stage->decode_queue) gst_bin_add(GST_BIN(pipeline), stage->decode_queue);
+
+    if (stage->kind == INGEST_FILE) {
+        GstElement *source = make_element("filesrc", "file-source");
+        GstElement *parse = make_element("parsebin", "ingest-parsebin");
+        if (!source || !parse) return FALSE;
+        g_object_set(G_OBJECT(source), "location", stage->location, NULL);
+        gst_bin_add_many(GST_BIN(pipeline), source, parse, NULL);
+        if (!gst_element_link(source, parse)) {
+            g_printerr("Failed to link source -> parsebin\n");
+            return FALSE;
+        }
+        g_signal_connect(parse, "pad-added", G_CALLBACK(on_source_pad_added), stage);
+        g_signal_connect(parse, "no-more-pads", G_CALLBACK(on_no_more_pads), stage);
+        g_print("Configured source: %s (file)\n", stage->location);
+        return TRUE;
+    }
+
+    if (stage->kind == INGEST_RTSP) {
+        GstElement *source = make_element("rtspsrc", "rtsp-source");
+        if (!source) return FALSE;
+        g_object_set(G_OBJECT(source),
+                     "location", stage->location,
+                     "latency", (guint)stage->jitter_ms,
+                     "drop-on-latency", TRUE,
+                     NULL);
+        if (stage->rtsp_tcp) {
+            g_object_set(G_OBJECT(source), "protocols", 0x00000004, NULL);  // GST_RTSP_LOWER_TRANS_TCP
+        }
+        gst_bin_add(GST_BIN(pipeline), source);
+        g_signal_connect(source, "pad-added", G_CALLBACK(on_source_pad_added), stage);
+        g_print("Configured source: %s (RTSP, jitter %d ms%s)\n", stage->location,
+                stage->jitter_ms, stage->rtsp_tcp ? ", TCP" : "");
+        return TRUE;
+    }
+
+    // RTP: el codec se conoce de antemano, la cadena se arma de forma estática
+    GstElement *source = make_element("udpsrc", "rtp-source");
+    GstElement *jitter = make_element("rtpjitterbuffer", "rtp-jitterbuffer");
+    if (!source || !jitter) return FALSE;
+    gchar *caps_str = g_strdup_printf("application/x-rtp, media=video, clock-rate=90000, "
+                                      "encoding-name=%s", stage->rtp_codec);
+    GstCaps *caps = gst_caps_from_string(caps_str);
+    g_free(caps_str);
+    g_object_set(G_OBJECT(source),
+                 "address", stage->location,
+                 "port", stage->port,
+                 "caps", caps,
+                 "buffer-size", 4 * 1024 * 1024,
+                 NULL);
+    gst_caps_unref(caps);
+    g_object_set(G_OBJECT(jitter),
+                 "latency", (guint)stage->jitter_ms,
+                 "drop-on-latency", TRUE,
+                 NULL);
+    gst_bin_add_many(GST_BIN(pipeline), source, jitter, NULL);
+    if (!gst_element_link(source, jitter)) {
+        g_printerr("Failed to link udpsrc -> rtpjitterbuffer\n");
+        return FALSE;
+    }
+
+    GstPad *jitter_src = gst_element_get_static_pad(jitter, "src");
+    gboolean ok = link_video_stream(stage, jitter_src, stage->rtp_codec, TRUE);
+    gst_object_unref(jitter_src);
+    g_print("Configured source: rtp://%s:%d (%s, jitter %d ms)\n", stage->location,
+            stage->port, stage->rtp_codec, stage->jitter_ms);
+    return ok;
+}
+
+void ingest_clear(IngestStage *stage) {
+    g_free(stage->location);
+    g_free(stage->rtp_codec);
+    stage->location = NULL;
+    stage->rtp_codec = NULL;
+}
@@ -0,0 +1,64 @@
+/*
+ * ingest.hpp
+ * Etapa de entrada genérica: archivos (cualquier contenedor), RTSP y RTP
+ *
+ * La entrada se indica como ruta o URI:
+ *   video.mkv | file:///ruta/video.ts      -> filesrc -> parsebin
+ *   rtsp://camara/stream                   -> rtspsrc (jitterbuffer interno)
+ *   rtp://host:puerto[?codec=h265]         -> udpsrc -> rtpjitterbuffer
+ * El primer stream H.264/H.265 se conecta a parser -> decoder -> streammux;
+ * el decoder (hardware o software) se elige cuando se conocen los caps.
+ */
+
+#ifndef INGEST_HPP
+#define INGEST_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+
+enum IngestKind {
+    INGEST_FILE,
+    INGEST_RTSP,
+    INGEST_RTP
+};
+
+enum DecoderMode {
+    DECODER_AUTO,   // nvv4l2decoder si está disponible, si no avdec
+    DECODER_HW,
+    DECODER_SW
+};
+
+// Se llama con cada decoder creado (para agregar probes)
+typedef void (*IngestDecoderCallback)(GstElement *decoder, gpointer user_data);
+
+// Etapa de entrada
+struct IngestStage {
+    IngestKind kind;
+    gchar *location;        // Ruta del archivo, URI RTSP o host/grupo RTP
+    gint port;              // Puerto RTP
+    gchar *rtp_codec;       // "H264" o "H265" (RTP)
+    DecoderMode decoder_mode;
+    gint jitter_ms;         // Latencia del jitterbuffer (RTSP/RTP)
+    gboolean rtsp_tcp;      // RTSP intercalado sobre TCP
+    gboolean pace;          // identity sync antes del decoder (archivos en perfil live)
+    GstElement *decode_queue;  // Frontera de hilo decoder -> muxer (o NULL); al bin en ingest_build
+    GstElement *pipeline;
+    GstPad *mux_sink;       // sink_0 del streammux
+    gboolean linked;        // Ya se conectó el stream de video
+    IngestDecoderCallback on_decoder;
+    gpointer user_data;
+};
+
+// Interpreta la entrada (ruta o URI); FALSE si el formato es inválido
+gboolean ingest_parse_input(IngestStage *stage, const gchar *input);
+
+// TRUE para fuentes de red (el muxer debe trabajar en modo live)
+gboolean ingest_is_live(const IngestStage *stage);
+
+// Crea la fuente y prepara la conexión dinámica hacia mux_sink
+gboolean ingest_build(IngestStage *stage, GstElement *pipeline, GstPad *mux_sink);
+
+// Libera los campos de la etapa
+void ingest_clear(IngestStage *stage);
+
+#endif // INGEST_HPP
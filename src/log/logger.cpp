@@ -0,0 +1,252 @@
+/*
+ * logger.cpp
+ * Implementación del log asíncrono
+ */
+
+#include "logger.hpp"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LOGGER_IDLE_US 20000
+
+Logger *g_logger = NULL;
+
+static const gchar *LEVEL_NAMES[] = { "debug", "info", "warn", "error" };
+static const gchar *CATEGORY_NAMES[LOG_CAT_COUNT] = { "app", "pipeline", "tracker", "render" };
+
+// Límites por defecto: las alertas del tracker se repiten en cada frame y el
+// resumen del ROI en draw_roi_rect basta con verlo una vez por minuto
+static const guint32 DEFAULT_LIMIT[LOG_CAT_COUNT] = { 0, 0, 2, 1 };
+static const guint32 DEFAULT_WINDOW_S[LOG_CAT_COUNT] = { 1, 1, 1, 60 };
+
+static guint64 monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000ULL + (guint64)ts.tv_nsec;
+}
+
+gboolean logger_parse_level(const gchar *name, LogLevel *level) {
+    for (gint i = 0; i <= LOG_LEVEL_ERROR; i++) {
+        if (g_ascii_strcasecmp(name, LEVEL_NAMES[i]) == 0) {
+            *level = (LogLevel)i;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+gboolean logger_parse_rates(Logger *logger, const gchar *spec) {
+    gchar **items = g_strsplit(spec, ",", -1);
+    gboolean ok = TRUE;
+    for (gint i = 0; items[i] && ok; i++) {
+        gchar name[32];
+        guint limit = 0, window_s = 0;
+        ok = sscanf(items[i], " %31[^=]=%u/%u", name, &limit, &window_s) == 3 && window_s > 0;
+        gint cat = -1;
+        for (gint c = 0; ok && c < LOG_CAT_COUNT; c++) {
+            if (g_strcmp0(g_strstrip(name), CATEGORY_NAMES[c]) == 0) cat = c;
+        }
+        if (!ok || cat < 0) {
+            g_printerr("Invalid log rate '%s' (expected <category>=<n>/<seconds>)\n", items[i]);
+            ok = FALSE;
+            break;
+        }
+        logger->categories[cat].limit = limit;
+        logger->categories[cat].window_ns = window_s * 1000000000ULL;
+    }
+    g_strfreev(items);
+    return ok;
+}
+
+static void write_json_string(FILE *out, const gchar *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        switch (*s) {
+            case '"':  fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\t': fputs("\\t", out); break;
+            default:
+                if ((guchar)*s < 0x20) fprintf(out, "\\u%04x", *s);
+                else fputc(*s, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void emit(Logger *logger, const LogRecord *rec) {
+    if (logger->format == LOG_FORMAT_JSON) {
+        fprintf(logger->out, "{\"ts\":%.3f,\"level\":\"%s\",\"cat\":\"%s\",\"msg\":",
+                rec->ts_ns / 1e9, LEVEL_NAMES[rec->level], CATEGORY_NAMES[rec->category]);
+        write_json_string(logger->out, rec->message);
+        if (rec->suppressed) fprintf(logger->out, ",\"suppressed\":%u", rec->suppressed);
+        fprintf(logger->out, "}\n");
+    } else {
+        fprintf(logger->out, "[%9.3f] %-5s %-8s %s", rec->ts_ns / 1e9,
+                LEVEL_NAMES[rec->level], CATEGORY_NAMES[rec->category], rec->message);
+        if (rec->suppressed) fprintf(logger->out, " (+%u suppressed)", rec->suppressed);
+        fprintf(logger->out, "\n");
+    }
+}
+
+// Vacía los slots publicados; devuelve cuántos escribió
+static guint drain(Logger *logger) {
+    guint written = 0;
+    for (;;) {
+        LogSlot *slot = &logger->slots[logger->dequeue_pos & (LOGGER_RING_SLOTS - 1)];
+        if (slot->seq.load(std::memory_order_acquire) != logger->dequeue_pos + 1) break;
+        emit(logger, &slot->record);
+        // Libera el slot para la siguiente vuelta del anillo
+        slot->seq.store(logger->dequeue_pos + LOGGER_RING_SLOTS, std::memory_order_release);
+        logger->dequeue_pos++;
+        written++;
+    }
+    if (written) fflush(logger->out);
+    return written;
+}
+
+static gpointer writer_thread(gpointer data) {
+    Logger *logger = (Logger *)data;
+    while (logger->running.load(std::memory_order_acquire)) {
+        if (drain(logger) == 0) g_usleep(LOGGER_IDLE_US);
+    }
+    drain(logger);
+    return NULL;
+}
+
+gboolean logger_init(Logger *logger, LogLevel level, LogFormat format, const gchar *path) {
+    logger->level = level;
+    logger->format = format;
+    logger->out = stdout;
+    logger->owns_out = FALSE;
+    logger->start_ns = monotonic_ns();
+    for (guint64 i = 0; i < LOGGER_RING_SLOTS; i++) {
+        logger->slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+    logger->enqueue_pos.store(0, std::memory_order_relaxed);
+    logger->dequeue_pos = 0;
+    logger->dropped.store(0, std::memory_order_relaxed);
+    for (gint c = 0; c < LOG_CAT_COUNT; c++) {
+        LogCategoryState *cat = &logger->categories[c];
+        cat->limit = DEFAULT_LIMIT[c];
+        cat->window_ns = DEFAULT_WINDOW_S[c] * 1000000000ULL;
+        cat->window_start_ns.store(0, std::memory_order_relaxed);
+        cat->count.store(0, std::memory_order_relaxed);
+        cat->suppressed.store(0, std::memory_order_relaxed);
+    }
+    logger->thread = NULL;
+    logger->running.store(false, std::memory_order_relaxed);
+
+    if (path) {
+        logger->out = fopen(path, "a");
+        if (!logger->out) {
+            g_printerr("Logger: could not open %s\n", path);
+            logger->out = stdout;
+            return FALSE;
+        }
+        logger->owns_out = TRUE;
+    }
+
+    logger->running.store(true, std::memory_order_release);
+    logger->thread = g_thread_new("logger", writer_thread, logger);
+    g_logger = logger;
+    return TRUE;
+}
+
+// Ventana fija por categoría; devuelve FALSE si el mensaje se omite y en
+// *suppressed los omitidos desde el último mensaje emitido
+static gboolean rate_allow(LogCategoryState *cat, guint64 now, guint32 *suppressed) {
+    *suppressed = 0;
+    if (cat->limit == 0) return TRUE;
+
+    guint64 start = cat->window_start_ns.load(std::memory_order_relaxed);
+    if (now - start >= cat->window_ns &&
+        cat->window_start_ns.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        cat->count.store(0, std::memory_order_relaxed);
+    }
+    if (cat->count.fetch_add(1, std::memory_order_relaxed) >= cat->limit) {
+        cat->suppressed.fetch_add(1, std::memory_order_relaxed);
+        return FALSE;
+    }
+    *suppressed = cat->suppressed.exchange(0, std::memory_order_relaxed);
+    return TRUE;
+}
+
+void logger_write(LogLevel level, LogCategory category, const gchar *format, ...) {
+    Logger *logger = g_logger;
+    va_list args;
+
+    if (!logger) {
+        va_start(args, format);
+        gchar *message = g_strdup_vprintf(format, args);
+        va_end(args);
+        g_print("%s\n", message);
+        g_free(message);
+        return;
+    }
+
+    guint64 now = monotonic_ns();
+    guint32 suppressed;
+    if (!rate_allow(&logger->categories[category], now, &suppressed)) return;
+
+    // Reserva de slot (anillo acotado de Vyukov): seq == pos indica libre
+    guint64 pos = logger->enqueue_pos.load(std::memory_order_relaxed);
+    LogSlot *slot;
+    for (;;) {
+        slot = &logger->slots[pos & (LOGGER_RING_SLOTS - 1)];
+        guint64 seq = slot->seq.load(std::memory_order_acquire);
+        if (seq == pos) {
+            if (logger->enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                          std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (seq < pos) {
+            // Lleno: el hilo de escritura no alcanza; no se bloquea el streaming
+            logger->dropped.fetch_add(1, std::memory_order_relaxed);
+            if (suppressed) {
+                logger->categories[category].suppressed.fetch_add(suppressed,
+                                                                  std::memory_order_relaxed);
+            }
+            return;
+        } else {
+            pos = logger->enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    LogRecord *rec = &slot->record;
+    rec->ts_ns = now - logger->start_ns;
+    rec->level = level;
+    rec->category = category;
+    rec->suppressed = suppressed;
+    va_start(args, format);
+    g_vsnprintf(rec->message, sizeof(rec->message), format, args);
+    va_end(args);
+    slot->seq.store(pos + 1, std::memory_order_release);
+}
+
+void logger_destroy(Logger *logger) {
+    if (g_logger == logger) g_logger = NULL;
+    if (logger->thread) {
+        logger->running.store(false, std::memory_order_release);
+        g_thread_join(logger->thread);
+        logger->thread = NULL;
+    }
+
+    // Omitidos pendientes y descartados, escritos ya sin el hilo de fondo
+    for (gint c = 0; c < LOG_CAT_COUNT; c++) {
+        guint32 pending = logger->categories[c].suppressed.load(std::memory_order_relaxed);
+        if (pending) {
+            fprintf(logger->out, "Log: %u %s messages suppressed by rate limit\n",
+                    pending, CATEGORY_NAMES[c]);
+        }
+    }
+    guint64 dropped = logger->dropped.load(std::memory_order_relaxed);
+    if (dropped) {
+        fprintf(logger->out, "Log: %" G_GUINT64_FORMAT " messages dropped (ring full)\n", dropped);
+    }
+    fflush(logger->out);
+    if (logger->owns_out) fclose(logger->out);
+    logger->out = NULL;
+}
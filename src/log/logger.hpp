@@ -0,0 +1,117 @@
+/*
+ * logger.hpp
+ * Log asíncrono con niveles y límite de mensajes por categoría
+ *
+ * Los hilos de streaming no escriben en consola: formatean el mensaje en un
+ * slot de un anillo sin locks (varios productores, un consumidor) y un hilo
+ * de fondo lo imprime en texto plano o JSON por línea. Cada categoría
+ * admite como máximo N mensajes por ventana; los que exceden el límite solo
+ * incrementan un contador que se informa con el siguiente mensaje emitido.
+ * Si el anillo está lleno el mensaje se descarta y se cuenta.
+ */
+
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <glib.h>
+#include <stdio.h>
+#include <atomic>
+
+#define LOGGER_RING_SLOTS 1024        // Potencia de 2
+#define LOGGER_MESSAGE_SIZE 224
+
+enum LogLevel {
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR
+};
+
+enum LogCategory {
+    LOG_CAT_APP,
+    LOG_CAT_PIPELINE,
+    LOG_CAT_TRACKER,
+    LOG_CAT_RENDER,
+    LOG_CAT_COUNT
+};
+
+enum LogFormat {
+    LOG_FORMAT_PLAIN,
+    LOG_FORMAT_JSON
+};
+
+struct LogRecord {
+    guint64 ts_ns;            // Desde el inicio del logger
+    guint32 level;
+    guint32 category;
+    guint32 suppressed;       // Mensajes de la categoría omitidos antes de este
+    gchar message[LOGGER_MESSAGE_SIZE];
+};
+
+struct LogSlot {
+    std::atomic<guint64> seq;
+    LogRecord record;
+};
+
+// Límite por categoría: limit mensajes por ventana (0 = sin límite)
+struct LogCategoryState {
+    guint32 limit;
+    guint64 window_ns;
+    std::atomic<guint64> window_start_ns;
+    std::atomic<guint32> count;
+    std::atomic<guint32> suppressed;
+};
+
+struct Logger {
+    LogLevel level;
+    LogFormat format;
+    FILE *out;
+    gboolean owns_out;
+    guint64 start_ns;
+
+    LogSlot slots[LOGGER_RING_SLOTS];
+    std::atomic<guint64> enqueue_pos;
+    guint64 dequeue_pos;              // Solo el hilo de escritura
+    std::atomic<guint64> dropped;     // Anillo lleno
+
+    LogCategoryState categories[LOG_CAT_COUNT];
+
+    GThread *thread;
+    std::atomic<bool> running;
+};
+
+// Logger activo (NULL: los mensajes se imprimen con g_print de inmediato)
+extern Logger *g_logger;
+
+// path NULL = stdout; publica el logger en g_logger
+gboolean logger_init(Logger *logger, LogLevel level, LogFormat format, const gchar *path);
+
+// Nivel a partir de "debug", "info", "warn" o "error"
+gboolean logger_parse_level(const gchar *name, LogLevel *level);
+
+// Límites "<categoría>=<n>/<segundos>[,...]"; n = 0 desactiva el límite
+gboolean logger_parse_rates(Logger *logger, const gchar *spec);
+
+// Vacía el anillo, informa los mensajes omitidos y detiene el hilo
+void logger_destroy(Logger *logger);
+
+void logger_write(LogLevel level, LogCategory category, const gchar *format, ...)
+    G_GNUC_PRINTF(3, 4);
+
+static inline gboolean logger_enabled(LogLevel level) {
+    return level >= (g_logger ? g_logger->level : LOG_LEVEL_INFO);
+}
+
+// El nivel se evalúa antes de formatear los argumentos
+#define ROI_LOG(level, category, ...) \
+    do { \
+        if (logger_enabled(level)) logger_write(level, category, __VA_ARGS__); \
+    } while (0)
+
+// Prefijo ROI_ para no chocar con LOG_INFO/LOG_DEBUG de <syslog.h>
+#define ROI_LOG_DEBUG(category, ...) ROI_LOG(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#define ROI_LOG_INFO(category, ...)  ROI_LOG(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#define ROI_LOG_WARN(category, ...)  ROI_LOG(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#define ROI_LOG_ERROR(category, ...) ROI_LOG(LOG_LEVEL_ERROR, category, __VA_ARGS__)
+
+#endif // LOGGER_HPP
@@ -6,21 +6,63 @@
  */
 #include <gst/gst.h>
 #include <glib.h>
+#include <glib-unix.h>
 #include <stdio.h>
+#include <signal.h>
 #include "config/app_config.hpp"
 #include "config/track_info.hpp"
 #include "pipeline/pipeline.hpp"
+#include "export/shm_export.hpp"
+#include "snapshot/snapshot.hpp"
+#include "encoder/rate_control.hpp"
+#include "stream/latency.hpp"
+#include "ingest/ingest.hpp"
 #include "video_utils.h"
 
+// Ctrl+C: EOS para cerrar el archivo de salida y generar el reporte (las
+// fuentes de red no terminan solas); un segundo Ctrl+C sale de inmediato
+static gboolean on_interrupt(gpointer data) {
+    PipelineContext *ctx = (PipelineContext *)data;
+    static gboolean eos_sent = FALSE;
+    if (eos_sent || !ctx->pipeline) {
+        g_main_loop_quit(ctx->loop);
+        return G_SOURCE_REMOVE;
+    }
+    g_print("\nInterrumpido: enviando EOS...\n");
+    gst_element_send_event(ctx->pipeline, gst_event_new_eos());
+    eos_sent = TRUE;
+    return G_SOURCE_CONTINUE;
+}
+
 static void cleanup(PipelineContext *ctx, TrackerContext *tracker, 
                    AppConfig *config, GTimer *app_timer) {
+    // Primero el pipeline: el probe del OSD usa el tracker y su configuración
+    if (ctx->pipeline) {
+        gst_element_set_state(ctx->pipeline, GST_STATE_NULL);
+        gst_object_unref(GST_OBJECT(ctx->pipeline));
+        ctx->pipeline = NULL;
+    }
+    
+    // El hilo de control libera configuraciones del tracker: se detiene antes
+    if (ctx->live_config) live_config_destroy(ctx->live_config);
     tracker_destroy(tracker);
     
     if (app_timer) g_timer_destroy(app_timer);
     
-    if (ctx->pipeline) {
-        gst_element_set_state(ctx->pipeline, GST_STATE_NULL);
-        gst_object_unref(GST_OBJECT(ctx->pipeline));
+    // Después de detener el pipeline: el probe de exportación ya no corre
+    if (ctx->shm_export) shm_export_destroy(ctx->shm_export);
+    if (ctx->snapshots) snapshot_destroy(ctx->snapshots);
+    if (ctx->latency_log) latency_log_destroy(ctx->latency_log);
+    if (ctx->ingest) ingest_clear(ctx->ingest);
+    if (ctx->benchmark) benchmark_destroy(ctx->benchmark);
+    if (ctx->metrics) metrics_destroy(ctx->metrics);
+    if (ctx->resources) resource_sampler_destroy(ctx->resources);
+    if (ctx->checkpoint) checkpoint_destroy(ctx->checkpoint);
+    if (ctx->heatmap) heatmap_destroy(ctx->heatmap);
+    if (ctx->trajectories) trajectory_destroy(ctx->trajectories);
+    if (ctx->tracer) {
+        trace_write(ctx->tracer);
+        trace_destroy(ctx->tracer);
     }
     
     g_free(config->input_file);
@@ -28,6 +70,41 @@ static void cleanup(PipelineContext *ctx, TrackerContext *tracker,
     g_free(config->report_file);
     g_free(config->mode);
     g_free(config->udp_host);
+    g_free(config->udp_clients);
+    g_free(config->udp_multicast);
+    for (gint i = 0; i < config->num_renditions; i++) g_free(config->renditions[i]);
+    g_free(config->shm_name);
+    g_free(config->snapshot_dir);
+    g_free(config->encoder);
+    g_free(config->profile);
+    g_free(config->latency_log);
+    g_free(config->media_cache);
+    g_free(config->decoder);
+    g_free(config->topology);
+    g_free(config->bench_out);
+    g_free(config->metrics);
+    g_free(config->trace);
+    g_free(config->resource_log);
+    g_free(config->log_level);
+    g_free(config->log_format);
+    g_free(config->log_rate);
+    g_free(config->log_file);
+    g_free(config->config_file);
+    g_free(config->checkpoint);
+    g_free(config->classes);
+    g_free(config->class_time);
+    g_free(config->class_color);
+    g_free(config->control_socket);
+    g_free(config->process_size);
+    g_free(config->tracker_size);
+    g_free(config->output_size);
+    g_free(config->heatmap);
+    g_free(config->heatmap_grid);
+    g_free(config->report_store);
+    g_free(config->trajectories);
+    
+    // Al final: vacía los mensajes pendientes de los hilos de streaming
+    if (g_logger) logger_destroy(g_logger);
 }
 
 int main(int argc, char *argv[]) {
@@ -37,6 +114,23 @@ int main(int argc, char *argv[]) {
     ROIParams roi;
     TrackerContext tracker;
     PipelineContext pipeline_ctx;
+    ShmExporter shm_export;
+    SnapshotContext snapshots;
+    RateController rate_control;
+    LatencyLog latency_log;
+    IngestStage ingest;
+    Topology topology;
+    StageTimer stage_timer;
+    BenchmarkRun benchmark;
+    MetricsServer metrics;
+    Tracer tracer;
+    ResourceSampler resources;
+    LiveConfig live_config;
+    CheckpointWriter checkpoint;
+    Heatmap heatmap;
+    TrajectoryRecorder trajectories;
+    static Aggregates aggregates;  // ~200 KB: fuera de la pila
+    Logger logger;
     GTimer *app_timer = g_timer_new();
     VideoInfo video_info;
     
@@ -45,35 +139,256 @@ int main(int argc, char *argv[]) {
         return -1;
     }
     
-    // Detectar resolución del video
-    g_print("\n");
-    g_print("=== Detectando informacion del video ===\n");
-    if (!get_video_info(config.input_file, &video_info)) {
-        g_printerr("ERROR: No se pudo obtener informacion del video\n");
-        g_printerr("Usando resolucion por defecto: 1280x720\n");
+    LogLevel log_level = LOG_LEVEL_INFO;
+    if (config.log_level && !logger_parse_level(config.log_level, &log_level)) {
+        g_printerr("ERROR: Nivel de log invalido '%s'\n", config.log_level);
+        if (app_timer) g_timer_destroy(app_timer);
+        return -1;
+    }
+    if (!logger_init(&logger, log_level,
+                     g_strcmp0(config.log_format, "json") == 0 ? LOG_FORMAT_JSON : LOG_FORMAT_PLAIN,
+                     config.log_file)) {
+        g_printerr("ERROR: No se pudo abrir el archivo de log: %s\n", config.log_file);
+        logger_destroy(&logger);
+        if (app_timer) g_timer_destroy(app_timer);
+        return -1;
+    }
+    if (config.log_rate && !logger_parse_rates(&logger, config.log_rate)) {
+        logger_destroy(&logger);
+        if (app_timer) g_timer_destroy(app_timer);
+        return -1;
+    }
+    
+    if (!ingest_parse_input(&ingest, config.input_file)) {
+        g_printerr("ERROR: Entrada invalida: %s\n", config.input_file);
+        ingest_clear(&ingest);
+        logger_destroy(&logger);
+        if (app_timer) g_timer_destroy(app_timer);
+        return -1;
+    }
+    ingest.decoder_mode = g_strcmp0(config.decoder, "hw") == 0 ? DECODER_HW :
+                          g_strcmp0(config.decoder, "sw") == 0 ? DECODER_SW : DECODER_AUTO;
+    ingest.jitter_ms = config.jitter_latency;
+    ingest.rtsp_tcp = config.rtsp_tcp;
+    
+    if (config.topology) {
+        if (!topology_parse(config.topology, &topology)) {
+            ingest_clear(&ingest);
+            logger_destroy(&logger);
+            if (app_timer) g_timer_destroy(app_timer);
+            return -1;
+        }
+    } else {
+        topology_default(&topology, g_strcmp0(config.profile, "live") == 0);
+    }
+    
+    // ROI, umbral y clases iniciales (luego se pueden cambiar con --config)
+    TrackerConfig tracker_config;
+    tracker_config_defaults(&tracker_config, &roi, config.max_time_seconds);
+    gchar *class_error = NULL;
+    if (!tracker_config_set_classes(&tracker_config, config.classes, config.class_time,
+                                    config.class_color, &class_error)) {
+        g_printerr("ERROR: %s\n", class_error);
+        g_free(class_error);
+        ingest_clear(&ingest);
+        logger_destroy(&logger);
+        if (app_timer) g_timer_destroy(app_timer);
+        return -1;
+    }
+    
+    // La resolución real se toma de los caps del decoder al llegar el primer
+    // frame; el cache solo evita reconfigurar el muxer en corridas repetidas
+    if (!config.media_cache || ingest.kind != INGEST_FILE ||
+        !video_info_cache_lookup(config.media_cache, ingest.location, &video_info)) {
         video_info.width = 1280;
         video_info.height = 720;
-        video_info.valid = TRUE;
+        video_info.fps_num = 0;
+        video_info.fps_den = 1;
+        video_info.valid = FALSE;
     }
     
     g_print("\n");
     g_print("=== Sistema de Vigilancia ROI ===\n");
     g_print("Input: %s\n", config.input_file);
-    g_print("Resolution: %dx%d\n", video_info.width, video_info.height);
+    if (video_info.valid) {
+        g_print("Resolution: %dx%d (media cache)\n", video_info.width, video_info.height);
+    } else {
+        g_print("Resolution: from decoder caps\n");
+    }
     g_print("ROI: [%.2f, %.2f, %.2f, %.2f]\n", roi.x, roi.y, roi.w, roi.h);
     g_print("Max time: %d s\n", config.max_time_seconds);
     g_print("Mode: %s\n", config.mode);
     
     // Inicializar tracker
-    tracker_init(&tracker, &roi, config.max_time_seconds, app_timer);
+    tracker_init(&tracker, &tracker_config, app_timer);
     
     // Inicializar contexto del pipeline con resolución detectada
     pipeline_ctx.loop = g_main_loop_new(NULL, FALSE);
     pipeline_ctx.tracker = &tracker;
     pipeline_ctx.config = &config;
+    pipeline_ctx.ingest = &ingest;
+    pipeline_ctx.live_source = FALSE;
+    pipeline_ctx.topology = &topology;
+    pipeline_ctx.stage_timer = NULL;
+    pipeline_ctx.benchmark = NULL;
+    pipeline_ctx.metrics = NULL;
+    pipeline_ctx.tracer = NULL;
+    pipeline_ctx.resources = NULL;
+    pipeline_ctx.live_config = NULL;
+    pipeline_ctx.checkpoint = NULL;
+    pipeline_ctx.heatmap = NULL;
+    pipeline_ctx.trajectories = NULL;
+    pipeline_ctx.aggregates = NULL;
+    pipeline_ctx.resume_pts = GST_CLOCK_TIME_NONE;
+    pipeline_ctx.frames_processed = 0;
     pipeline_ctx.pipeline = NULL;
+    pipeline_ctx.streammux = NULL;
+    pipeline_ctx.stream_configured = FALSE;
+    pipeline_ctx.first_frame_time = -1.0;
     pipeline_ctx.stream_width = video_info.width;
     pipeline_ctx.stream_height = video_info.height;
+    pipeline_ctx.stream_fps_num = video_info.fps_num;
+    pipeline_ctx.stream_fps_den = video_info.fps_den;
+    geometry_parse_size(config.process_size, &pipeline_ctx.geometry.process_spec);
+    geometry_parse_size(config.tracker_size, &pipeline_ctx.geometry.tracker_spec);
+    geometry_parse_size(config.output_size, &pipeline_ctx.geometry.output_spec);
+    geometry_resolve(&pipeline_ctx.geometry, video_info.width, video_info.height);
+    pipeline_ctx.output_caps = NULL;
+    pipeline_ctx.output_system_memory = FALSE;
+    pipeline_ctx.shm_export = NULL;
+    pipeline_ctx.snapshots = NULL;
+    pipeline_ctx.rate_control = NULL;
+    pipeline_ctx.latency_log = NULL;
+    
+    if (config.shm_name) {
+        pipeline_ctx.shm_export = &shm_export;
+        if (!shm_export_init(&shm_export, config.shm_name, (guint)config.shm_slots)) {
+            cleanup(&pipeline_ctx, &tracker, &config, app_timer);
+            g_main_loop_unref(pipeline_ctx.loop);
+            return -1;
+        }
+    }
+    
+    RateControlConfig rc_config;
+    rc_config.enabled = config.adaptive_bitrate;
+    rc_config.active_bitrate = (guint)config.bitrate_active;
+    rc_config.idle_bitrate = (guint)config.bitrate_idle;
+    rc_config.active_gop = (guint)config.gop_active;
+    rc_config.idle_gop = (guint)config.gop_idle;
+    rc_config.idle_hold = config.idle_hold;
+    rate_control_init(&rate_control, &rc_config,
+                      g_strcmp0(config.encoder, "x264") == 0 ? ENCODER_X264 : ENCODER_NVV4L2);
+    pipeline_ctx.rate_control = &rate_control;
+    
+    // Latencia por etapa para el benchmark y/o los histogramas de métricas
+    if (config.bench_out || config.metrics) {
+        stage_timer_init(&stage_timer);
+        pipeline_ctx.stage_timer = &stage_timer;
+    }
+    if (config.bench_out) {
+        benchmark_init(&benchmark, config.bench_out, &topology);
+        pipeline_ctx.benchmark = &benchmark;
+    }
+    
+    if (config.metrics) {
+        if (!metrics_init(&metrics, config.metrics)) {
+            metrics_destroy(&metrics);
+            cleanup(&pipeline_ctx, &tracker, &config, app_timer);
+            g_main_loop_unref(pipeline_ctx.loop);
+            return -1;
+        }
+        pipeline_ctx.metrics = &metrics;
+    }
+    
+    if (config.trace) {
+        trace_init(&tracer, config.trace, config.trace_buffer > 0 ? (guint32)config.trace_buffer : 0);
+        pipeline_ctx.tracer = &tracer;
+    }
+    
+    if (config.resource_log) {
+        pipeline_ctx.resources = &resources;
+        if (!resource_sampler_init(&resources, config.resource_log,
+                                   config.resource_interval > 0 ? (guint)config.resource_interval : 0)) {
+            cleanup(&pipeline_ctx, &tracker, &config, app_timer);
+            g_main_loop_unref(pipeline_ctx.loop);
+            return -1;
+        }
+    }
+    
+    if (config.latency_log) {
+        if (!latency_log_init(&latency_log, config.latency_log)) {
+            cleanup(&pipeline_ctx, &tracker, &config, app_timer);
+            g_main_loop_unref(pipeline_ctx.loop);
+            return -1;
+        }
+        pipeline_ctx.latency_log = &latency_log;
+    }
+    
+    if (config.snapshot_dir) {
+        pipeline_ctx.snapshots = &snapshots;
+        if (!snapshot_init(&snapshots, config.snapshot_dir, config.snapshot_workers,
+                           config.snapshot_queue, config.snapshot_full)) {
+            cleanup(&pipeline_ctx, &tracker, &config, app_timer);
+            g_main_loop_unref(pipeline_ctx.loop);
+            return -1;
+        }
+    }
+    
+    if (config.checkpoint) {
+        // Restaura antes de abrir para escribir: si se reanudó, el último
+        // checkpoint válido se conserva hasta sellar el siguiente
+        guint64 input_key = checkpoint_input_key(ingest.location, ingest.kind == INGEST_FILE);
+        gboolean resumed = checkpoint_resume(config.checkpoint, input_key, &tracker,
+                                             &pipeline_ctx.resume_pts);
+        pipeline_ctx.checkpoint = &checkpoint;
+        if (!checkpoint_init(&checkpoint, config.checkpoint, input_key,
+                             config.checkpoint_tracks > 0 ? (guint)config.checkpoint_tracks : 0,
+                             config.checkpoint_interval > 0 ? (guint)config.checkpoint_interval : 0,
+                             resumed)) {
+            cleanup(&pipeline_ctx, &tracker, &config, app_timer);
+            g_main_loop_unref(pipeline_ctx.loop);
+            return -1;
+        }
+    }
+    
+    if (config.heatmap) {
+        guint grid_width = HEATMAP_DEFAULT_WIDTH, grid_height = HEATMAP_DEFAULT_HEIGHT;
+        if (config.heatmap_grid &&
+            !heatmap_parse_grid(config.heatmap_grid, &grid_width, &grid_height)) {
+            g_printerr("ERROR: Grilla invalida '%s' (use WxH, p.ej. 64x36)\n", config.heatmap_grid);
+            cleanup(&pipeline_ctx, &tracker, &config, app_timer);
+            g_main_loop_unref(pipeline_ctx.loop);
+            return -1;
+        }
+        pipeline_ctx.heatmap = &heatmap;
+        if (!heatmap_init(&heatmap, config.heatmap, grid_width, grid_height,
+                          config.heatmap_interval > 0 ? (guint)config.heatmap_interval : 0)) {
+            cleanup(&pipeline_ctx, &tracker, &config, app_timer);
+            g_main_loop_unref(pipeline_ctx.loop);
+            return -1;
+        }
+    }
+    
+    if (config.trajectories) {
+        trajectory_init(&trajectories, config.trajectories,
+                        config.trajectory_memory > 0 ? (guint)config.trajectory_memory : 0);
+        pipeline_ctx.trajectories = &trajectories;
+    }
+    
+    if (config.window_stats) {
+        aggregates_init(&aggregates, config.window_log > 0 ? (guint)config.window_log : 0);
+        pipeline_ctx.aggregates = &aggregates;
+    }
+    
+    if (config.config_file || config.control_socket) {
+        pipeline_ctx.live_config = &live_config;
+        if (!live_config_init(&live_config, &tracker, config.config_file,
+                              config.control_socket)) {
+            cleanup(&pipeline_ctx, &tracker, &config, app_timer);
+            g_main_loop_unref(pipeline_ctx.loop);
+            return -1;
+        }
+    }
     
     if (!pipeline_create(&pipeline_ctx)) {
         g_printerr("Failed to create pipeline\n");
@@ -87,6 +402,23 @@ int main(int argc, char *argv[]) {
     g_print("Press Ctrl+C to stop\n");
     g_print("\n");
     
+    // Reanudación de un archivo: se salta al PTS del último checkpoint (en
+    // vivo solo se restaura la permanencia)
+    if (GST_CLOCK_TIME_IS_VALID(pipeline_ctx.resume_pts) && ingest.kind == INGEST_FILE) {
+        gst_element_set_state(pipeline_ctx.pipeline, GST_STATE_PAUSED);
+        gst_element_get_state(pipeline_ctx.pipeline, NULL, NULL, 10 * GST_SECOND);
+        if (!gst_element_seek_simple(pipeline_ctx.pipeline, GST_FORMAT_TIME,
+                                     (GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT),
+                                     pipeline_ctx.resume_pts)) {
+            g_printerr("Checkpoint: seek failed, skipping frames up to %.3f s\n",
+                       pipeline_ctx.resume_pts / 1e9);
+        }
+    } else if (ingest.kind != INGEST_FILE) {
+        pipeline_ctx.resume_pts = GST_CLOCK_TIME_NONE;
+    }
+    
+    g_unix_signal_add(SIGINT, on_interrupt, &pipeline_ctx);
+    if (pipeline_ctx.benchmark) benchmark_start(pipeline_ctx.benchmark);
     gst_element_set_state(pipeline_ctx.pipeline, GST_STATE_PLAYING);
     g_main_loop_run(pipeline_ctx.loop);
     
@@ -0,0 +1,52 @@
+/*
+ * histogram.cpp
+ * Implementación del histograma de latencias
+ */
+
+#include "histogram.hpp"
+
+// Límites superiores de cada bucket (ns); el último bucket es +Inf
+static const guint64 BOUNDS_NS[HISTOGRAM_BUCKETS - 1] = {
+    500000ULL, 1000000ULL, 2000000ULL, 5000000ULL, 10000000ULL, 20000000ULL,
+    33000000ULL, 50000000ULL, 100000000ULL, 200000000ULL, 500000000ULL
+};
+
+void histogram_init(Histogram *hist) {
+    for (gint i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        hist->buckets[i].store(0, std::memory_order_relaxed);
+    }
+    hist->count.store(0, std::memory_order_relaxed);
+    hist->sum_ns.store(0, std::memory_order_relaxed);
+}
+
+void histogram_observe(Histogram *hist, guint64 ns) {
+    gint i = 0;
+    while (i < HISTOGRAM_BUCKETS - 1 && ns > BOUNDS_NS[i]) i++;
+    hist->buckets[i].fetch_add(1, std::memory_order_relaxed);
+    hist->sum_ns.fetch_add(ns, std::memory_order_relaxed);
+    hist->count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void histogram_write_prometheus(const Histogram *hist, GString *out,
+                                const gchar *name, const gchar *labels) {
+    const gchar *sep = labels ? "," : "";
+    if (!labels) labels = "";
+
+    guint64 cumulative = 0;
+    for (gint i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        cumulative += hist->buckets[i].load(std::memory_order_relaxed);
+        if (i < HISTOGRAM_BUCKETS - 1) {
+            g_string_append_printf(out, "%s_bucket{%s%sle=\"%g\"} %" G_GUINT64_FORMAT "\n",
+                                   name, labels, sep, BOUNDS_NS[i] / 1e9, cumulative);
+        } else {
+            g_string_append_printf(out, "%s_bucket{%s%sle=\"+Inf\"} %" G_GUINT64_FORMAT "\n",
+                                   name, labels, sep, cumulative);
+        }
+    }
+    // _count igual al bucket +Inf aunque un observe() esté a medio camino
+    gchar *braces = *labels ? g_strdup_printf("{%s}", labels) : g_strdup("");
+    g_string_append_printf(out, "%s_sum%s %.6f\n", name, braces,
+                           hist->sum_ns.load(std::memory_order_relaxed) / 1e9);
+    g_string_append_printf(out, "%s_count%s %" G_GUINT64_FORMAT "\n", name, braces, cumulative);
+    g_free(braces);
+}
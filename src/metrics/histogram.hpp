@@ -0,0 +1,35 @@
+/*
+ * histogram.hpp
+ * Histograma de latencias sin locks (buckets fijos, contadores atómicos)
+ *
+ * observe() solo hace una búsqueda lineal en 12 límites y dos fetch_add
+ * relajados: es seguro desde cualquier hilo de streaming. La lectura
+ * (exportación) puede ver un conteo y una suma de instantes ligeramente
+ * distintos, igual que cualquier scrape de Prometheus.
+ */
+
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <glib.h>
+#include <atomic>
+
+#define HISTOGRAM_BUCKETS 12   // 11 límites + "+Inf"
+
+struct Histogram {
+    std::atomic<guint64> buckets[HISTOGRAM_BUCKETS];   // No acumulados
+    std::atomic<guint64> count;
+    std::atomic<guint64> sum_ns;
+};
+
+void histogram_init(Histogram *hist);
+
+// Registra una muestra en nanosegundos
+void histogram_observe(Histogram *hist, guint64 ns);
+
+// Escribe el histograma en formato de texto de Prometheus (segundos);
+// labels: "clave=\"valor\"" o NULL
+void histogram_write_prometheus(const Histogram *hist, GString *out,
+                                const gchar *name, const gchar *labels);
+
+#endif // HISTOGRAM_HPP
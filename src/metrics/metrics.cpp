@@ -0,0 +1,365 @@
+/*
+ * metrics.cpp
+ * Implementación del endpoint de métricas
+ */
+
+#include "metrics.hpp"
+#include <errno.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+static guint64 monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000ULL + (guint64)ts.tv_nsec;
+}
+
+// "unix:/ruta", "host:puerto" o "puerto" (solo localhost)
+static int open_endpoint(MetricsServer *metrics, const gchar *endpoint) {
+    int fd;
+    if (g_str_has_prefix(endpoint, "unix:")) {
+        const gchar *path = endpoint + 5;
+        struct sockaddr_un addr;
+        if (strlen(path) == 0 || strlen(path) >= sizeof(addr.sun_path)) return -1;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, path);
+        unlink(path);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        metrics->unix_path = g_strdup(path);
+    } else {
+        const gchar *colon = strrchr(endpoint, ':');
+        gchar *host = colon ? g_strndup(endpoint, colon - endpoint) : g_strdup("127.0.0.1");
+        gint port = atoi(colon ? colon + 1 : endpoint);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((guint16)port);
+        gboolean valid = port > 0 && port < 65536 && inet_pton(AF_INET, host, &addr.sin_addr) == 1;
+        g_free(host);
+        if (!valid) return -1;
+
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    }
+    if (listen(fd, 8) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void append_metric(GString *out, const gchar *name, const gchar *type,
+                          const gchar *help) {
+    g_string_append_printf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void build_body(MetricsServer *metrics, GString *out) {
+    append_metric(out, "roi_frames_total", "counter", "Frames processed by the OSD probe");
+    g_string_append_printf(out, "roi_frames_total{source=\"0\"} %" G_GUINT64_FORMAT "\n",
+                           metrics->frames.load(std::memory_order_relaxed));
+    append_metric(out, "roi_fps", "gauge", "Frames per second over the last second");
+    g_string_append_printf(out, "roi_fps{source=\"0\"} %.2f\n",
+                           metrics->fps.load(std::memory_order_relaxed));
+
+    append_metric(out, "roi_objects_total", "counter", "Detected objects");
+    g_string_append_printf(out, "roi_objects_total %" G_GUINT64_FORMAT "\n",
+                           metrics->objects.load(std::memory_order_relaxed));
+    append_metric(out, "roi_objects_per_second", "gauge", "Detected objects per second");
+    g_string_append_printf(out, "roi_objects_per_second %.2f\n",
+                           metrics->objects_rate.load(std::memory_order_relaxed));
+    append_metric(out, "roi_tracks_total", "counter", "Tracks created");
+    g_string_append_printf(out, "roi_tracks_total %" G_GUINT64_FORMAT "\n",
+                           metrics->tracks.load(std::memory_order_relaxed));
+    append_metric(out, "roi_tracks_per_second", "gauge", "Tracks created per second");
+    g_string_append_printf(out, "roi_tracks_per_second %.2f\n",
+                           metrics->tracks_rate.load(std::memory_order_relaxed));
+    append_metric(out, "roi_alerts_total", "counter", "ROI dwell alerts raised");
+    g_string_append_printf(out, "roi_alerts_total %" G_GUINT64_FORMAT "\n",
+                           metrics->alerts.load(std::memory_order_relaxed));
+    append_metric(out, "roi_alerts_per_second", "gauge", "ROI dwell alerts per second");
+    g_string_append_printf(out, "roi_alerts_per_second %.2f\n",
+                           metrics->alerts_rate.load(std::memory_order_relaxed));
+    append_metric(out, "roi_active_tracks", "gauge", "Tracks currently in the tracker table");
+    g_string_append_printf(out, "roi_active_tracks %" G_GUINT64_FORMAT "\n",
+                           metrics->active_tracks.load(std::memory_order_relaxed));
+
+    if (metrics->aggregates) {
+        AggView view;
+        aggregates_read(metrics->aggregates, &view);
+        append_metric(out, "roi_occupancy", "gauge", "Tracked objects inside the ROI");
+        g_string_append_printf(out, "roi_occupancy %u\n", view.occupancy);
+        append_metric(out, "roi_window_entries_per_minute", "gauge",
+                      "ROI entries per minute over the window");
+        for (gint w = 0; w < AGG_WINDOWS; w++) {
+            g_string_append_printf(out, "roi_window_entries_per_minute{window=\"%um\"} %.2f\n",
+                                   view.windows[w].minutes, view.windows[w].entries_per_minute);
+        }
+        append_metric(out, "roi_window_occupancy_mean", "gauge",
+                      "Mean objects inside the ROI per frame over the window");
+        for (gint w = 0; w < AGG_WINDOWS; w++) {
+            g_string_append_printf(out, "roi_window_occupancy_mean{window=\"%um\"} %.3f\n",
+                                   view.windows[w].minutes, view.windows[w].occupancy_mean);
+        }
+        append_metric(out, "roi_window_occupancy_peak", "gauge",
+                      "Peak objects inside the ROI over the window");
+        for (gint w = 0; w < AGG_WINDOWS; w++) {
+            g_string_append_printf(out, "roi_window_occupancy_peak{window=\"%um\"} %u\n",
+                                   view.windows[w].minutes, view.windows[w].occupancy_peak);
+        }
+        append_metric(out, "roi_window_dwell_seconds", "summary",
+                      "Time spent inside the ROI by vehicles that left during the window");
+        for (gint w = 0; w < AGG_WINDOWS; w++) {
+            const AggWindowStats *s = &view.windows[w];
+            g_string_append_printf(out,
+                                   "roi_window_dwell_seconds{window=\"%um\",quantile=\"0.5\"} %.2f\n"
+                                   "roi_window_dwell_seconds{window=\"%um\",quantile=\"0.95\"} %.2f\n"
+                                   "roi_window_dwell_seconds_sum{window=\"%um\"} %.2f\n"
+                                   "roi_window_dwell_seconds_count{window=\"%um\"} %u\n",
+                                   s->minutes, s->dwell_p50, s->minutes, s->dwell_p95,
+                                   s->minutes, s->dwell_mean * s->visits, s->minutes, s->visits);
+        }
+    }
+
+    if (metrics->stage_timer) {
+        append_metric(out, "roi_stage_latency_seconds", "histogram",
+                      "Buffer latency from stage entry to stage exit");
+        for (gint s = 0; s < STAGE_COUNT; s++) {
+            const StageTiming *st = &metrics->stage_timer->stages[s];
+            if (!st->attached) continue;
+            gchar *labels = g_strdup_printf("stage=\"%s\"",
+                                            topology_stage_name((PipelineStage)s));
+            histogram_write_prometheus(&st->latency, out, "roi_stage_latency_seconds", labels);
+            g_free(labels);
+        }
+    }
+
+    guint num_queues = metrics->num_queues.load(std::memory_order_acquire);
+    if (num_queues > 0) {
+        append_metric(out, "roi_queue_level_buffers", "gauge", "Buffers waiting in each queue");
+        for (guint i = 0; i < num_queues; i++) {
+            guint level = 0;
+            g_object_get(G_OBJECT(metrics->queues[i].queue), "current-level-buffers", &level, NULL);
+            g_string_append_printf(out, "roi_queue_level_buffers{queue=\"%s\"} %u\n",
+                                   GST_ELEMENT_NAME(metrics->queues[i].queue), level);
+        }
+        append_metric(out, "roi_queue_capacity_buffers", "gauge", "Queue max-size-buffers");
+        for (guint i = 0; i < num_queues; i++) {
+            guint capacity = 0;
+            g_object_get(G_OBJECT(metrics->queues[i].queue), "max-size-buffers", &capacity, NULL);
+            g_string_append_printf(out, "roi_queue_capacity_buffers{queue=\"%s\"} %u\n",
+                                   GST_ELEMENT_NAME(metrics->queues[i].queue), capacity);
+        }
+        append_metric(out, "roi_dropped_frames_total", "counter",
+                      "Buffers dropped by leaky queues");
+        for (guint i = 0; i < num_queues; i++) {
+            if (!metrics->queues[i].leaky) continue;
+            g_string_append_printf(out, "roi_dropped_frames_total{queue=\"%s\"} %" G_GUINT64_FORMAT "\n",
+                                   GST_ELEMENT_NAME(metrics->queues[i].queue),
+                                   metrics->queues[i].overruns.load(std::memory_order_relaxed));
+        }
+    }
+
+    long rss_pages = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        if (fscanf(statm, "%*s %ld", &rss_pages) != 1) rss_pages = 0;
+        fclose(statm);
+    }
+    append_metric(out, "process_resident_memory_bytes", "gauge", "Resident set size");
+    g_string_append_printf(out, "process_resident_memory_bytes %ld\n",
+                           rss_pages * sysconf(_SC_PAGESIZE));
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    append_metric(out, "process_cpu_seconds_total", "counter", "User and system CPU time");
+    g_string_append_printf(out, "process_cpu_seconds_total %.3f\n",
+                           usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6);
+}
+
+// Lee la petición (se ignora la ruta) y responde siempre con las métricas
+static void serve_client(MetricsServer *metrics, int fd) {
+    gchar request[1024];
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 200) <= 0 || recv(fd, request, sizeof(request), 0) <= 0) return;
+
+    GString *body = g_string_new(NULL);
+    build_body(metrics, body);
+    gchar *header = g_strdup_printf("HTTP/1.0 200 OK\r\n"
+                                    "Content-Type: text/plain; version=0.0.4\r\n"
+                                    "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                                    "Connection: close\r\n\r\n", body->len);
+    g_string_prepend(body, header);
+    g_free(header);
+
+    gsize sent = 0;
+    while (sent < body->len) {
+        ssize_t n = send(fd, body->str + sent, body->len - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += (gsize)n;
+    }
+    g_string_free(body, TRUE);
+}
+
+static gpointer server_thread(gpointer data) {
+    MetricsServer *metrics = (MetricsServer *)data;
+    while (metrics->running.load(std::memory_order_acquire)) {
+        struct pollfd pfd = { metrics->listen_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        int client = accept(metrics->listen_fd, NULL, NULL);
+        if (client < 0) continue;
+        serve_client(metrics, client);
+        close(client);
+    }
+    return NULL;
+}
+
+gboolean metrics_init(MetricsServer *metrics, const gchar *endpoint) {
+    metrics->endpoint = g_strdup(endpoint);
+    metrics->unix_path = NULL;
+    metrics->thread = NULL;
+    metrics->frames.store(0);
+    metrics->objects.store(0);
+    metrics->tracks.store(0);
+    metrics->alerts.store(0);
+    metrics->active_tracks.store(0);
+    metrics->fps.store(0.0);
+    metrics->objects_rate.store(0.0);
+    metrics->tracks_rate.store(0.0);
+    metrics->alerts_rate.store(0.0);
+    metrics->window_start_ns = 0;
+    metrics->window_frames = 0;
+    metrics->window_objects = 0;
+    metrics->window_tracks_start = 0;
+    metrics->window_alerts_start = 0;
+    metrics->num_queues.store(0);
+    metrics->stage_timer = NULL;
+    metrics->aggregates = NULL;
+
+    metrics->listen_fd = open_endpoint(metrics, endpoint);
+    if (metrics->listen_fd < 0) {
+        g_printerr("Metrics: could not listen on '%s': %s\n", endpoint, strerror(errno));
+        return FALSE;
+    }
+    metrics->running.store(true, std::memory_order_release);
+    metrics->thread = g_thread_new("metrics", server_thread, metrics);
+    g_print("Metrics endpoint: %s\n", endpoint);
+    return TRUE;
+}
+
+// Cada overrun de un queue leaky es un buffer descartado
+static void on_queue_overrun(GstElement *queue, gpointer data) {
+    MetricsQueue *mq = (MetricsQueue *)data;
+    mq->overruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void metrics_watch_queue(MetricsServer *metrics, GstElement *queue) {
+    guint n = metrics->num_queues.load(std::memory_order_relaxed);
+    if (n >= METRICS_MAX_QUEUES) return;
+    for (guint i = 0; i < n; i++) {
+        if (metrics->queues[i].queue == queue) return;
+    }
+
+    MetricsQueue *mq = &metrics->queues[n];
+    gint leaky = 0;
+    g_object_get(G_OBJECT(queue), "leaky", &leaky, NULL);
+    mq->queue = (GstElement *)gst_object_ref(queue);
+    mq->leaky = leaky != 0;
+    mq->overruns.store(0, std::memory_order_relaxed);
+    if (mq->leaky) {
+        g_signal_connect(queue, "overrun", G_CALLBACK(on_queue_overrun), mq);
+    }
+    metrics->num_queues.store(n + 1, std::memory_order_release);
+}
+
+void metrics_attach(MetricsServer *metrics, GstElement *pipeline,
+                    const StageTimer *stage_timer, const Aggregates *aggregates) {
+    metrics->stage_timer = stage_timer;
+    metrics->aggregates = aggregates;
+
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN(pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+        GstElement *elem = GST_ELEMENT(g_value_get_object(&item));
+        GstElementFactory *factory = gst_element_get_factory(elem);
+        if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "queue") == 0) {
+            metrics_watch_queue(metrics, elem);
+        }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+}
+
+void metrics_on_frame(MetricsServer *metrics, guint objects, guint64 total_tracks,
+                      guint64 total_alerts, guint64 active_tracks) {
+    metrics->frames.fetch_add(1, std::memory_order_relaxed);
+    metrics->objects.fetch_add(objects, std::memory_order_relaxed);
+    metrics->tracks.store(total_tracks, std::memory_order_relaxed);
+    metrics->alerts.store(total_alerts, std::memory_order_relaxed);
+    metrics->active_tracks.store(active_tracks, std::memory_order_relaxed);
+
+    guint64 now = monotonic_ns();
+    if (metrics->window_start_ns == 0) {
+        metrics->window_start_ns = now;
+        metrics->window_tracks_start = total_tracks;
+        metrics->window_alerts_start = total_alerts;
+    }
+    metrics->window_frames++;
+    metrics->window_objects += objects;
+
+    guint64 elapsed = now - metrics->window_start_ns;
+    if (elapsed >= 1000000000ULL) {
+        gdouble seconds = elapsed / 1e9;
+        metrics->fps.store(metrics->window_frames / seconds, std::memory_order_relaxed);
+        metrics->objects_rate.store(metrics->window_objects / seconds, std::memory_order_relaxed);
+        metrics->tracks_rate.store((total_tracks - metrics->window_tracks_start) / seconds,
+                                   std::memory_order_relaxed);
+        metrics->alerts_rate.store((total_alerts - metrics->window_alerts_start) / seconds,
+                                   std::memory_order_relaxed);
+        metrics->window_start_ns = now;
+        metrics->window_frames = 0;
+        metrics->window_objects = 0;
+        metrics->window_tracks_start = total_tracks;
+        metrics->window_alerts_start = total_alerts;
+    }
+}
+
+void metrics_destroy(MetricsServer *metrics) {
+    if (metrics->thread) {
+        metrics->running.store(false, std::memory_order_release);
+        g_thread_join(metrics->thread);
+        metrics->thread = NULL;
+    }
+    if (metrics->listen_fd >= 0) close(metrics->listen_fd);
+    metrics->listen_fd = -1;
+    if (metrics->unix_path) unlink(metrics->unix_path);
+
+    guint n = metrics->num_queues.load(std::memory_order_relaxed);
+    for (guint i = 0; i < n; i++) gst_object_unref(metrics->queues[i].queue);
+    metrics->num_queues.store(0);
+
+    g_free(metrics->unix_path);
+    g_free(metrics->endpoint);
+    metrics->unix_path = NULL;
+    metrics->endpoint = NULL;
+}
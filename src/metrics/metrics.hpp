@@ -0,0 +1,78 @@
+/*
+ * metrics.hpp
+ * Endpoint de métricas en formato de texto de Prometheus
+ *
+ * Un hilo propio atiende HTTP por TCP (--metrics 9100 o 127.0.0.1:9100) o
+ * por socket Unix (--metrics unix:/tmp/roi.sock). El hilo del OSD solo
+ * actualiza contadores atómicos; el scrape lee esos valores, los
+ * histogramas de latencia por etapa, el nivel de los queues y RSS/CPU.
+ */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include <atomic>
+#include "pipeline/stage_timing.hpp"
+#include "analytics/aggregates.hpp"
+
+#define METRICS_MAX_QUEUES 24
+
+// Queue observado (nivel y descartes por desborde)
+struct MetricsQueue {
+    GstElement *queue;
+    gboolean leaky;
+    std::atomic<guint64> overruns;   // Buffers descartados si es leaky
+};
+
+struct MetricsServer {
+    gchar *endpoint;
+    gchar *unix_path;        // Socket Unix a borrar al cerrar (o NULL)
+    int listen_fd;
+    GThread *thread;
+    std::atomic<bool> running;
+
+    // Escritos por el hilo del OSD
+    std::atomic<guint64> frames;
+    std::atomic<guint64> objects;
+    std::atomic<guint64> tracks;
+    std::atomic<guint64> alerts;
+    std::atomic<guint64> active_tracks;
+    std::atomic<double> fps;
+    std::atomic<double> objects_rate;
+    std::atomic<double> tracks_rate;
+    std::atomic<double> alerts_rate;
+
+    // Ventana de un segundo para las tasas (solo el hilo del OSD)
+    guint64 window_start_ns;
+    guint64 window_frames;
+    guint64 window_objects;
+    guint64 window_tracks_start;   // Totales al inicio de la ventana
+    guint64 window_alerts_start;
+
+    MetricsQueue queues[METRICS_MAX_QUEUES];
+    std::atomic<guint> num_queues;
+    const StageTimer *stage_timer;
+    const Aggregates *aggregates;  // Ventanas deslizantes (o NULL)
+};
+
+// Abre el endpoint e inicia el hilo del servidor
+gboolean metrics_init(MetricsServer *metrics, const gchar *endpoint);
+
+// Registra los queues del pipeline, los histogramas por etapa y las
+// ventanas deslizantes (stage_timer y aggregates pueden ser NULL)
+void metrics_attach(MetricsServer *metrics, GstElement *pipeline,
+                    const StageTimer *stage_timer, const Aggregates *aggregates);
+
+// Registra un queue creado fuera del bin (p.ej. el de decodificación)
+void metrics_watch_queue(MetricsServer *metrics, GstElement *queue);
+
+// Una vez por frame desde el probe del OSD
+void metrics_on_frame(MetricsServer *metrics, guint objects, guint64 total_tracks,
+                      guint64 total_alerts, guint64 active_tracks);
+
+// Detiene el hilo y cierra el endpoint
+void metrics_destroy(MetricsServer *metrics);
+
+#endif // METRICS_HPP
@@ -0,0 +1,341 @@
+/*
+ * resources.cpp
+ * Implementación del muestreo de recursos
+ */
+
+#include "resources.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#define RESOURCE_FLUSH_SAMPLES 16
+
+// Dispositivos GPU de Jetson: Nano/TX1, TX2, Xavier, Orin
+static const gchar *GPU_DEVICES[] = {
+    "/sys/devices/gpu.0",
+    "/sys/devices/17000000.gp10b",
+    "/sys/devices/17000000.gv11b",
+    "/sys/devices/17000000.ga10b",
+    NULL
+};
+
+static const gchar *EMC_RATE_PATHS[] = {
+    "/sys/kernel/debug/bpmp/debug/clk/emc/rate",   // Xavier/Orin
+    "/sys/kernel/debug/clk/emc/clk_rate",          // Nano/TX
+    NULL
+};
+
+static gboolean read_u64(const gchar *path, guint64 *value) {
+    if (!path) return FALSE;
+    FILE *f = fopen(path, "r");
+    if (!f) return FALSE;
+    unsigned long long v = 0;
+    gboolean ok = fscanf(f, "%llu", &v) == 1;
+    fclose(f);
+    if (ok) *value = v;
+    return ok;
+}
+
+static gchar *first_readable(const gchar *const *paths) {
+    guint64 v;
+    for (gint i = 0; paths[i]; i++) {
+        if (read_u64(paths[i], &v)) return g_strdup(paths[i]);
+    }
+    return NULL;
+}
+
+static void detect_jetson_counters(ResourceSampler *sampler) {
+    guint64 v;
+    for (gint i = 0; GPU_DEVICES[i] && !sampler->gpu_load_path; i++) {
+        gchar *load = g_strdup_printf("%s/load", GPU_DEVICES[i]);
+        if (!read_u64(load, &v)) {
+            g_free(load);
+            continue;
+        }
+        sampler->gpu_load_path = load;
+
+        // devfreq/<nombre>/cur_freq (el nombre cambia entre módulos)
+        gchar *devfreq = g_strdup_printf("%s/devfreq", GPU_DEVICES[i]);
+        GDir *dir = g_dir_open(devfreq, 0, NULL);
+        const gchar *entry;
+        while (dir && !sampler->gpu_freq_path && (entry = g_dir_read_name(dir)) != NULL) {
+            gchar *freq = g_strdup_printf("%s/%s/cur_freq", devfreq, entry);
+            if (read_u64(freq, &v)) sampler->gpu_freq_path = freq;
+            else g_free(freq);
+        }
+        if (dir) g_dir_close(dir);
+        g_free(devfreq);
+    }
+
+    sampler->emc_rate_path = first_readable(EMC_RATE_PATHS);
+    const gchar *activity[] = { "/sys/kernel/actmon_avg_activity/mc_all", NULL };
+    sampler->emc_activity_path = first_readable(activity);
+}
+
+static gdouble process_cpu_seconds(void) {
+    gchar *contents = NULL;
+    gdouble cpu_s = 0.0;
+    if (!g_file_get_contents("/proc/self/stat", &contents, NULL, NULL)) return cpu_s;
+    gchar *close = strrchr(contents, ')');
+    unsigned long utime = 0, stime = 0;
+    if (close && sscanf(close + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                        &utime, &stime) == 2) {
+        cpu_s = (utime + stime) / (gdouble)sysconf(_SC_CLK_TCK);
+    }
+    g_free(contents);
+    return cpu_s;
+}
+
+// VmRSS, VmHWM, Threads y cambios de contexto de /proc/self/status
+static void read_status(ResourceSample *sample) {
+    gchar *contents = NULL;
+    if (!g_file_get_contents("/proc/self/status", &contents, NULL, NULL)) return;
+    gchar **lines = g_strsplit(contents, "\n", -1);
+    for (gint i = 0; lines[i]; i++) {
+        unsigned long long v;
+        if (sscanf(lines[i], "VmRSS: %llu", &v) == 1) sample->rss_kb = v;
+        else if (sscanf(lines[i], "VmHWM: %llu", &v) == 1) sample->hwm_kb = v;
+        else if (sscanf(lines[i], "Threads: %llu", &v) == 1) sample->threads = (guint)v;
+        else if (sscanf(lines[i], "voluntary_ctxt_switches: %llu", &v) == 1) sample->ctxsw_voluntary = v;
+        else if (sscanf(lines[i], "nonvoluntary_ctxt_switches: %llu", &v) == 1) sample->ctxsw_involuntary = v;
+    }
+    g_strfreev(lines);
+    g_free(contents);
+}
+
+// CPU acumulada de cada hilo vivo (campos 14 y 15 de task/<tid>/stat)
+static void sample_threads(ResourceSampler *sampler, gdouble t_s) {
+    GDir *dir = g_dir_open("/proc/self/task", 0, NULL);
+    if (!dir) return;
+    gdouble ticks = (gdouble)sysconf(_SC_CLK_TCK);
+    const gchar *tid;
+    while ((tid = g_dir_read_name(dir)) != NULL) {
+        gchar *path = g_strdup_printf("/proc/self/task/%s/stat", tid);
+        gchar *contents = NULL;
+        if (g_file_get_contents(path, &contents, NULL, NULL)) {
+            gchar *open = strchr(contents, '(');
+            gchar *close = strrchr(contents, ')');
+            unsigned long utime = 0, stime = 0;
+            if (open && close && close > open &&
+                sscanf(close + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                       &utime, &stime) == 2) {
+                gdouble cpu_s = (utime + stime) / ticks;
+                guint32 id = (guint32)atoi(tid);
+                auto it = sampler->thread_usage.find(id);
+                if (it == sampler->thread_usage.end()) {
+                    ThreadUsage usage;
+                    usage.name.assign(open + 1, close - open - 1);
+                    usage.first_t_s = t_s;
+                    usage.first_cpu_s = cpu_s;
+                    it = sampler->thread_usage.emplace(id, usage).first;
+                }
+                it->second.last_t_s = t_s;
+                it->second.last_cpu_s = cpu_s;
+            }
+            g_free(contents);
+        }
+        g_free(path);
+    }
+    g_dir_close(dir);
+}
+
+static void take_sample(ResourceSampler *sampler) {
+    ResourceSample *sample = &sampler->ring[sampler->head % RESOURCE_RING_SAMPLES];
+    memset(sample, 0, sizeof(*sample));
+    sample->t_s = (g_get_monotonic_time() - sampler->start_us) / 1e6;
+    sample->pts = sampler->last_pts.load(std::memory_order_relaxed);
+    sample->frames = sampler->frames.load(std::memory_order_relaxed);
+
+    gdouble cpu_s = process_cpu_seconds();
+    gdouble dt = sample->t_s - sampler->prev_t_s;
+    sample->cpu_pct = dt > 0.0 ? 100.0 * (cpu_s - sampler->prev_cpu_s) / dt : 0.0;
+    sampler->prev_t_s = sample->t_s;
+    sampler->prev_cpu_s = cpu_s;
+    read_status(sample);
+    sample_threads(sampler, sample->t_s);
+
+    // GPU: load en décimas de %; frecuencias en Hz; actividad EMC en kHz
+    guint64 v, rate;
+    sample->gpu_load_pct = read_u64(sampler->gpu_load_path, &v) ? v / 10.0 : -1.0;
+    sample->gpu_freq_mhz = read_u64(sampler->gpu_freq_path, &v) ? (gint)(v / 1000000) : -1;
+    sample->emc_freq_mhz = -1;
+    sample->emc_load_pct = -1.0;
+    if (read_u64(sampler->emc_rate_path, &rate) && rate > 0) {
+        sample->emc_freq_mhz = (gint)(rate / 1000000);
+        if (read_u64(sampler->emc_activity_path, &v)) {
+            sample->emc_load_pct = 100.0 * v / (rate / 1000.0);
+        }
+    }
+
+    sampler->samples++;
+    sampler->peak_rss_kb = MAX(sampler->peak_rss_kb, MAX(sample->rss_kb, sample->hwm_kb));
+    sampler->cpu_s = cpu_s - sampler->start_cpu_s;
+    sampler->wall_s = sample->t_s;
+    if (sample->gpu_load_pct >= 0.0) {
+        sampler->gpu_load_sum += sample->gpu_load_pct;
+        sampler->gpu_samples++;
+    }
+    sampler->head++;
+}
+
+static void flush_samples(ResourceSampler *sampler) {
+    // Si el CSV se atrasó más que el anillo, se pierden las más viejas
+    if (sampler->head - sampler->flushed > RESOURCE_RING_SAMPLES) {
+        sampler->flushed = sampler->head - RESOURCE_RING_SAMPLES;
+    }
+    for (; sampler->flushed < sampler->head; sampler->flushed++) {
+        const ResourceSample *s = &sampler->ring[sampler->flushed % RESOURCE_RING_SAMPLES];
+        if (!sampler->csv) continue;
+        fprintf(sampler->csv, "%.3f,", s->t_s);
+        if (GST_CLOCK_TIME_IS_VALID(s->pts)) fprintf(sampler->csv, "%.3f", s->pts / 1e9);
+        fprintf(sampler->csv, ",%" G_GUINT64_FORMAT ",%" G_GUINT64_FORMAT ",%" G_GUINT64_FORMAT
+                              ",%.1f,%u,%" G_GUINT64_FORMAT ",%" G_GUINT64_FORMAT ",",
+                s->frames, s->rss_kb, s->hwm_kb, s->cpu_pct, s->threads,
+                s->ctxsw_voluntary, s->ctxsw_involuntary);
+        if (s->gpu_load_pct >= 0.0) fprintf(sampler->csv, "%.1f", s->gpu_load_pct);
+        fprintf(sampler->csv, ",");
+        if (s->gpu_freq_mhz >= 0) fprintf(sampler->csv, "%d", s->gpu_freq_mhz);
+        fprintf(sampler->csv, ",");
+        if (s->emc_freq_mhz >= 0) fprintf(sampler->csv, "%d", s->emc_freq_mhz);
+        fprintf(sampler->csv, ",");
+        if (s->emc_load_pct >= 0.0) fprintf(sampler->csv, "%.1f", s->emc_load_pct);
+        fprintf(sampler->csv, "\n");
+    }
+    if (sampler->csv) fflush(sampler->csv);
+}
+
+static gpointer sampler_thread(gpointer data) {
+    ResourceSampler *sampler = (ResourceSampler *)data;
+    g_mutex_lock(&sampler->lock);
+    while (sampler->running) {
+        gint64 deadline = g_get_monotonic_time() + sampler->interval_ms * G_TIME_SPAN_MILLISECOND;
+        while (sampler->running &&
+               g_cond_wait_until(&sampler->cond, &sampler->lock, deadline)) {
+        }
+        if (!sampler->running) break;
+        g_mutex_unlock(&sampler->lock);
+
+        take_sample(sampler);
+        if (sampler->head - sampler->flushed >= RESOURCE_FLUSH_SAMPLES) {
+            flush_samples(sampler);
+        }
+        g_mutex_lock(&sampler->lock);
+    }
+    g_mutex_unlock(&sampler->lock);
+    return NULL;
+}
+
+gboolean resource_sampler_init(ResourceSampler *sampler, const gchar *csv_path,
+                               guint interval_ms) {
+    sampler->csv_path = g_strdup(csv_path);
+    sampler->interval_ms = interval_ms > 0 ? interval_ms : RESOURCE_DEFAULT_INTERVAL_MS;
+    sampler->thread = NULL;
+    g_mutex_init(&sampler->lock);
+    g_cond_init(&sampler->cond);
+    sampler->running = FALSE;
+    sampler->head = 0;
+    sampler->flushed = 0;
+    sampler->last_pts.store(GST_CLOCK_TIME_NONE, std::memory_order_relaxed);
+    sampler->frames.store(0, std::memory_order_relaxed);
+    sampler->gpu_load_path = NULL;
+    sampler->gpu_freq_path = NULL;
+    sampler->emc_rate_path = NULL;
+    sampler->emc_activity_path = NULL;
+    sampler->samples = 0;
+    sampler->peak_rss_kb = 0;
+    sampler->cpu_s = 0.0;
+    sampler->wall_s = 0.0;
+    sampler->gpu_load_sum = 0.0;
+    sampler->gpu_samples = 0;
+    sampler->thread_usage.clear();
+
+    sampler->csv = fopen(csv_path, "w");
+    if (!sampler->csv) {
+        g_printerr("Resources: could not open %s\n", csv_path);
+        return FALSE;
+    }
+    fprintf(sampler->csv, "t_s,pts_s,frames,rss_kb,hwm_kb,cpu_pct,threads,ctxsw_voluntary,"
+                          "ctxsw_involuntary,gpu_load_pct,gpu_freq_mhz,emc_freq_mhz,emc_load_pct\n");
+
+    detect_jetson_counters(sampler);
+    g_print("Resource sampling every %u ms -> %s (GPU: %s, EMC: %s)\n",
+            sampler->interval_ms, csv_path,
+            sampler->gpu_load_path ? sampler->gpu_load_path : "n/a",
+            sampler->emc_rate_path ? sampler->emc_rate_path : "n/a");
+
+    sampler->start_us = g_get_monotonic_time();
+    sampler->start_cpu_s = process_cpu_seconds();
+    sampler->prev_t_s = 0.0;
+    sampler->prev_cpu_s = sampler->start_cpu_s;
+    sampler->running = TRUE;
+    sampler->thread = g_thread_new("resources", sampler_thread, sampler);
+    return TRUE;
+}
+
+void resource_sampler_stop(ResourceSampler *sampler) {
+    if (!sampler->thread) return;
+    g_mutex_lock(&sampler->lock);
+    sampler->running = FALSE;
+    g_cond_signal(&sampler->cond);
+    g_mutex_unlock(&sampler->lock);
+    g_thread_join(sampler->thread);
+    sampler->thread = NULL;
+
+    take_sample(sampler);
+    flush_samples(sampler);
+}
+
+guint resource_sampler_top_threads(const ResourceSampler *sampler, guint max_threads,
+                                   const gchar **names, gdouble *cpu_pct) {
+    std::vector<std::pair<gdouble, const ThreadUsage *>> usage;
+    for (const auto &pair : sampler->thread_usage) {
+        const ThreadUsage &t = pair.second;
+        gdouble dt = t.last_t_s - t.first_t_s;
+        if (dt <= 0.0) continue;
+        usage.push_back(std::make_pair(100.0 * (t.last_cpu_s - t.first_cpu_s) / dt, &t));
+    }
+    std::sort(usage.begin(), usage.end(),
+              [](const std::pair<gdouble, const ThreadUsage *> &a,
+                 const std::pair<gdouble, const ThreadUsage *> &b) { return a.first > b.first; });
+
+    guint n = 0;
+    for (; n < usage.size() && n < max_threads; n++) {
+        names[n] = usage[n].second->name.c_str();
+        cpu_pct[n] = usage[n].first;
+    }
+    return n;
+}
+
+void resource_sampler_print_summary(ResourceSampler *sampler) {
+    const gchar *names[6];
+    gdouble cpu[6];
+    guint n = resource_sampler_top_threads(sampler, 6, names, cpu);
+
+    g_print("Resources: peak RSS %.1f MB, mean CPU %.0f%% over %.1f s",
+            sampler->peak_rss_kb / 1024.0,
+            sampler->wall_s > 0.0 ? 100.0 * sampler->cpu_s / sampler->wall_s : 0.0,
+            sampler->wall_s);
+    if (sampler->gpu_samples > 0) {
+        g_print(", mean GPU %.0f%%", sampler->gpu_load_sum / sampler->gpu_samples);
+    }
+    g_print("\n");
+    for (guint i = 0; i < n; i++) {
+        g_print("  %-16s %6.1f%%\n", names[i], cpu[i]);
+    }
+}
+
+void resource_sampler_destroy(ResourceSampler *sampler) {
+    resource_sampler_stop(sampler);
+    if (sampler->csv) fclose(sampler->csv);
+    sampler->csv = NULL;
+    g_mutex_clear(&sampler->lock);
+    g_cond_clear(&sampler->cond);
+    g_free(sampler->gpu_load_path);
+    g_free(sampler->gpu_freq_path);
+    g_free(sampler->emc_rate_path);
+    g_free(sampler->emc_activity_path);
+    g_free(sampler->csv_path);
+    sampler->thread_usage.clear();
+}
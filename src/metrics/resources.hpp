@@ -0,0 +1,111 @@
+/*
+ * resources.hpp
+ * Muestreo de recursos dentro del proceso (reemplaza a tegrastats)
+ *
+ * Un hilo lee /proc/self/stat, /proc/self/status, la CPU de cada hilo
+ * (/proc/self/task) y, si existen, los contadores de GPU y EMC de Jetson en
+ * sysfs/debugfs. Las muestras van a un anillo en memoria que el mismo hilo
+ * vacía al CSV por lotes; cada muestra lleva el último PTS procesado por el
+ * OSD para alinearla con el video, el reporte y las trazas.
+ */
+
+#ifndef RESOURCES_HPP
+#define RESOURCES_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include <stdio.h>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+
+#define RESOURCE_RING_SAMPLES 256
+#define RESOURCE_DEFAULT_INTERVAL_MS 500
+
+struct ResourceSample {
+    gdouble t_s;              // Segundos desde el inicio del muestreo
+    GstClockTime pts;         // Último PTS procesado (NONE si aún no hay)
+    guint64 frames;
+    guint64 rss_kb;
+    guint64 hwm_kb;           // Pico de RSS (VmHWM)
+    gdouble cpu_pct;          // Proceso, en % de un núcleo
+    guint threads;
+    guint64 ctxsw_voluntary;
+    guint64 ctxsw_involuntary;
+    gdouble gpu_load_pct;     // < 0 si no hay GPU Jetson
+    gint gpu_freq_mhz;        // < 0 si no se conoce
+    gint emc_freq_mhz;        // < 0 si no se conoce
+    gdouble emc_load_pct;     // < 0 si no se conoce
+};
+
+// CPU acumulada de un hilo entre la primera y la última muestra
+struct ThreadUsage {
+    std::string name;
+    gdouble first_t_s;
+    gdouble first_cpu_s;
+    gdouble last_t_s;
+    gdouble last_cpu_s;
+};
+
+struct ResourceSampler {
+    gchar *csv_path;
+    FILE *csv;
+    guint interval_ms;
+
+    GThread *thread;
+    GMutex lock;
+    GCond cond;
+    gboolean running;         // Protegido por lock
+
+    // Anillo de muestras: escribe y vacía solo el hilo del muestreo
+    ResourceSample ring[RESOURCE_RING_SAMPLES];
+    guint64 head;
+    guint64 flushed;
+
+    // Escritos por el probe del OSD
+    std::atomic<guint64> last_pts;
+    std::atomic<guint64> frames;
+
+    // Rutas de Jetson detectadas al iniciar (NULL si no existen)
+    gchar *gpu_load_path;
+    gchar *gpu_freq_path;
+    gchar *emc_rate_path;
+    gchar *emc_activity_path;
+
+    // Resumen (válido después de resource_sampler_stop)
+    gint64 start_us;
+    gdouble start_cpu_s;
+    gdouble prev_t_s;
+    gdouble prev_cpu_s;
+    guint64 samples;
+    guint64 peak_rss_kb;
+    gdouble cpu_s;            // CPU del proceso durante el muestreo
+    gdouble wall_s;
+    gdouble gpu_load_sum;
+    guint64 gpu_samples;
+    std::unordered_map<guint32, ThreadUsage> thread_usage;
+};
+
+// Abre el CSV, detecta los contadores disponibles e inicia el hilo
+gboolean resource_sampler_init(ResourceSampler *sampler, const gchar *csv_path,
+                               guint interval_ms);
+
+// Desde el probe del OSD: PTS del frame recién procesado
+static inline void resource_sampler_note_frame(ResourceSampler *sampler, GstClockTime pts) {
+    sampler->last_pts.store(pts, std::memory_order_relaxed);
+    sampler->frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Toma una última muestra, detiene el hilo y vacía el anillo (idempotente)
+void resource_sampler_stop(ResourceSampler *sampler);
+
+// Imprime el resumen (pico de RSS, CPU media del proceso y por hilo)
+void resource_sampler_print_summary(ResourceSampler *sampler);
+
+// Hilos ordenados por CPU media (% de un núcleo); como máximo max_threads
+guint resource_sampler_top_threads(const ResourceSampler *sampler, guint max_threads,
+                                   const gchar **names, gdouble *cpu_pct);
+
+void resource_sampler_destroy(ResourceSampler *sampler);
+
+#endif // RESOURCES_HPP
@@ -0,0 +1,283 @@
+/*
+ * trace.cpp
+ * Implementación de las trazas Chrome trace / Perfetto
+ */
+
+#include "trace.hpp"
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+Tracer *g_tracer = NULL;
+
+static thread_local TraceThreadBuffer *tls_buffer = NULL;
+static thread_local Tracer *tls_owner = NULL;
+static thread_local guint32 tls_tid = 0;
+
+guint64 trace_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000ULL + (guint64)ts.tv_nsec;
+}
+
+static guint32 current_tid(void) {
+    if (G_UNLIKELY(tls_tid == 0)) tls_tid = (guint32)syscall(SYS_gettid);
+    return tls_tid;
+}
+
+// Anillo del hilo actual; se crea y se publica en la lista la primera vez
+static TraceThreadBuffer *thread_buffer(Tracer *tracer) {
+    if (G_LIKELY(tls_owner == tracer)) return tls_buffer;
+
+    TraceThreadBuffer *buf = g_new0(TraceThreadBuffer, 1);
+    buf->tid = current_tid();
+    if (pthread_getname_np(pthread_self(), buf->name, sizeof(buf->name)) != 0) {
+        g_snprintf(buf->name, sizeof(buf->name), "thread-%u", buf->tid);
+    }
+    buf->capacity = tracer->capacity;
+    buf->events = g_new0(TraceEvent, buf->capacity);
+    buf->head.store(0, std::memory_order_relaxed);
+
+    TraceThreadBuffer *head = tracer->threads.load(std::memory_order_relaxed);
+    do {
+        buf->next = head;
+    } while (!tracer->threads.compare_exchange_weak(head, buf, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+    tls_buffer = buf;
+    tls_owner = tracer;
+    return buf;
+}
+
+static void record(Tracer *tracer, const gchar *name, GstClockTime frame,
+                   guint64 start_ns, guint64 end_ns, guint32 begin_tid, TraceKind kind) {
+    TraceThreadBuffer *buf = thread_buffer(tracer);
+    guint64 n = buf->head.load(std::memory_order_relaxed);
+    TraceEvent *ev = &buf->events[n % buf->capacity];
+    ev->start_ns = start_ns;
+    ev->end_ns = end_ns;
+    ev->frame = frame;
+    ev->name = name;
+    ev->begin_tid = begin_tid;
+    ev->kind = kind;
+    buf->head.store(n + 1, std::memory_order_release);
+}
+
+void trace_record_slice(Tracer *tracer, const gchar *name, GstClockTime frame,
+                        guint64 start_ns, guint64 end_ns) {
+    record(tracer, name, frame, start_ns, end_ns, current_tid(), TRACE_SECTION);
+}
+
+void trace_init(Tracer *tracer, const gchar *path, guint32 events_per_thread) {
+    tracer->path = g_strdup(path);
+    tracer->capacity = events_per_thread > 0 ? events_per_thread : TRACE_DEFAULT_EVENTS;
+    tracer->start_ns = trace_clock_ns();
+    tracer->threads.store(NULL, std::memory_order_relaxed);
+    g_mutex_init(&tracer->elements_lock);
+    tracer->elements = g_ptr_array_new();
+    g_tracer = tracer;
+    g_print("Tracing to %s (%u events per thread)\n", path, tracer->capacity);
+}
+
+static GstPadProbeReturn trace_enter_probe(GstPad *pad, GstPadProbeInfo *info,
+                                           gpointer u_data) {
+    TraceElement *te = (TraceElement *)u_data;
+    GstClockTime pts = GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info));
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return GST_PAD_PROBE_OK;
+
+    guint32 idx = te->next_slot.fetch_add(1, std::memory_order_relaxed) % TRACE_ELEMENT_SLOTS;
+    te->slots[idx].enter_ns.store(trace_clock_ns(), std::memory_order_relaxed);
+    te->slots[idx].tid.store(current_tid(), std::memory_order_relaxed);
+    te->slots[idx].pts.store(pts, std::memory_order_release);
+    return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn trace_exit_probe(GstPad *pad, GstPadProbeInfo *info,
+                                          gpointer u_data) {
+    TraceElement *te = (TraceElement *)u_data;
+    Tracer *tracer = g_tracer;
+    GstClockTime pts = GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info));
+    if (!tracer || !GST_CLOCK_TIME_IS_VALID(pts)) return GST_PAD_PROBE_OK;
+
+    guint64 now = trace_clock_ns();
+    for (gint i = 0; i < TRACE_ELEMENT_SLOTS; i++) {
+        if (te->slots[i].pts.load(std::memory_order_acquire) != pts) continue;
+        guint64 enter = te->slots[i].enter_ns.load(std::memory_order_relaxed);
+        guint32 tid = te->slots[i].tid.load(std::memory_order_relaxed);
+        te->slots[i].pts.store(GST_CLOCK_TIME_NONE, std::memory_order_relaxed);
+        if (enter == 0 || enter > now) break;
+        record(tracer, te->name, pts, enter, now, tid,
+               tid == current_tid() ? TRACE_SLICE : TRACE_ASYNC);
+        break;
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+// Solo elementos simples con pads estáticos "sink" y "src": los bins
+// (parsebin) se recorren por dentro y los tee/muxers no tienen un par único
+static void attach_element(Tracer *tracer, GstElement *elem) {
+    if (GST_IS_BIN(elem)) return;
+    GstPad *sink = gst_element_get_static_pad(elem, "sink");
+    GstPad *src = gst_element_get_static_pad(elem, "src");
+    if (sink && src) {
+        TraceElement *te = g_new0(TraceElement, 1);
+        te->name = g_strdup(GST_ELEMENT_NAME(elem));
+        for (gint i = 0; i < TRACE_ELEMENT_SLOTS; i++) {
+            te->slots[i].pts.store(GST_CLOCK_TIME_NONE, std::memory_order_relaxed);
+            te->slots[i].enter_ns.store(0, std::memory_order_relaxed);
+            te->slots[i].tid.store(0, std::memory_order_relaxed);
+        }
+        te->next_slot.store(0, std::memory_order_relaxed);
+
+        g_mutex_lock(&tracer->elements_lock);
+        g_ptr_array_add(tracer->elements, te);
+        g_mutex_unlock(&tracer->elements_lock);
+
+        gst_pad_add_probe(sink, GST_PAD_PROBE_TYPE_BUFFER, trace_enter_probe, te, NULL);
+        gst_pad_add_probe(src, GST_PAD_PROBE_TYPE_BUFFER, trace_exit_probe, te, NULL);
+    }
+    if (sink) gst_object_unref(sink);
+    if (src) gst_object_unref(src);
+}
+
+// Elementos creados al detectar el stream (decoder, parser, depayloader)
+static void on_deep_element_added(GstBin *bin, GstBin *sub_bin, GstElement *element,
+                                  gpointer user_data) {
+    attach_element((Tracer *)user_data, element);
+}
+
+void trace_attach(Tracer *tracer, GstElement *pipeline) {
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN(pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+        attach_element(tracer, GST_ELEMENT(g_value_get_object(&item)));
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+
+    g_signal_connect(pipeline, "deep-element-added", G_CALLBACK(on_deep_element_added), tracer);
+}
+
+// Nombres de hilos y elementos sin comillas ni barras invertidas
+static void write_name(FILE *f, const gchar *name) {
+    for (const gchar *c = name; *c; c++) {
+        fputc(*c == '"' || *c == '\\' || (guchar)*c < 0x20 ? '_' : *c, f);
+    }
+}
+
+struct TraceRef {
+    const TraceEvent *ev;
+    guint32 tid;
+};
+
+gboolean trace_write(Tracer *tracer) {
+    FILE *f = fopen(tracer->path, "w");
+    if (!f) {
+        g_printerr("Trace: could not write %s\n", tracer->path);
+        return FALSE;
+    }
+    int pid = (int)getpid();
+    guint64 t0 = tracer->start_ns;
+    auto us = [t0](guint64 ns) { return ns > t0 ? (ns - t0) / 1000.0 : 0.0; };
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"ph\":\"M\",\"pid\":%d,\"name\":\"process_name\",\"args\":{\"name\":\"roi_surveillance\"}}", pid);
+
+    std::vector<TraceRef> slices;
+    guint64 total = 0, overwritten = 0;
+    guint threads = 0;
+    for (TraceThreadBuffer *buf = tracer->threads.load(std::memory_order_acquire);
+         buf; buf = buf->next) {
+        threads++;
+        fprintf(f, ",\n{\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"name\":\"thread_name\","
+                   "\"args\":{\"name\":\"", pid, buf->tid);
+        write_name(f, buf->name);
+        fprintf(f, "\"}}");
+
+        guint64 n = buf->head.load(std::memory_order_acquire);
+        guint64 first = n > buf->capacity ? n - buf->capacity : 0;
+        overwritten += first;
+        for (guint64 i = first; i < n; i++) {
+            const TraceEvent *ev = &buf->events[i % buf->capacity];
+            total++;
+            if (ev->kind == TRACE_ASYNC) {
+                // Intervalo que cruza hilos: par b/e asociado por PTS
+                fprintf(f, ",\n{\"ph\":\"b\",\"cat\":\"handoff\",\"name\":\"");
+                write_name(f, ev->name);
+                fprintf(f, "\",\"id\":\"0x%" G_GINT64_MODIFIER "x\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u}",
+                        ev->frame, us(ev->start_ns), pid, ev->begin_tid);
+                fprintf(f, ",\n{\"ph\":\"e\",\"cat\":\"handoff\",\"name\":\"");
+                write_name(f, ev->name);
+                fprintf(f, "\",\"id\":\"0x%" G_GINT64_MODIFIER "x\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u}",
+                        ev->frame, us(ev->end_ns), pid, buf->tid);
+                continue;
+            }
+            fprintf(f, ",\n{\"ph\":\"X\",\"cat\":\"%s\",\"name\":\"",
+                    ev->kind == TRACE_SECTION ? "section" : "element");
+            write_name(f, ev->name);
+            fprintf(f, "\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u",
+                    us(ev->start_ns), (ev->end_ns - ev->start_ns) / 1000.0, pid, buf->tid);
+            if (GST_CLOCK_TIME_IS_VALID(ev->frame)) {
+                fprintf(f, ",\"args\":{\"pts_ms\":%.3f}", ev->frame / 1e6);
+                TraceRef ref = { ev, buf->tid };
+                slices.push_back(ref);
+            }
+            fprintf(f, "}");
+        }
+    }
+
+    // Flechas de flujo: los slices de un mismo frame en orden de tiempo
+    std::sort(slices.begin(), slices.end(), [](const TraceRef &a, const TraceRef &b) {
+        if (a.ev->frame != b.ev->frame) return a.ev->frame < b.ev->frame;
+        return a.ev->start_ns < b.ev->start_ns;
+    });
+    guint64 flow_id = 0;
+    for (size_t i = 0; i < slices.size();) {
+        size_t end = i;
+        while (end < slices.size() && slices[end].ev->frame == slices[i].ev->frame) end++;
+        if (end - i >= 2) {
+            flow_id++;
+            for (size_t j = i; j < end; j++) {
+                const TraceEvent *ev = slices[j].ev;
+                const gchar *ph = j == i ? "s" : (j + 1 == end ? "f" : "t");
+                fprintf(f, ",\n{\"ph\":\"%s\",\"cat\":\"frame\",\"name\":\"frame\","
+                           "\"id\":%" G_GUINT64_FORMAT ",\"ts\":%.3f,\"pid\":%d,\"tid\":%u%s}",
+                        ph, flow_id, us(ev->start_ns + (ev->end_ns - ev->start_ns) / 2),
+                        pid, slices[j].tid, j == i ? "" : ",\"bp\":\"e\"");
+            }
+        }
+        i = end;
+    }
+
+    fprintf(f, "\n]}\n");
+    fclose(f);
+    g_print("Trace: %" G_GUINT64_FORMAT " events from %u threads, %" G_GUINT64_FORMAT
+            " frames linked, %" G_GUINT64_FORMAT " overwritten -> %s\n",
+            total, threads, flow_id, overwritten, tracer->path);
+    return TRUE;
+}
+
+void trace_destroy(Tracer *tracer) {
+    if (g_tracer == tracer) g_tracer = NULL;
+
+    TraceThreadBuffer *buf = tracer->threads.exchange(NULL, std::memory_order_acquire);
+    while (buf) {
+        TraceThreadBuffer *next = buf->next;
+        g_free(buf->events);
+        g_free(buf);
+        buf = next;
+    }
+    for (guint i = 0; i < tracer->elements->len; i++) {
+        TraceElement *te = (TraceElement *)g_ptr_array_index(tracer->elements, i);
+        g_free(te->name);
+        g_free(te);
+    }
+    g_ptr_array_free(tracer->elements, TRUE);
+    g_mutex_clear(&tracer->elements_lock);
+    g_free(tracer->path);
+    tracer->path = NULL;
+}
@@ -0,0 +1,109 @@
+/*
+ * trace.hpp
+ * Trazas por frame en formato Chrome trace / Perfetto (JSON)
+ *
+ * Con --trace cada elemento con pads "sink" y "src" recibe dos probes: la
+ * entrada guarda (PTS, instante, hilo) y la salida emite el intervalo. Si
+ * ambos probes corren en el mismo hilo el intervalo es un slice de ese hilo;
+ * si el buffer cambió de hilo (queue, decoder, encoder, nvinfer) se emite
+ * como evento asíncrono. Las secciones del probe del OSD se marcan con
+ * trace_section_begin/end. Al cerrar, los slices de un mismo PTS se unen
+ * con flechas de flujo.
+ *
+ * Cada hilo escribe en su propio anillo (un solo escritor, sin locks); si
+ * se llena se conservan los eventos más recientes. Con el tracing apagado
+ * g_tracer es NULL y cada sección cuesta un único branch.
+ */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include <atomic>
+
+#define TRACE_DEFAULT_EVENTS 65536   // Eventos por hilo
+#define TRACE_ELEMENT_SLOTS 32
+
+enum TraceKind {
+    TRACE_SLICE,    // Elemento: entrada y salida en el mismo hilo
+    TRACE_ASYNC,    // Elemento: el buffer cambió de hilo
+    TRACE_SECTION   // Sección de código (probe del OSD, tracker)
+};
+
+struct TraceEvent {
+    guint64 start_ns;
+    guint64 end_ns;
+    GstClockTime frame;     // PTS (GST_CLOCK_TIME_NONE si no aplica)
+    const gchar *name;      // Cadena estática o nombre internado del elemento
+    guint32 begin_tid;      // Hilo de entrada (eventos asíncronos)
+    guint32 kind;
+};
+
+// Anillo de un hilo; solo ese hilo escribe
+struct TraceThreadBuffer {
+    guint32 tid;
+    gchar name[16];
+    TraceEvent *events;
+    guint32 capacity;
+    std::atomic<guint64> head;      // Eventos escritos (incluye sobrescritos)
+    TraceThreadBuffer *next;
+};
+
+struct TraceSlot {
+    std::atomic<GstClockTime> pts;
+    std::atomic<guint64> enter_ns;
+    std::atomic<guint32> tid;
+};
+
+// Estado de los probes de un elemento
+struct TraceElement {
+    gchar *name;
+    TraceSlot slots[TRACE_ELEMENT_SLOTS];
+    std::atomic<guint32> next_slot;
+};
+
+struct Tracer {
+    gchar *path;
+    guint32 capacity;                          // Eventos por hilo
+    guint64 start_ns;
+    std::atomic<TraceThreadBuffer *> threads;  // Lista sin locks
+    GMutex elements_lock;                      // Solo al registrar elementos
+    GPtrArray *elements;                       // TraceElement*
+};
+
+// Tracer activo (NULL si --trace no se usó)
+extern Tracer *g_tracer;
+
+// Inicializa el tracer y lo publica en g_tracer
+void trace_init(Tracer *tracer, const gchar *path, guint32 events_per_thread);
+
+// Instrumenta los elementos del pipeline (y los que se agreguen después)
+void trace_attach(Tracer *tracer, GstElement *pipeline);
+
+// Escribe el JSON; llamar con el pipeline detenido
+gboolean trace_write(Tracer *tracer);
+
+// Retira g_tracer y libera los anillos; llamar después de liberar el pipeline
+void trace_destroy(Tracer *tracer);
+
+guint64 trace_clock_ns(void);
+
+// Registra un slice ya terminado en el anillo del hilo actual
+void trace_record_slice(Tracer *tracer, const gchar *name, GstClockTime frame,
+                        guint64 start_ns, guint64 end_ns);
+
+// Inicio de una sección (0 si el tracing está apagado)
+static inline guint64 trace_section_begin(void) {
+    return G_UNLIKELY(g_tracer != NULL) ? trace_clock_ns() : 0;
+}
+
+// Fin de una sección; name debe ser una cadena estática
+static inline void trace_section_end(const gchar *name, GstClockTime frame,
+                                     guint64 start_ns) {
+    if (G_UNLIKELY(start_ns != 0)) {
+        trace_record_slice(g_tracer, name, frame, start_ns, trace_clock_ns());
+    }
+}
+
+#endif // TRACE_HPP
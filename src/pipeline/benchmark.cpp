@@ -0,0 +1,195 @@
+/*
+ * benchmark.cpp
+ * Implementación del resumen de rendimiento
+ */
+
+#include "benchmark.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#define BENCH_TOP_THREADS 6
+
+struct ThreadCpu {
+    gchar name[32];
+    gdouble cpu_s;
+};
+
+static guint64 monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000ULL + (guint64)ts.tv_nsec;
+}
+
+static gdouble process_cpu_seconds(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// CPU acumulada de cada hilo (/proc/self/task/<tid>/stat, campos 14 y 15)
+static std::vector<ThreadCpu> read_thread_cpu(void) {
+    std::vector<ThreadCpu> threads;
+    GDir *dir = g_dir_open("/proc/self/task", 0, NULL);
+    if (!dir) return threads;
+
+    gdouble ticks = (gdouble)sysconf(_SC_CLK_TCK);
+    const gchar *tid;
+    while ((tid = g_dir_read_name(dir)) != NULL) {
+        gchar *path = g_strdup_printf("/proc/self/task/%s/stat", tid);
+        gchar *contents = NULL;
+        if (g_file_get_contents(path, &contents, NULL, NULL)) {
+            // El nombre va entre paréntesis y puede tener espacios
+            gchar *open = strchr(contents, '(');
+            gchar *close = strrchr(contents, ')');
+            unsigned long utime = 0, stime = 0;
+            if (open && close && close > open &&
+                sscanf(close + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                       &utime, &stime) == 2) {
+                ThreadCpu t;
+                g_strlcpy(t.name, open + 1, MIN(sizeof(t.name), (gsize)(close - open)));
+                t.cpu_s = (utime + stime) / ticks;
+                threads.push_back(t);
+            }
+            g_free(contents);
+        }
+        g_free(path);
+    }
+    g_dir_close(dir);
+
+    std::sort(threads.begin(), threads.end(),
+              [](const ThreadCpu &a, const ThreadCpu &b) { return a.cpu_s > b.cpu_s; });
+    return threads;
+}
+
+void benchmark_init(BenchmarkRun *run, const gchar *output_path, const Topology *topo) {
+    run->output_path = g_strdup(output_path);
+    run->topology = topology_to_string(topo);
+    run->start_us = 0;
+    run->start_cpu_s = 0.0;
+    for (gint i = 0; i < BENCH_FRAME_SLOTS; i++) {
+        run->frame_slots[i].pts.store(GST_CLOCK_TIME_NONE, std::memory_order_relaxed);
+        run->frame_slots[i].enter_ns.store(0, std::memory_order_relaxed);
+    }
+    run->next_frame_slot.store(0, std::memory_order_relaxed);
+    run->frame_latency_us = g_array_sized_new(FALSE, FALSE, sizeof(guint32), 4096);
+}
+
+GstPadProbeReturn benchmark_ingress_probe(GstPad *pad, GstPadProbeInfo *info,
+                                          gpointer u_data) {
+    BenchmarkRun *run = (BenchmarkRun *)u_data;
+    GstClockTime pts = GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info));
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return GST_PAD_PROBE_OK;
+
+    guint32 idx = run->next_frame_slot.fetch_add(1, std::memory_order_relaxed) % BENCH_FRAME_SLOTS;
+    run->frame_slots[idx].enter_ns.store(monotonic_ns(), std::memory_order_relaxed);
+    run->frame_slots[idx].pts.store(pts, std::memory_order_release);
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn benchmark_egress_probe(GstPad *pad, GstPadProbeInfo *info,
+                                         gpointer u_data) {
+    BenchmarkRun *run = (BenchmarkRun *)u_data;
+    GstClockTime pts = GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info));
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return GST_PAD_PROBE_OK;
+
+    guint64 now = monotonic_ns();
+    for (gint i = 0; i < BENCH_FRAME_SLOTS; i++) {
+        StageTimingSlot *slot = &run->frame_slots[i];
+        if (slot->pts.load(std::memory_order_acquire) != pts) continue;
+        guint64 enter = slot->enter_ns.load(std::memory_order_relaxed);
+        if (enter == 0 || enter > now) break;
+
+        guint32 us = (guint32)MIN((now - enter) / 1000, (guint64)G_MAXUINT32);
+        g_array_append_val(run->frame_latency_us, us);
+        slot->pts.store(GST_CLOCK_TIME_NONE, std::memory_order_relaxed);
+        break;
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+// Percentil (0..1) de las latencias por frame en ms; reordena el arreglo
+static gdouble frame_percentile_ms(GArray *samples, gdouble p) {
+    if (samples->len == 0) return 0.0;
+    guint32 *v = (guint32 *)samples->data;
+    gsize idx = (gsize)(p * (samples->len - 1));
+    std::nth_element(v, v + idx, v + samples->len);
+    return v[idx] / 1000.0;
+}
+
+void benchmark_start(BenchmarkRun *run) {
+    run->start_us = g_get_monotonic_time();
+    run->start_cpu_s = process_cpu_seconds();
+}
+
+void benchmark_finish(BenchmarkRun *run, const StageTimer *timer,
+                      guint64 frames, gdouble first_frame_s) {
+    gdouble wall_s = (g_get_monotonic_time() - run->start_us) / 1e6;
+    gdouble cpu_pct = wall_s > 0.0 ? 100.0 * (process_cpu_seconds() - run->start_cpu_s) / wall_s : 0.0;
+    gdouble fps = wall_s > 0.0 ? frames / wall_s : 0.0;
+    std::vector<ThreadCpu> threads = read_thread_cpu();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    gdouble peak_rss_mb = usage.ru_maxrss / 1024.0;   // ru_maxrss en KiB (Linux)
+    gdouble frame_p50_ms = frame_percentile_ms(run->frame_latency_us, 0.50);
+    gdouble frame_p99_ms = frame_percentile_ms(run->frame_latency_us, 0.99);
+
+    g_print("\n=== Benchmark: %s ===\n", run->topology);
+    g_print("Frames: %" G_GUINT64_FORMAT " in %.2f s (%.1f FPS), first frame %.3f s, CPU %.0f%%\n",
+            frames, wall_s, fps, first_frame_s, cpu_pct);
+    g_print("Frame latency (decoder -> encoder): p50 %.2f ms, p99 %.2f ms (%u frames); "
+            "peak RSS %.1f MB\n", frame_p50_ms, frame_p99_ms, run->frame_latency_us->len,
+            peak_rss_mb);
+    stage_timer_print_summary(timer);
+    g_print("Busiest threads (%% of one core):\n");
+    for (size_t i = 0; i < threads.size() && i < BENCH_TOP_THREADS; i++) {
+        g_print("  %-16s %6.1f%%\n", threads[i].name,
+                wall_s > 0.0 ? 100.0 * threads[i].cpu_s / wall_s : 0.0);
+    }
+
+    // Cabecera solo si el archivo está vacío
+    FILE *f = fopen(run->output_path, "a");
+    if (!f) {
+        g_printerr("Benchmark: could not open %s\n", run->output_path);
+        return;
+    }
+    fseek(f, 0, SEEK_END);
+    if (ftell(f) == 0) {
+        fprintf(f, "topology,frames,seconds,fps,first_frame_s,cpu_pct,peak_rss_mb,"
+                   "frame_p50_ms,frame_p99_ms");
+        for (gint s = 0; s < STAGE_COUNT; s++) {
+            const gchar *name = topology_stage_name((PipelineStage)s);
+            fprintf(f, ",%s_avg_ms,%s_max_ms", name, name);
+        }
+        fprintf(f, ",threads\n");
+    }
+    fprintf(f, "\"%s\",%" G_GUINT64_FORMAT ",%.3f,%.2f,%.3f,%.1f,%.1f,%.3f,%.3f",
+            run->topology, frames, wall_s, fps, first_frame_s, cpu_pct, peak_rss_mb,
+            frame_p50_ms, frame_p99_ms);
+    for (gint s = 0; s < STAGE_COUNT; s++) {
+        fprintf(f, ",%.3f,%.3f", stage_timer_avg_ms(timer, (PipelineStage)s),
+                stage_timer_max_ms(timer, (PipelineStage)s));
+    }
+    fprintf(f, ",\"");
+    for (size_t i = 0; i < threads.size() && i < BENCH_TOP_THREADS; i++) {
+        fprintf(f, "%s%s=%.1f", i ? ";" : "", threads[i].name,
+                wall_s > 0.0 ? 100.0 * threads[i].cpu_s / wall_s : 0.0);
+    }
+    fprintf(f, "\"\n");
+    fclose(f);
+    g_print("Benchmark row appended to %s\n", run->output_path);
+}
+
+void benchmark_destroy(BenchmarkRun *run) {
+    g_free(run->output_path);
+    g_free(run->topology);
+    if (run->frame_latency_us) g_array_free(run->frame_latency_us, TRUE);
+    run->output_path = NULL;
+    run->frame_latency_us = NULL;
+    run->topology = NULL;
+}
@@ -0,0 +1,54 @@
+/*
+ * benchmark.hpp
+ * Resumen de rendimiento de una corrida para comparar topologías
+ *
+ * Con --bench-out se agrega una fila CSV por corrida (topología, FPS,
+ * latencia por etapa, CPU del proceso y de los hilos principales, RSS pico
+ * y p50/p99 de la latencia por frame entre la entrada del decoder y la
+ * salida del encoder). bench_topology.sh ejecuta el mismo video con varias
+ * topologías y bench_e2e.sh barre clips generados y modos de salida.
+ */
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <glib.h>
+#include <atomic>
+#include "stage_timing.hpp"
+
+// Frames en vuelo entre el decoder y el encoder que se pueden emparejar
+#define BENCH_FRAME_SLOTS 512
+
+struct BenchmarkRun {
+    gchar *output_path;
+    gchar *topology;      // Topología en forma canónica
+    gint64 start_us;      // Reloj monotónico al pasar a PLAYING
+    gdouble start_cpu_s;  // CPU del proceso (usuario + sistema) al inicio
+
+    // Latencia por frame: mismo esquema que StageTiming (un escritor por
+    // lado), con más slots porque abarca todo el pipeline
+    StageTimingSlot frame_slots[BENCH_FRAME_SLOTS];
+    std::atomic<guint32> next_frame_slot;
+    GArray *frame_latency_us;   // guint32; solo lo escribe el hilo del encoder
+};
+
+void benchmark_init(BenchmarkRun *run, const gchar *output_path, const Topology *topo);
+
+// Probes de la latencia por frame: entrada del decoder (frame comprimido)
+// y salida del encoder
+GstPadProbeReturn benchmark_ingress_probe(GstPad *pad, GstPadProbeInfo *info,
+                                          gpointer u_data);
+GstPadProbeReturn benchmark_egress_probe(GstPad *pad, GstPadProbeInfo *info,
+                                         gpointer u_data);
+
+// Marca el inicio de la medición (justo antes de PLAYING)
+void benchmark_start(BenchmarkRun *run);
+
+// Imprime el resumen y agrega la fila al CSV; se llama en EOS, con los
+// hilos de streaming todavía vivos para leer su CPU
+void benchmark_finish(BenchmarkRun *run, const StageTimer *timer,
+                      guint64 frames, gdouble first_frame_s);
+
+void benchmark_destroy(BenchmarkRun *run);
+
+#endif // BENCHMARK_HPP
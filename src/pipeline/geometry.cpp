@@ -0,0 +1,93 @@
+/*
+ * geometry.cpp
+ * Implementación de las resoluciones por etapa
+ */
+
+#include "geometry.hpp"
+#include <stdlib.h>
+
+gboolean geometry_parse_size(const gchar *spec, SizeSpec *size) {
+    size->width = 0;
+    size->height = 0;
+    if (!spec || g_strcmp0(spec, "auto") == 0) {
+        size->mode = SIZE_AUTO;
+        return TRUE;
+    }
+    if (g_strcmp0(spec, "source") == 0) {
+        size->mode = SIZE_SOURCE;
+        return TRUE;
+    }
+    gchar *end;
+    glong w = strtol(spec, &end, 10);
+    if (end == spec || (*end != 'x' && *end != 'X')) return FALSE;
+    const gchar *h_str = end + 1;
+    glong h = strtol(h_str, &end, 10);
+    if (end == h_str || *end != '\0' || w < 16 || h < 16 || w > 8192 || h > 8192) {
+        return FALSE;
+    }
+    size->mode = SIZE_FIT;
+    size->width = (gint)w;
+    size->height = (gint)h;
+    return TRUE;
+}
+
+static gint align_to(gdouble value, gint align) {
+    gint aligned = (gint)(value / align + 0.5) * align;
+    return MAX(aligned, align);
+}
+
+void geometry_fit(gint src_w, gint src_h, gint max_w, gint max_h, gint align,
+                  gint *width, gint *height) {
+    gdouble scale = MIN((gdouble)max_w / src_w, (gdouble)max_h / src_h);
+    if (scale > 1.0) scale = 1.0;
+    *width = align_to(src_w * scale, align);
+    *height = align_to(src_h * scale, align);
+}
+
+// Tamaño de una etapa: ref es la resolución de la que parte y auto_w/auto_h
+// la caja para "auto"
+static void resolve_stage(const SizeSpec *spec, gint src_w, gint src_h,
+                          gint ref_w, gint ref_h, gint auto_w, gint auto_h,
+                          gint align, gint *width, gint *height) {
+    switch (spec->mode) {
+        case SIZE_SOURCE:
+            geometry_fit(src_w, src_h, src_w, src_h, align, width, height);
+            break;
+        case SIZE_FIT:
+            geometry_fit(ref_w, ref_h, spec->width, spec->height, align, width, height);
+            break;
+        default:
+            geometry_fit(ref_w, ref_h, auto_w, auto_h, align, width, height);
+            break;
+    }
+}
+
+void geometry_resolve(FrameGeometry *geo, gint source_width, gint source_height) {
+    geo->source_width = source_width;
+    geo->source_height = source_height;
+
+    resolve_stage(&geo->process_spec, source_width, source_height,
+                  source_width, source_height,
+                  GEOMETRY_MODEL_WIDTH * GEOMETRY_PROCESS_SCALE,
+                  GEOMETRY_MODEL_HEIGHT * GEOMETRY_PROCESS_SCALE,
+                  2, &geo->process_width, &geo->process_height);
+
+    // El tracker y la salida parten de los frames ya escalados por el muxer
+    resolve_stage(&geo->tracker_spec, source_width, source_height,
+                  geo->process_width, geo->process_height,
+                  GEOMETRY_MODEL_WIDTH, GEOMETRY_MODEL_HEIGHT,
+                  GEOMETRY_TRACKER_ALIGN, &geo->tracker_width, &geo->tracker_height);
+
+    resolve_stage(&geo->output_spec, source_width, source_height,
+                  geo->process_width, geo->process_height,
+                  geo->process_width, geo->process_height,
+                  2, &geo->output_width, &geo->output_height);
+}
+
+gchar *geometry_to_string(const FrameGeometry *geo) {
+    return g_strdup_printf("source %dx%d, process %dx%d, tracker %dx%d, output %dx%d",
+                           geo->source_width, geo->source_height,
+                           geo->process_width, geo->process_height,
+                           geo->tracker_width, geo->tracker_height,
+                           geo->output_width, geo->output_height);
+}
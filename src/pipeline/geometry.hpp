@@ -0,0 +1,63 @@
+/*
+ * geometry.hpp
+ * Resoluciones de procesamiento, tracking y salida
+ *
+ * La fuente puede ser mucho más grande que la entrada del detector (640x368
+ * en el modelo de ejemplo). Cada etapa tiene su propia resolución, siempre
+ * con la relación de aspecto de la fuente y sin escalar hacia arriba:
+ *   proceso  (nvstreammux: inferencia, OSD, capturas) -> hasta 2x el modelo
+ *   tracker  (nvtracker)                              -> hasta el modelo
+ *   salida   (encoder)                                -> la de proceso
+ *
+ * Especificación por etapa: "auto", "source" o "WxH" (caja en la que se
+ * ajusta la fuente). Los ROI son normalizados; los bbox de los metadatos
+ * están en píxeles de la resolución de proceso.
+ */
+
+#ifndef GEOMETRY_HPP
+#define GEOMETRY_HPP
+
+#include <glib.h>
+
+#define GEOMETRY_MODEL_WIDTH 640      // Entrada de resnet10 (config_infer_primary)
+#define GEOMETRY_MODEL_HEIGHT 368
+#define GEOMETRY_PROCESS_SCALE 2      // Proceso automático: hasta 2x el modelo
+#define GEOMETRY_TRACKER_ALIGN 32     // nvtracker trabaja en múltiplos de 32
+
+enum SizeMode {
+    SIZE_AUTO,
+    SIZE_SOURCE,
+    SIZE_FIT        // Ajustar dentro de width x height
+};
+
+struct SizeSpec {
+    SizeMode mode;
+    gint width;
+    gint height;
+};
+
+struct FrameGeometry {
+    SizeSpec process_spec;
+    SizeSpec tracker_spec;
+    SizeSpec output_spec;
+    gint source_width, source_height;
+    gint process_width, process_height;
+    gint tracker_width, tracker_height;
+    gint output_width, output_height;
+};
+
+// "auto", "source" o "WxH"; NULL equivale a "auto"
+gboolean geometry_parse_size(const gchar *spec, SizeSpec *size);
+
+// Mayor tamaño con el aspecto de src que cabe en max_w x max_h (sin
+// agrandar), redondeado a múltiplos de align
+void geometry_fit(gint src_w, gint src_h, gint max_w, gint max_h, gint align,
+                  gint *width, gint *height);
+
+// Calcula las tres resoluciones a partir de la fuente y las especificaciones
+void geometry_resolve(FrameGeometry *geo, gint source_width, gint source_height);
+
+// "source 3840x2160, process 1280x720, ..." (liberar con g_free)
+gchar *geometry_to_string(const FrameGeometry *geo);
+
+#endif // GEOMETRY_HPP
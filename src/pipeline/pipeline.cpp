@@ -7,6 +7,9 @@
 #include "config/track_info.hpp"
 #include "roi/render.h"
 #include "report/report.hpp"
+#include "stream/udp_outputs.hpp"
+#include "ingest/ingest.hpp"
+#include "video_utils.h"
 #include "gstnvdsmeta.h"
 #include <unordered_map>
 #include <sys/stat.h>
@@ -20,44 +23,6 @@ static gboolean file_exists(const gchar *filepath) {
     return (stat(filepath, &buffer) == 0);
 }
 
-void on_pad_added(GstElement *element, GstPad *pad, gpointer data) {
-    GstElement *parser = GST_ELEMENT(data);
-    GstPad *sinkpad = gst_element_get_static_pad(parser, "sink");
-    if (!sinkpad) {
-        g_printerr("on_pad_added: could not get parser sink pad\n");
-        return;
-    }
-
-    if (gst_pad_is_linked(sinkpad)) {
-        gst_object_unref(sinkpad);
-        return;
-    }
-
-    GstCaps *caps = gst_pad_get_current_caps(pad);
-    if (!caps) {
-        caps = gst_pad_query_caps(pad, NULL);
-    }
-    if (!caps) {
-        g_printerr("on_pad_added: could not get caps from demux pad\n");
-        gst_object_unref(sinkpad);
-        return;
-    }
-
-    const GstStructure *str = gst_caps_get_structure(caps, 0);
-    const gchar *name = gst_structure_get_name(str);
-
-    if (g_str_has_prefix(name, "video")) {
-        if (GST_PAD_LINK_FAILED(gst_pad_link(pad, sinkpad))) {
-            g_printerr("Error: Failed to link demuxer to parser\n");
-        } else {
-            g_print("Linked demuxer pad (%s) to parser\n", name);
-        }
-    }
-
-    gst_caps_unref(caps);
-    gst_object_unref(sinkpad);
-}
-
 gboolean bus_call(GstBus *bus, GstMessage *msg, gpointer data) {
     GMainLoop *loop = (GMainLoop *)data;
     
@@ -65,8 +30,39 @@ gboolean bus_call(GstBus *bus, GstMessage *msg, gpointer data) {
         case GST_MESSAGE_EOS:
             g_print("End of stream\n");
             if (g_pipeline_ctx) {
+                ReportExtras extras;
+                extras.rate_control = g_pipeline_ctx->rate_control;
+                extras.resources = g_pipeline_ctx->resources;
+                extras.aggregates = g_pipeline_ctx->aggregates;
+                extras.store_file = g_pipeline_ctx->config->report_store;
+                if (g_pipeline_ctx->snapshots) {
+                    // El reporte y el checkpoint solo listan JPEG ya escritos
+                    snapshot_drain(g_pipeline_ctx->snapshots);
+                    snapshot_apply_written(g_pipeline_ctx->snapshots, g_pipeline_ctx->tracker);
+                }
+                if (g_pipeline_ctx->rate_control) {
+                    rate_control_print_summary(g_pipeline_ctx->rate_control);
+                }
+                if (g_pipeline_ctx->resources) {
+                    resource_sampler_stop(g_pipeline_ctx->resources);
+                    resource_sampler_print_summary(g_pipeline_ctx->resources);
+                }
+                if (g_pipeline_ctx->benchmark) {
+                    benchmark_finish(g_pipeline_ctx->benchmark, g_pipeline_ctx->stage_timer,
+                                     g_pipeline_ctx->frames_processed,
+                                     g_pipeline_ctx->first_frame_time);
+                }
+                if (g_pipeline_ctx->checkpoint) {
+                    checkpoint_finish(g_pipeline_ctx->checkpoint, g_pipeline_ctx->tracker);
+                }
+                if (g_pipeline_ctx->heatmap) {
+                    heatmap_finish(g_pipeline_ctx->heatmap);
+                }
+                if (g_pipeline_ctx->trajectories) {
+                    trajectory_finish(g_pipeline_ctx->trajectories);
+                }
                 generate_report(g_pipeline_ctx->tracker, 
-                              g_pipeline_ctx->config->report_file);
+                              g_pipeline_ctx->config->report_file, &extras);
             }
             g_main_loop_quit(loop);
             break;
@@ -110,10 +106,42 @@ GstPadProbeReturn osd_sink_pad_buffer_probe(GstPad *pad, GstPadProbeInfo *info,
     
     if (!batch_meta || !g_pipeline_ctx) return GST_PAD_PROBE_OK;
     
+    GstClockTime pts = GST_BUFFER_PTS(buf);
+    // Al reanudar: el preroll y lo que quede antes del PTS guardado ya se contó
+    if (GST_CLOCK_TIME_IS_VALID(g_pipeline_ctx->resume_pts)) {
+        if (GST_CLOCK_TIME_IS_VALID(pts) && pts < g_pipeline_ctx->resume_pts) {
+            return GST_PAD_PROBE_OK;
+        }
+        g_pipeline_ctx->resume_pts = GST_CLOCK_TIME_NONE;
+    }
+    
     TrackerContext *tracker = g_pipeline_ctx->tracker;
+    g_pipeline_ctx->frames_processed++;
+    // Cambios de ROI/umbral/clases publicados por el hilo de control
+    tracker_poll_config(tracker);
+    tracker_poll_resumed(tracker);
+    if (g_pipeline_ctx->snapshots) {
+        snapshot_apply_written(g_pipeline_ctx->snapshots, tracker);
+    }
     tracker->roi_has_objects = FALSE;
     tracker->roi_has_alerts = FALSE;
-    std::unordered_map<guint64, bool> active_tracks;
+    tracker->objects_in_roi = 0;
+    tracker->zones_with_objects = 0;
+    tracker->zones_with_alerts = 0;
+    guint num_objects = 0;
+    if (g_pipeline_ctx->aggregates) {
+        aggregates_begin_frame(g_pipeline_ctx->aggregates, pts);
+    }
+    // Tracks cerrados por una config nueva o al vencer la reanudación: cuentan
+    // como visitas terminadas igual que una salida del ROI
+    if (!tracker->closed_dwell.empty()) {
+        if (g_pipeline_ctx->aggregates) {
+            for (gdouble dwell : tracker->closed_dwell) {
+                aggregates_on_event(g_pipeline_ctx->aggregates, TRACK_EVENT_EXIT, dwell);
+            }
+        }
+        tracker->closed_dwell.clear();
+    }
     
     for (NvDsMetaList *l_frame = batch_meta->frame_meta_list; l_frame; 
          l_frame = l_frame->next) {
@@ -122,45 +150,304 @@ GstPadProbeReturn osd_sink_pad_buffer_probe(GstPad *pad, GstPadProbeInfo *info,
         if (tracker->source_width == 0) {
             tracker->source_width = fmeta->source_frame_width;
             tracker->source_height = fmeta->source_frame_height;
+            tracker->frame_width = g_pipeline_ctx->geometry.process_width;
+            tracker->frame_height = g_pipeline_ctx->geometry.process_height;
+            g_pipeline_ctx->first_frame_time = g_timer_elapsed(tracker->app_timer, NULL);
+            ROI_LOG_INFO(LOG_CAT_PIPELINE, "Time to first frame: %.3f s",
+                         g_pipeline_ctx->first_frame_time);
         }
         
+        guint64 section = trace_section_begin();
         for (NvDsMetaList *l_obj = fmeta->obj_meta_list; l_obj; 
              l_obj = l_obj->next) {
             NvDsObjectMeta *obj_meta = (NvDsObjectMeta *)l_obj->data;
             
             if (obj_meta) {
+                num_objects++;
                 guint64 track_id = obj_meta->object_id;
-                active_tracks[track_id] = true;
-                tracker_process_object(tracker, obj_meta,
-                                     fmeta->source_frame_width, 
-                                     fmeta->source_frame_height);
+                // Los bbox están en la resolución del muxer
+                TrackEvent event = tracker_process_object(tracker, obj_meta,
+                                                          tracker->frame_width,
+                                                          tracker->frame_height);
+                if ((g_pipeline_ctx->heatmap || g_pipeline_ctx->trajectories) &&
+                    tracker_tracks_class(tracker->config, obj_meta->class_id)) {
+                    if (g_pipeline_ctx->heatmap) {
+                        heatmap_observe(g_pipeline_ctx->heatmap, &obj_meta->rect_params,
+                                        tracker->frame_width, tracker->frame_height);
+                    }
+                    if (g_pipeline_ctx->trajectories) {
+                        trajectory_record(g_pipeline_ctx->trajectories, obj_meta, event,
+                                          tracker->frame_width, tracker->frame_height, pts);
+                    }
+                }
+                if (event != TRACK_EVENT_NONE && g_pipeline_ctx->aggregates) {
+                    gdouble dwell = 0.0;
+                    if (event == TRACK_EVENT_EXIT) {
+                        auto it = tracker->tracked_objects.find(track_id);
+                        if (it != tracker->tracked_objects.end()) dwell = it->second.total_time;
+                    }
+                    aggregates_on_event(g_pipeline_ctx->aggregates, event, dwell);
+                }
+                
+                if (event == TRACK_EVENT_ALERT && g_pipeline_ctx->snapshots) {
+                    // La ruta llega al track cuando el pool escribe el JPEG
+                    snapshot_request(g_pipeline_ctx->snapshots, GST_BUFFER_PTS(buf),
+                                     track_id, &obj_meta->rect_params);
+                }
             }
         }
         
-        draw_roi_rect(batch_meta, fmeta, &tracker->roi, 
-                     tracker->roi_has_objects, tracker->roi_has_alerts);
+        if (g_pipeline_ctx->heatmap) {
+            heatmap_end_frame(g_pipeline_ctx->heatmap, pts);
+        }
+        trace_section_end("osd:tracking", pts, section);
+        
+        section = trace_section_begin();
+        draw_roi_rect(batch_meta, fmeta, tracker->config,
+                     tracker->zones_with_objects, tracker->zones_with_alerts,
+                     tracker->frame_width, tracker->frame_height);
+        trace_section_end("osd:drawing", pts, section);
+        
+        if (g_pipeline_ctx->shm_export) {
+            section = trace_section_begin();
+            shm_export_stage_frame(g_pipeline_ctx->shm_export, tracker, fmeta,
+                                   GST_BUFFER_PTS(buf));
+            trace_section_end("osd:export", pts, section);
+        }
+    }
+    
+    guint64 section = trace_section_begin();
+    if (g_pipeline_ctx->rate_control) {
+        rate_control_update(g_pipeline_ctx->rate_control,
+                            tracker->roi_has_objects || tracker->roi_has_alerts,
+                            tracker->total_detected, GST_BUFFER_PTS(buf));
+    }
+    
+    if (g_pipeline_ctx->aggregates) {
+        aggregates_end_frame(g_pipeline_ctx->aggregates, tracker->objects_in_roi);
+    }
+    if (g_pipeline_ctx->metrics) {
+        metrics_on_frame(g_pipeline_ctx->metrics, num_objects, tracker->total_detected,
+                         tracker->total_alerts, tracker->tracked_objects.size());
+    }
+    if (g_pipeline_ctx->resources) {
+        resource_sampler_note_frame(g_pipeline_ctx->resources, pts);
     }
+    trace_section_end("osd:stats", pts, section);
     
+    if (g_pipeline_ctx->checkpoint) {
+        section = trace_section_begin();
+        checkpoint_maybe_write(g_pipeline_ctx->checkpoint, tracker, pts);
+        trace_section_end("osd:checkpoint", pts, section);
+    }
+    
+    return GST_PAD_PROBE_OK;
+}
+
+// Caps del encoder con la resolución de salida; nvvideoconvert escala desde
+// la de proceso si difieren
+static void configure_output_caps(PipelineContext *ctx) {
+    const FrameGeometry *geo = &ctx->geometry;
+    GstCaps *caps = gst_caps_from_string(ctx->output_system_memory
+                                         ? "video/x-raw, format=I420"
+                                         : "video/x-raw(memory:NVMM), format=NV12");
+    gst_caps_set_simple(caps,
+                        "width", G_TYPE_INT, geo->output_width,
+                        "height", G_TYPE_INT, geo->output_height,
+                        NULL);
+    g_object_set(G_OBJECT(ctx->output_caps), "caps", caps, NULL);
+    gst_caps_unref(caps);
+}
+
+// Aplica la resolución de proceso y el framerate actuales al muxer
+static void configure_streammux(PipelineContext *ctx) {
+    // En live el muxer no espera más de un intervalo de frame para armar el batch
+    gint push_timeout = 4000000;
+    if (ctx->live_source) {
+        push_timeout = (ctx->stream_fps_num > 0 && ctx->stream_fps_den > 0)
+                       ? (gint)(1000000LL * ctx->stream_fps_den / ctx->stream_fps_num)
+                       : 33333;
+    }
+    g_object_set(G_OBJECT(ctx->streammux),
+                 "width", ctx->geometry.process_width,
+                 "height", ctx->geometry.process_height,
+                 "batched-push-timeout", push_timeout,
+                 NULL);
+    ROI_LOG_INFO(LOG_CAT_PIPELINE, "Configured streammux: %dx%d",
+                 ctx->geometry.process_width, ctx->geometry.process_height);
+}
+
+// Evento CAPS en la entrada del muxer: llega antes del primer buffer, por lo
+// que el muxer todavía no negoció su salida y acepta la resolución real
+static GstPadProbeReturn mux_caps_probe(GstPad *pad, GstPadProbeInfo *info,
+                                        gpointer u_data) {
+    PipelineContext *ctx = (PipelineContext *)u_data;
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) != GST_EVENT_CAPS || ctx->stream_configured) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstCaps *caps;
+    gst_event_parse_caps(event, &caps);
+    VideoInfo video_info;
+    if (!video_info_from_caps(caps, &video_info)) return GST_PAD_PROBE_OK;
+
+    ctx->stream_configured = TRUE;
+    ROI_LOG_INFO(LOG_CAT_PIPELINE, "[OK] Video resolution: %dx%d @ %d/%d fps",
+            video_info.width, video_info.height, video_info.fps_num, video_info.fps_den);
+
+    gboolean changed = video_info.width != ctx->stream_width ||
+                       video_info.height != ctx->stream_height ||
+                       video_info.fps_num != ctx->stream_fps_num ||
+                       video_info.fps_den != ctx->stream_fps_den;
+    if (changed) {
+        ctx->stream_width = video_info.width;
+        ctx->stream_height = video_info.height;
+        ctx->stream_fps_num = video_info.fps_num;
+        ctx->stream_fps_den = video_info.fps_den;
+        // nvtracker ya se inició con la resolución provisional; solo el
+        // muxer y la salida se ajustan antes de negociar
+        gint tracker_width = ctx->geometry.tracker_width;
+        gint tracker_height = ctx->geometry.tracker_height;
+        geometry_resolve(&ctx->geometry, video_info.width, video_info.height);
+        ctx->geometry.tracker_width = tracker_width;
+        ctx->geometry.tracker_height = tracker_height;
+        configure_streammux(ctx);
+        configure_output_caps(ctx);
+        gchar *geo_str = geometry_to_string(&ctx->geometry);
+        ROI_LOG_INFO(LOG_CAT_PIPELINE, "Geometry: %s", geo_str);
+        g_free(geo_str);
+        if (ctx->config->media_cache && ctx->ingest->kind == INGEST_FILE) {
+            video_info_cache_store(ctx->config->media_cache, ctx->ingest->location,
+                                   &video_info);
+        }
+    }
     return GST_PAD_PROBE_OK;
 }
 
+// Decoder creado por la etapa de entrada
+static void on_ingest_decoder(GstElement *decoder, gpointer user_data) {
+    PipelineContext *ctx = (PipelineContext *)user_data;
+    if (ctx->latency_log) {
+        GstPad *decoder_sink = gst_element_get_static_pad(decoder, "sink");
+        gst_pad_add_probe(decoder_sink, GST_PAD_PROBE_TYPE_BUFFER,
+                          latency_ingest_probe, ctx->latency_log, NULL);
+        gst_object_unref(decoder_sink);
+    }
+    if (ctx->benchmark) {
+        GstPad *decoder_sink = gst_element_get_static_pad(decoder, "sink");
+        gst_pad_add_probe(decoder_sink, GST_PAD_PROBE_TYPE_BUFFER,
+                          benchmark_ingress_probe, ctx->benchmark, NULL);
+        gst_object_unref(decoder_sink);
+    }
+}
+
+// Cola con descarte de los buffers más viejos (nunca bloquea al productor)
+static void set_leaky_queue(GstElement *queue, guint max_buffers) {
+    g_object_set(G_OBJECT(queue),
+                 "leaky", 2,
+                 "max-size-buffers", max_buffers,
+                 "max-size-bytes", 0,
+                 "max-size-time", (guint64)0,
+                 NULL);
+}
+
+// Rama de exportación: tee -> queue (leaky) -> nvvideoconvert -> RGBA -> fakesink
+// El frame se copia al anillo desde el probe del fakesink
+static gboolean add_shm_export_branch(PipelineContext *ctx, GstElement *tee) {
+    GstElement *queue = gst_element_factory_make("queue",          "shm-queue");
+    GstElement *conv  = gst_element_factory_make("nvvideoconvert", "shm-conv");
+    GstElement *caps_elem = gst_element_factory_make("capsfilter", "shm-caps");
+    GstElement *sink  = gst_element_factory_make("fakesink",       "shm-sink");
+
+    if (!queue || !conv || !caps_elem || !sink) {
+        g_printerr("Failed to create shared memory export elements\n");
+        return FALSE;
+    }
+
+    // Un consumidor lento nunca debe frenar la rama principal
+    set_leaky_queue(queue, 2);
+    GstCaps *caps = gst_caps_from_string("video/x-raw, format=RGBA");
+    g_object_set(G_OBJECT(caps_elem), "caps", caps, NULL);
+    gst_caps_unref(caps);
+    g_object_set(G_OBJECT(sink), "sync", FALSE, "async", FALSE, NULL);
+
+    gst_bin_add_many(GST_BIN(ctx->pipeline), queue, conv, caps_elem, sink, NULL);
+    if (!gst_element_link_many(tee, queue, conv, caps_elem, sink, NULL)) {
+        g_printerr("Failed to link shared memory export branch\n");
+        return FALSE;
+    }
+
+    GstPad *sink_pad = gst_element_get_static_pad(sink, "sink");
+    gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER,
+                      shm_export_sink_probe, ctx->shm_export, NULL);
+    gst_object_unref(sink_pad);
+    g_print("Linked: tee -> queue -> nvvideoconvert -> fakesink (shm export)\n");
+    return TRUE;
+}
+
+// Rama de capturas: tee -> queue (leaky) -> nvvideoconvert -> RGBA -> fakesink
+// Solo los frames con una alerta pendiente pasan del queue
+static gboolean add_snapshot_branch(PipelineContext *ctx, GstElement *tee) {
+    GstElement *queue = gst_element_factory_make("queue",          "snapshot-queue");
+    GstElement *conv  = gst_element_factory_make("nvvideoconvert", "snapshot-conv");
+    GstElement *caps_elem = gst_element_factory_make("capsfilter", "snapshot-caps");
+    GstElement *sink  = gst_element_factory_make("fakesink",       "snapshot-sink");
+
+    if (!queue || !conv || !caps_elem || !sink) {
+        g_printerr("Failed to create snapshot elements\n");
+        return FALSE;
+    }
+
+    set_leaky_queue(queue, 4);
+    GstCaps *caps = gst_caps_from_string("video/x-raw, format=RGBA");
+    g_object_set(G_OBJECT(caps_elem), "caps", caps, NULL);
+    gst_caps_unref(caps);
+    g_object_set(G_OBJECT(sink), "sync", FALSE, "async", FALSE, NULL);
+
+    gst_bin_add_many(GST_BIN(ctx->pipeline), queue, conv, caps_elem, sink, NULL);
+    if (!gst_element_link_many(tee, queue, conv, caps_elem, sink, NULL)) {
+        g_printerr("Failed to link snapshot branch\n");
+        return FALSE;
+    }
+
+    GstPad *queue_sink = gst_element_get_static_pad(queue, "sink");
+    gst_pad_add_probe(queue_sink, GST_PAD_PROBE_TYPE_BUFFER,
+                      snapshot_filter_probe, ctx->snapshots, NULL);
+    gst_object_unref(queue_sink);
+
+    GstPad *sink_pad = gst_element_get_static_pad(sink, "sink");
+    gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER,
+                      snapshot_sink_probe, ctx->snapshots, NULL);
+    gst_object_unref(sink_pad);
+    g_print("Linked: tee -> queue -> nvvideoconvert -> fakesink (snapshots)\n");
+    return TRUE;
+}
+
 gboolean pipeline_create(PipelineContext *ctx) {
     g_pipeline_ctx = ctx;
     
-    // Verificar archivo de entrada
-    if (!file_exists(ctx->config->input_file)) {
-        g_printerr("ERROR: Input file not found: %s\n", ctx->config->input_file);
-        return FALSE;
+    // Verificar archivo de entrada (las fuentes de red se validan al conectar)
+    if (ctx->ingest->kind == INGEST_FILE) {
+        if (!file_exists(ctx->ingest->location)) {
+            g_printerr("ERROR: Input file not found: %s\n", ctx->ingest->location);
+            return FALSE;
+        }
+        g_print("Input file verified: %s\n", ctx->ingest->location);
     }
     
-    g_print("Input file verified: %s\n", ctx->config->input_file);
-    
-    // Detectar modo UDP
+    // Detectar modo UDP y encoder
     gboolean use_udp = (g_strcmp0(ctx->config->mode, "udp") == 0);
+    gboolean use_x264 = (g_strcmp0(ctx->config->encoder, "x264") == 0);
+    gboolean live = (g_strcmp0(ctx->config->profile, "live") == 0);
+    ctx->live_source = live || ingest_is_live(ctx->ingest);
     
-    GstElement *source, *demux, *parser, *decoder, *streammux;
+    GstElement *streammux;
     GstElement *pgie, *tracker_elem, *nvvidconv, *nvosd;
     GstElement *nvvidconv2, *capsfilter, *encoder, *parser2, *mux, *sink;
+    GstElement *tee = NULL;
+    GstElement *out_tee = NULL, *out_queue = NULL;
+    GstElement *stage_queue[STAGE_COUNT];
     GstPad *osd_sink_pad;
     GstBus *bus;
 
@@ -170,12 +457,6 @@ gboolean pipeline_create(PipelineContext *ctx) {
         return FALSE;
     }
 
-    /* Source & decode */
-    source     = gst_element_factory_make("filesrc",        "file-source");
-    demux      = gst_element_factory_make("qtdemux",        "demuxer");
-    parser     = gst_element_factory_make("h264parse",      "h264-parser");
-    decoder    = gst_element_factory_make("nvv4l2decoder",  "decoder");
-
     /* DeepStream core */
     streammux  = gst_element_factory_make("nvstreammux",    "stream-muxer");
     pgie       = gst_element_factory_make("nvinfer",        "primary-infer");
@@ -186,13 +467,17 @@ gboolean pipeline_create(PipelineContext *ctx) {
     /* Post-OSD -> encoder */
     nvvidconv2 = gst_element_factory_make("nvvideoconvert", "post-osd-conv");
     capsfilter = gst_element_factory_make("capsfilter",     "capsfilter");
-    encoder    = gst_element_factory_make("nvv4l2h264enc",  "h264-encoder");
+    if (use_x264) {
+        encoder = gst_element_factory_make("x264enc",       "h264-encoder");
+    } else {
+        encoder = gst_element_factory_make("nvv4l2h264enc", "h264-encoder");
+    }
     parser2    = gst_element_factory_make("h264parse",      "h264-parser-out");
     
     if (use_udp) {
         // Modo UDP: RTP payloader + UDP sink
         mux = gst_element_factory_make("rtph264pay", "rtp-payloader");
-        sink = gst_element_factory_make("udpsink", "udp-sink");
+        sink = gst_element_factory_make("multiudpsink", "udp-sink");
         g_print("Mode: UDP STREAMING\n");
     } else {
         // Modo archivo: MP4 muxer + file sink
@@ -201,28 +486,57 @@ gboolean pipeline_create(PipelineContext *ctx) {
         g_print("Mode: FILE OUTPUT\n");
     }
 
-    if (!source || !demux || !parser || !decoder || !streammux ||
+    if (!streammux ||
         !pgie || !tracker_elem || !nvvidconv || !nvosd ||
         !nvvidconv2 || !capsfilter || !encoder || !parser2 || !mux || !sink) {
         g_printerr("Failed to create one or more elements\n");
         return FALSE;
     }
 
+    // Las ramas auxiliares salen antes de nvvideoconvert: el OSD dibuja sobre
+    // la copia de la rama principal, así los frames exportados quedan limpios
+    if (ctx->shm_export || ctx->snapshots) {
+        tee = gst_element_factory_make("tee", "aux-tee");
+        if (!tee) {
+            g_printerr("Failed to create tee\n");
+            return FALSE;
+        }
+    }
+
+    // Perfil live: un archivo se entrega a velocidad real (como una cámara)
+    ctx->ingest->pace = live && ctx->ingest->kind == INGEST_FILE;
+    if (live) {
+        g_print("Profile: LIVE (low latency)\n");
+    }
+
+    // Fronteras de hilo: un queue a la entrada de cada etapa configurada
+    for (gint s = 0; s < STAGE_COUNT; s++) {
+        stage_queue[s] = NULL;
+        // Con renditions el queue de encode es el de la rama principal del tee
+        if (s == STAGE_ENCODE && use_udp && ctx->config->num_renditions > 0) continue;
+        if (!ctx->topology->stages[s].enabled) continue;
+        stage_queue[s] = topology_make_queue(ctx->topology, (PipelineStage)s);
+        if (!stage_queue[s]) {
+            g_printerr("Failed to create topology queues\n");
+            return FALSE;
+        }
+    }
+    ctx->ingest->decode_queue = stage_queue[STAGE_MUX];
+    gchar *topo_str = topology_to_string(ctx->topology);
+    g_print("Topology: %s\n", topo_str);
+    g_free(topo_str);
+
     g_print("All GStreamer elements created successfully\n");
 
     /* Configure elements */
-    g_object_set(G_OBJECT(source), "location", ctx->config->input_file, NULL);
-    g_print("Configured source: %s\n", ctx->config->input_file);
-
-    // Usar la resolución detectada del video
+    // Resolución provisional (cache o 1280x720): se corrige con los caps del
+    // decoder antes de que el primer frame llegue al muxer
+    ctx->streammux = streammux;
     g_object_set(G_OBJECT(streammux),
                  "batch-size", 1,
-                 "width", ctx->stream_width,
-                 "height", ctx->stream_height,
-                 "batched-push-timeout", 4000000,
-                 "live-source", 0,
+                 "live-source", ctx->live_source ? 1 : 0,
                  NULL);
-    g_print("Configured streammux: %dx%d\n", ctx->stream_width, ctx->stream_height);
+    configure_streammux(ctx);
 
     // Configurar PGIE
     const gchar *pgie_config = "/opt/nvidia/deepstream/deepstream/samples/configs/deepstream-app/config_infer_primary.txt";
@@ -241,22 +555,40 @@ gboolean pipeline_create(PipelineContext *ctx) {
     if (!file_exists(tracker_lib)) {
         tracker_lib = "/opt/nvidia/deepstream/deepstream-6.0/lib/libnvds_nvmultiobjecttracker.so";
     }
+    // nvtracker fija su resolución al arrancar: se usa la provisional (con
+    // --media-cache es la real desde la segunda corrida)
     g_object_set(G_OBJECT(tracker_elem),
-                 "tracker-width", 640,
-                 "tracker-height", 384,
+                 "tracker-width", ctx->geometry.tracker_width,
+                 "tracker-height", ctx->geometry.tracker_height,
                  "ll-lib-file", tracker_lib,
                  "ll-config-file", tracker_config,
                  NULL);
     g_print("Configured tracker\n");
 
-    // Configurar encoder
-    g_object_set(G_OBJECT(encoder),
-                 "bitrate", 4000000,
-                 "preset-level", 1,
-                 "insert-sps-pps", TRUE,
-                 "iframeinterval", 30,
-                 NULL);
-    g_print("Configured encoder\n");
+    // Configurar encoder (bitrate y GOP los maneja el control de tasa)
+    if (use_x264) {
+        g_object_set(G_OBJECT(encoder),
+                     "speed-preset", 1,   // ultrafast
+                     NULL);
+        if (live) {
+            // zerolatency: sin lookahead ni B-frames, slices por hilo
+            g_object_set(G_OBJECT(encoder), "tune", 0x00000004, NULL);
+        }
+    } else {
+        g_object_set(G_OBJECT(encoder),
+                     "preset-level", 1,
+                     "insert-sps-pps", TRUE,
+                     NULL);
+        if (live) {
+            // Relojes al máximo y POC tipo 2 (sin reordenamiento de frames)
+            g_object_set(G_OBJECT(encoder),
+                         "maxperf-enable", TRUE,
+                         "poc-type", 2,
+                         NULL);
+        }
+    }
+    rate_control_attach(ctx->rate_control, encoder);
+    g_print("Configured encoder: %s\n", use_x264 ? "x264enc" : "nvv4l2h264enc");
 
     // Configurar sink según modo
     if (use_udp) {
@@ -264,13 +596,24 @@ gboolean pipeline_create(PipelineContext *ctx) {
                      "config-interval", 1,
                      "pt", 96,
                      NULL);
+        if (ctx->latency_log) {
+            // Timestamp RTP = running time: permite asociar cada frame
+            // recibido con su marca de ingreso (tools/latency_probe)
+            g_object_set(G_OBJECT(mux), "timestamp-offset", (guint)0, NULL);
+        }
+        // multiudpsink envía a cada cliente sin esperar: un receptor lento
+        // pierde paquetes pero no frena a los demás
+        gchar *clients = udp_build_client_list(ctx->config->udp_host, ctx->config->udp_port,
+                                               ctx->config->udp_clients,
+                                               ctx->config->udp_multicast);
         g_object_set(G_OBJECT(sink),
-                     "host", ctx->config->udp_host,
-                     "port", ctx->config->udp_port,
+                     "clients", clients,
+                     "auto-multicast", TRUE,
                      "async", FALSE,
                      "sync", FALSE,
                      NULL);
-        g_print("Configured UDP sink: %s:%d\n", ctx->config->udp_host, ctx->config->udp_port);
+        g_print("Configured UDP sink: %s\n", clients);
+        g_free(clients);
     } else {
         g_object_set(G_OBJECT(sink),
                      "location", ctx->config->output_file,
@@ -280,53 +623,147 @@ gboolean pipeline_create(PipelineContext *ctx) {
         g_print("Configured file sink: %s\n", ctx->config->output_file);
     }
 
-    GstCaps *caps = gst_caps_from_string("video/x-raw(memory:NVMM), format=NV12");
-    g_object_set(G_OBJECT(capsfilter), "caps", caps, NULL);
-    gst_caps_unref(caps);
+    // x264enc trabaja en memoria del sistema
+    ctx->output_caps = capsfilter;
+    ctx->output_system_memory = use_x264;
+    configure_output_caps(ctx);
+    gchar *geo_str = geometry_to_string(&ctx->geometry);
+    g_print("Geometry: %s\n", geo_str);
+    g_free(geo_str);
+
+    // Renditions UDP: el tee sale del OSD y cada rama tiene su cola con
+    // descarte, así un encoder lento no frena a la salida principal
+    if (use_udp && ctx->config->num_renditions > 0) {
+        out_tee = gst_element_factory_make("tee", "output-tee");
+        if (ctx->topology->stages[STAGE_ENCODE].enabled) {
+            out_queue = topology_make_queue(ctx->topology, STAGE_ENCODE);
+        } else {
+            out_queue = gst_element_factory_make("queue", "output-queue");
+            if (out_queue) set_leaky_queue(out_queue, 3);
+        }
+        if (!out_tee || !out_queue) {
+            g_printerr("Failed to create output tee\n");
+            return FALSE;
+        }
+        stage_queue[STAGE_ENCODE] = out_queue;
+    }
 
     /* Add all elements to the bin */
-    gst_bin_add_many(GST_BIN(ctx->pipeline),
-                     source, demux, parser, decoder,
-                     streammux, pgie, tracker_elem,
-                     nvvidconv, nvosd,
-                     nvvidconv2, capsfilter, encoder, parser2, mux, sink,
-                     NULL);
+    // Cadena principal con las fronteras de hilo intercaladas; la entrada de
+    // cada etapa es su queue (si lo tiene) y la salida su último elemento
+    GstElement *chain[24];
+    GstElement *stage_entry[STAGE_COUNT];
+    GstElement *stage_exit[STAGE_COUNT] = { streammux, pgie, tracker_elem, nvosd, encoder, sink };
+    guint n = 0;
+    chain[n++] = streammux;
+    stage_entry[STAGE_MUX] = stage_queue[STAGE_MUX];
+    stage_entry[STAGE_INFER] = stage_queue[STAGE_INFER] ? stage_queue[STAGE_INFER] : pgie;
+    if (stage_queue[STAGE_INFER]) chain[n++] = stage_queue[STAGE_INFER];
+    chain[n++] = pgie;
+    stage_entry[STAGE_TRACK] = stage_queue[STAGE_TRACK] ? stage_queue[STAGE_TRACK] : tracker_elem;
+    if (stage_queue[STAGE_TRACK]) chain[n++] = stage_queue[STAGE_TRACK];
+    chain[n++] = tracker_elem;
+    // El queue de OSD va antes del tee auxiliar: la rama principal sigue
+    // pidiendo el primer pad del tee y el probe del OSD corre antes que las
+    // ramas auxiliares
+    stage_entry[STAGE_OSD] = stage_queue[STAGE_OSD] ? stage_queue[STAGE_OSD] :
+                             (tee ? tee : nvvidconv);
+    if (stage_queue[STAGE_OSD]) chain[n++] = stage_queue[STAGE_OSD];
+    if (tee) chain[n++] = tee;
+    chain[n++] = nvvidconv;
+    chain[n++] = nvosd;
+    stage_entry[STAGE_ENCODE] = out_tee ? out_tee :
+                                (stage_queue[STAGE_ENCODE] ? stage_queue[STAGE_ENCODE] : nvvidconv2);
+    if (out_tee) chain[n++] = out_tee;
+    if (stage_queue[STAGE_ENCODE]) chain[n++] = stage_queue[STAGE_ENCODE];
+    chain[n++] = nvvidconv2;
+    chain[n++] = capsfilter;
+    chain[n++] = encoder;
+    stage_entry[STAGE_OUTPUT] = stage_queue[STAGE_OUTPUT] ? stage_queue[STAGE_OUTPUT] : parser2;
+    if (stage_queue[STAGE_OUTPUT]) chain[n++] = stage_queue[STAGE_OUTPUT];
+    chain[n++] = parser2;
+    chain[n++] = mux;
+    chain[n++] = sink;
+
+    for (guint i = 0; i < n; i++) {
+        gst_bin_add(GST_BIN(ctx->pipeline), chain[i]);
+    }
     g_print("All elements added to pipeline\n");
 
     /* Link elements */
-    if (!gst_element_link(source, demux)) {
-        g_printerr("Failed to link source -> demux\n");
+    // Entrada: la cadena demux/depay -> parser -> decoder se arma cuando se
+    // conocen los caps; los caps llegan al muxer por sink_0 antes del primer frame
+    gboolean linked;
+    GstPad *mux_sink = gst_element_get_request_pad(streammux, "sink_0");
+    gst_pad_add_probe(mux_sink, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+                      mux_caps_probe, ctx, NULL);
+    ctx->ingest->on_decoder = on_ingest_decoder;
+    ctx->ingest->user_data = ctx;
+    linked = ingest_build(ctx->ingest, ctx->pipeline, mux_sink);
+    if (!linked) {
+        g_printerr("Failed to build input stage\n");
+        gst_object_unref(mux_sink);
         return FALSE;
     }
-    g_print("Linked: source -> demux\n");
 
-    g_signal_connect(demux, "pad-added", G_CALLBACK(on_pad_added), parser);
-
-    if (!gst_element_link_many(parser, decoder, NULL)) {
-        g_printerr("Failed to link parser -> decoder\n");
-        return FALSE;
+    /* streammux -> ... -> nvosd -> encoder -> sink */
+    for (guint i = 1; i < n; i++) {
+        if (!gst_element_link(chain[i - 1], chain[i])) {
+            g_printerr("Failed to link %s -> %s\n",
+                       GST_ELEMENT_NAME(chain[i - 1]), GST_ELEMENT_NAME(chain[i]));
+            return FALSE;
+        }
     }
-    g_print("Linked: parser -> decoder\n");
 
-    GstPad *decoder_src = gst_element_get_static_pad(decoder, "src");
-    GstPad *mux_sink = gst_element_get_request_pad(streammux, "sink_0");
-    if (gst_pad_link(decoder_src, mux_sink) != GST_PAD_LINK_OK) {
-        g_printerr("Failed to link decoder -> streammux\n");
-        gst_object_unref(decoder_src);
-        gst_object_unref(mux_sink);
-        return FALSE;
+    if (ctx->stage_timer) {
+        for (gint s = 0; s < STAGE_COUNT; s++) {
+            GstPad *entry = stage_entry[s] ? gst_element_get_static_pad(stage_entry[s], "sink")
+                                           : (GstPad *)gst_object_ref(mux_sink);
+            GstPad *exit = gst_element_get_static_pad(stage_exit[s],
+                                                      s == STAGE_OUTPUT ? "sink" : "src");
+            stage_timer_attach(ctx->stage_timer, (PipelineStage)s, entry, exit);
+            gst_object_unref(entry);
+            gst_object_unref(exit);
+        }
+    }
+    if (ctx->benchmark) {
+        GstPad *encoder_src = gst_element_get_static_pad(encoder, "src");
+        gst_pad_add_probe(encoder_src, GST_PAD_PROBE_TYPE_BUFFER,
+                          benchmark_egress_probe, ctx->benchmark, NULL);
+        gst_object_unref(encoder_src);
     }
-    gst_object_unref(decoder_src);
     gst_object_unref(mux_sink);
-    g_print("Linked: decoder -> streammux\n");
+    topology_install_affinity(ctx->topology, ctx->pipeline);
 
-    if (!gst_element_link_many(streammux, pgie, tracker_elem,
-                               nvvidconv, nvosd,
-                               nvvidconv2, capsfilter,
-                               encoder, parser2, mux, sink, NULL)) {
-        g_printerr("Failed to link main pipeline\n");
+    if (ctx->shm_export && !add_shm_export_branch(ctx, tee)) {
         return FALSE;
     }
+    if (ctx->snapshots && !add_snapshot_branch(ctx, tee)) {
+        return FALSE;
+    }
+    for (gint i = 0; out_tee && i < ctx->config->num_renditions; i++) {
+        UdpRendition rendition;
+        udp_rendition_parse(ctx->config->renditions[i], &rendition);
+        gboolean ok = udp_add_rendition_branch(ctx->pipeline, out_tee, &rendition,
+                                               (guint)i, use_x264,
+                                               (guint)ctx->config->gop_active);
+        udp_rendition_clear(&rendition);
+        if (!ok) return FALSE;
+    }
+    
+    // Con todas las ramas creadas (los elementos dinámicos de la entrada se
+    // instrumentan al agregarse)
+    if (ctx->tracer) {
+        trace_attach(ctx->tracer, ctx->pipeline);
+    }
+    
+    // Con todas las ramas creadas: queues y etapas visibles en las métricas
+    if (ctx->metrics) {
+        metrics_attach(ctx->metrics, ctx->pipeline, ctx->stage_timer, ctx->aggregates);
+        if (ctx->ingest->decode_queue) {
+            metrics_watch_queue(ctx->metrics, ctx->ingest->decode_queue);
+        }
+    }
     
     if (use_udp) {
         g_print("Linked: streammux -> ... -> rtph264pay -> udpsink\n");
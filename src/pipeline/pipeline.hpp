@@ -10,6 +10,24 @@
 #include <glib.h>
 #include "config/app_config.hpp"
 #include "config/track_info.hpp"
+#include "config/live_config.hpp"
+#include "export/shm_export.hpp"
+#include "snapshot/snapshot.hpp"
+#include "encoder/rate_control.hpp"
+#include "stream/latency.hpp"
+#include "ingest/ingest.hpp"
+#include "topology.hpp"
+#include "geometry.hpp"
+#include "stage_timing.hpp"
+#include "benchmark.hpp"
+#include "metrics/metrics.hpp"
+#include "metrics/trace.hpp"
+#include "metrics/resources.hpp"
+#include "log/logger.hpp"
+#include "checkpoint/checkpoint.hpp"
+#include "analytics/heatmap.hpp"
+#include "analytics/trajectory.hpp"
+#include "analytics/aggregates.hpp"
 
 // Contexto del pipeline
 struct PipelineContext {
@@ -17,16 +35,40 @@ struct PipelineContext {
     GMainLoop *loop;
     TrackerContext *tracker;
     AppConfig *config;
-    gint stream_width;   // Resolución para streammux
-    gint stream_height;  // Resolución para streammux
+    IngestStage *ingest;        // Fuente (archivo, RTSP o RTP)
+    gboolean live_source;       // Fuente de red o perfil live: muxer en modo live
+    GstElement *streammux;
+    gint stream_width;   // Resolución de la fuente (provisional hasta los caps)
+    gint stream_height;  // Resolución de la fuente (provisional hasta los caps)
+    gint stream_fps_num; // Framerate de la fuente (0 si se desconoce)
+    gint stream_fps_den;
+    gboolean stream_configured;  // Muxer ajustado a los caps del decoder
+    FrameGeometry geometry;      // Resoluciones de proceso, tracker y salida
+    GstElement *output_caps;     // capsfilter previo al encoder (resolución de salida)
+    gboolean output_system_memory; // x264enc: la salida va a memoria del sistema
+    gdouble first_frame_time;    // Segundos hasta el primer frame (< 0 si aún no)
+    ShmExporter *shm_export;  // NULL si no se exporta a memoria compartida
+    SnapshotContext *snapshots;  // NULL si no se capturan alertas
+    RateController *rate_control;  // Bitrate/GOP del encoder
+    LatencyLog *latency_log;       // NULL si no se registran marcas de ingreso
+    const Topology *topology;      // Fronteras de hilo y afinidad por etapa
+    StageTimer *stage_timer;       // NULL si no se mide latencia por etapa
+    BenchmarkRun *benchmark;       // NULL si no se registra el benchmark
+    MetricsServer *metrics;        // NULL si no se exponen métricas
+    Tracer *tracer;                // NULL si no se generan trazas
+    ResourceSampler *resources;    // NULL si no se muestrean recursos
+    LiveConfig *live_config;       // NULL si no hay reconfiguración en caliente
+    CheckpointWriter *checkpoint;  // NULL si no se guardan checkpoints
+    Heatmap *heatmap;              // NULL si no se acumula el mapa de ocupación
+    TrajectoryRecorder *trajectories;  // NULL si no se registran trayectorias
+    Aggregates *aggregates;        // NULL sin estadísticas en ventanas deslizantes
+    GstClockTime resume_pts;       // Frames anteriores ya contados (reanudación)
+    guint64 frames_processed;
 };
 
 // Crea el pipeline completo
 gboolean pipeline_create(PipelineContext *ctx);
 
-// Callback para pad dinámico del demuxer
-void on_pad_added(GstElement *element, GstPad *pad, gpointer data);
-
 // Bus callback para mensajes
 gboolean bus_call(GstBus *bus, GstMessage *msg, gpointer data);
 
@@ -0,0 +1,95 @@
+/*
+ * stage_timing.cpp
+ * Implementación de la latencia por etapa
+ */
+
+#include "stage_timing.hpp"
+#include <time.h>
+
+static guint64 monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000ULL + (guint64)ts.tv_nsec;
+}
+
+void stage_timer_init(StageTimer *timer) {
+    for (gint s = 0; s < STAGE_COUNT; s++) {
+        StageTiming *st = &timer->stages[s];
+        for (gint i = 0; i < STAGE_TIMING_SLOTS; i++) {
+            st->slots[i].pts.store(GST_CLOCK_TIME_NONE, std::memory_order_relaxed);
+            st->slots[i].enter_ns.store(0, std::memory_order_relaxed);
+        }
+        st->next_slot.store(0, std::memory_order_relaxed);
+        histogram_init(&st->latency);
+        st->max_ns.store(0, std::memory_order_relaxed);
+        st->attached = FALSE;
+    }
+}
+
+static GstPadProbeReturn stage_enter_probe(GstPad *pad, GstPadProbeInfo *info,
+                                           gpointer u_data) {
+    StageTiming *st = (StageTiming *)u_data;
+    GstClockTime pts = GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info));
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return GST_PAD_PROBE_OK;
+
+    guint32 idx = st->next_slot.fetch_add(1, std::memory_order_relaxed) % STAGE_TIMING_SLOTS;
+    st->slots[idx].enter_ns.store(monotonic_ns(), std::memory_order_relaxed);
+    st->slots[idx].pts.store(pts, std::memory_order_release);
+    return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn stage_exit_probe(GstPad *pad, GstPadProbeInfo *info,
+                                          gpointer u_data) {
+    StageTiming *st = (StageTiming *)u_data;
+    GstClockTime pts = GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info));
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return GST_PAD_PROBE_OK;
+
+    guint64 now = monotonic_ns();
+    for (gint i = 0; i < STAGE_TIMING_SLOTS; i++) {
+        if (st->slots[i].pts.load(std::memory_order_acquire) != pts) continue;
+        guint64 enter = st->slots[i].enter_ns.load(std::memory_order_relaxed);
+        if (enter == 0 || enter > now) break;
+
+        guint64 elapsed = now - enter;
+        histogram_observe(&st->latency, elapsed);
+        guint64 prev = st->max_ns.load(std::memory_order_relaxed);
+        while (elapsed > prev &&
+               !st->max_ns.compare_exchange_weak(prev, elapsed, std::memory_order_relaxed)) {
+        }
+        // El slot no vuelve a contar si el buffer sale dos veces (tee)
+        st->slots[i].pts.store(GST_CLOCK_TIME_NONE, std::memory_order_relaxed);
+        break;
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void stage_timer_attach(StageTimer *timer, PipelineStage stage,
+                        GstPad *entry, GstPad *exit) {
+    StageTiming *st = &timer->stages[stage];
+    gst_pad_add_probe(entry, GST_PAD_PROBE_TYPE_BUFFER, stage_enter_probe, st, NULL);
+    gst_pad_add_probe(exit, GST_PAD_PROBE_TYPE_BUFFER, stage_exit_probe, st, NULL);
+    st->attached = TRUE;
+}
+
+gdouble stage_timer_avg_ms(const StageTimer *timer, PipelineStage stage) {
+    const StageTiming *st = &timer->stages[stage];
+    guint64 count = st->latency.count.load(std::memory_order_relaxed);
+    if (count == 0) return 0.0;
+    return st->latency.sum_ns.load(std::memory_order_relaxed) / (gdouble)count / 1e6;
+}
+
+gdouble stage_timer_max_ms(const StageTimer *timer, PipelineStage stage) {
+    return timer->stages[stage].max_ns.load(std::memory_order_relaxed) / 1e6;
+}
+
+void stage_timer_print_summary(const StageTimer *timer) {
+    g_print("Stage latency (avg / max ms):\n");
+    for (gint s = 0; s < STAGE_COUNT; s++) {
+        if (!timer->stages[s].attached) continue;
+        g_print("  %-7s %8.2f / %8.2f  (%" G_GUINT64_FORMAT " frames)\n",
+                topology_stage_name((PipelineStage)s),
+                stage_timer_avg_ms(timer, (PipelineStage)s),
+                stage_timer_max_ms(timer, (PipelineStage)s),
+                timer->stages[s].latency.count.load(std::memory_order_relaxed));
+    }
+}
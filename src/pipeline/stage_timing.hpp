@@ -0,0 +1,53 @@
+/*
+ * stage_timing.hpp
+ * Latencia por etapa del pipeline medida con pad probes
+ *
+ * El probe de entrada de cada etapa guarda (PTS, instante) en un anillo
+ * pequeño; el probe de salida busca el mismo PTS y acumula la diferencia.
+ * Incluye la espera en el queue de la etapa, si lo tiene. Sin locks: cada
+ * anillo tiene un único escritor (el hilo de entrada de la etapa) y las
+ * muestras van a un histograma atómico que también exporta /metrics.
+ */
+
+#ifndef STAGE_TIMING_HPP
+#define STAGE_TIMING_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include <atomic>
+#include "topology.hpp"
+#include "metrics/histogram.hpp"
+
+#define STAGE_TIMING_SLOTS 64
+
+struct StageTimingSlot {
+    std::atomic<guint64> pts;
+    std::atomic<guint64> enter_ns;
+};
+
+// Acumulados de una etapa
+struct StageTiming {
+    StageTimingSlot slots[STAGE_TIMING_SLOTS];
+    std::atomic<guint32> next_slot;
+    Histogram latency;
+    std::atomic<guint64> max_ns;
+    gboolean attached;
+};
+
+struct StageTimer {
+    StageTiming stages[STAGE_COUNT];
+};
+
+void stage_timer_init(StageTimer *timer);
+
+// Instala los probes de la etapa entre la pad de entrada y la de salida
+void stage_timer_attach(StageTimer *timer, PipelineStage stage,
+                        GstPad *entry, GstPad *exit);
+
+// Promedio y máximo en milisegundos (0 si la etapa no tiene muestras)
+gdouble stage_timer_avg_ms(const StageTimer *timer, PipelineStage stage);
+gdouble stage_timer_max_ms(const StageTimer *timer, PipelineStage stage);
+
+void stage_timer_print_summary(const StageTimer *timer);
+
+#endif // STAGE_TIMING_HPP
@@ -0,0 +1,169 @@
+/*
+ * topology.cpp
+ * Implementación de la topología de hilos del pipeline
+ */
+
+#include "topology.hpp"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const gchar *STAGE_NAMES[STAGE_COUNT] = {
+    "mux", "infer", "track", "osd", "encode", "output"
+};
+
+#define DEFAULT_QUEUE_BUFFERS 4
+
+const gchar *topology_stage_name(PipelineStage stage) {
+    return STAGE_NAMES[stage];
+}
+
+static void clear_stages(Topology *topo) {
+    for (gint i = 0; i < STAGE_COUNT; i++) {
+        topo->stages[i].enabled = FALSE;
+        topo->stages[i].max_buffers = DEFAULT_QUEUE_BUFFERS;
+        topo->stages[i].leaky = FALSE;
+        topo->stages[i].cpu = -1;
+    }
+}
+
+void topology_default(Topology *topo, gboolean live) {
+    clear_stages(topo);
+    if (live) {
+        // Decodificación e inferencia separadas, y el encoder en su propio
+        // hilo; siempre se procesa el frame más reciente
+        QueueSpec latest = { TRUE, 1, TRUE, -1 };
+        topo->stages[STAGE_MUX] = latest;
+        topo->stages[STAGE_ENCODE] = latest;
+    }
+}
+
+// Un elemento "<etapa>[:<buffers>][:leaky][@<cpu>]"
+static gboolean parse_item(const gchar *item, Topology *topo) {
+    gchar *copy = g_strstrip(g_strdup(item));
+    gint cpu = -1;
+    gchar *at = strchr(copy, '@');
+    if (at) {
+        *at = '\0';
+        gchar *end;
+        cpu = (gint)strtol(at + 1, &end, 10);
+        if (end == at + 1 || *end != '\0' || cpu < 0 || cpu >= CPU_SETSIZE) {
+            g_free(copy);
+            return FALSE;
+        }
+    }
+
+    gchar **parts = g_strsplit(copy, ":", -1);
+    gint stage = -1;
+    for (gint i = 0; i < STAGE_COUNT; i++) {
+        if (g_strcmp0(parts[0], STAGE_NAMES[i]) == 0) stage = i;
+    }
+
+    gboolean ok = stage >= 0;
+    QueueSpec spec = { TRUE, DEFAULT_QUEUE_BUFFERS, FALSE, cpu };
+    for (guint i = 1; ok && parts[i]; i++) {
+        if (g_strcmp0(parts[i], "leaky") == 0) {
+            spec.leaky = TRUE;
+        } else {
+            gchar *end;
+            glong buffers = strtol(parts[i], &end, 10);
+            ok = end != parts[i] && *end == '\0' && buffers > 0;
+            spec.max_buffers = (guint)buffers;
+        }
+    }
+    if (ok) topo->stages[stage] = spec;
+
+    g_strfreev(parts);
+    g_free(copy);
+    return ok;
+}
+
+gboolean topology_parse(const gchar *spec, Topology *topo) {
+    clear_stages(topo);
+    if (g_strcmp0(spec, "none") == 0) return TRUE;
+
+    gchar **items = g_strsplit(spec, ",", -1);
+    gboolean ok = items[0] != NULL;
+    for (guint i = 0; items[i] && ok; i++) {
+        ok = parse_item(items[i], topo);
+        if (!ok) g_printerr("ERROR: Etapa de topologia invalida '%s'\n", items[i]);
+    }
+    g_strfreev(items);
+    return ok;
+}
+
+gchar *topology_to_string(const Topology *topo) {
+    GString *str = g_string_new(NULL);
+    for (gint i = 0; i < STAGE_COUNT; i++) {
+        const QueueSpec *spec = &topo->stages[i];
+        if (!spec->enabled) continue;
+        if (str->len > 0) g_string_append_c(str, ',');
+        g_string_append_printf(str, "%s:%u", STAGE_NAMES[i], spec->max_buffers);
+        if (spec->leaky) g_string_append(str, ":leaky");
+        if (spec->cpu >= 0) g_string_append_printf(str, "@%d", spec->cpu);
+    }
+    if (str->len == 0) g_string_append(str, "none");
+    return g_string_free(str, FALSE);
+}
+
+void topology_configure_queue(const Topology *topo, PipelineStage stage, GstElement *queue) {
+    const QueueSpec *spec = &topo->stages[stage];
+    g_object_set(G_OBJECT(queue),
+                 "leaky", spec->leaky ? 2 : 0,
+                 "max-size-buffers", spec->max_buffers,
+                 "max-size-bytes", 0,
+                 "max-size-time", (guint64)0,
+                 NULL);
+}
+
+GstElement *topology_make_queue(const Topology *topo, PipelineStage stage) {
+    if (!topo->stages[stage].enabled) return NULL;
+    gchar *name = g_strdup_printf("queue-%s", STAGE_NAMES[stage]);
+    GstElement *queue = gst_element_factory_make("queue", name);
+    g_free(name);
+    if (queue) topology_configure_queue(topo, stage, queue);
+    return queue;
+}
+
+// STREAM_STATUS ENTER se publica desde el hilo que va a correr la tarea: el
+// handler síncrono puede fijar la afinidad de ese hilo directamente
+static GstBusSyncReply affinity_sync_handler(GstBus *bus, GstMessage *msg, gpointer data) {
+    const Topology *topo = (const Topology *)data;
+    if (GST_MESSAGE_TYPE(msg) != GST_MESSAGE_STREAM_STATUS) return GST_BUS_PASS;
+
+    GstStreamStatusType type;
+    GstElement *owner;
+    gst_message_parse_stream_status(msg, &type, &owner);
+    if (type != GST_STREAM_STATUS_TYPE_ENTER || !owner) return GST_BUS_PASS;
+
+    const gchar *name = GST_ELEMENT_NAME(owner);
+    if (!g_str_has_prefix(name, "queue-")) return GST_BUS_PASS;
+    for (gint i = 0; i < STAGE_COUNT; i++) {
+        const QueueSpec *spec = &topo->stages[i];
+        if (spec->cpu < 0 || g_strcmp0(name + 6, STAGE_NAMES[i]) != 0) continue;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(spec->cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+            g_print("Topology: %s thread pinned to CPU %d\n", STAGE_NAMES[i], spec->cpu);
+        } else {
+            g_printerr("Topology: could not pin %s thread to CPU %d\n",
+                       STAGE_NAMES[i], spec->cpu);
+        }
+    }
+    return GST_BUS_PASS;
+}
+
+void topology_install_affinity(const Topology *topo, GstElement *pipeline) {
+    gboolean any = FALSE;
+    for (gint i = 0; i < STAGE_COUNT; i++) {
+        any = any || (topo->stages[i].enabled && topo->stages[i].cpu >= 0);
+    }
+    if (!any) return;
+
+    GstBus *bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
+    gst_bus_set_sync_handler(bus, affinity_sync_handler, (gpointer)topo, NULL);
+    gst_object_unref(bus);
+}
@@ -0,0 +1,62 @@
+/*
+ * topology.hpp
+ * Topología de hilos del pipeline: dónde van los queue, su tamaño, su
+ * política de descarte y a qué CPU se fija cada hilo de streaming
+ *
+ * Especificación (--topology), elementos separados por coma:
+ *   <etapa>[:<buffers>][:leaky][@<cpu>]
+ * Etapas: mux, infer, track, osd, encode, output. El queue se coloca a la
+ * entrada de la etapa, por lo que la etapa corre en su propio hilo.
+ *   "none"                      -> sin queues (todo en el hilo de la fuente)
+ *   "infer:4,osd:2:leaky@2"     -> hilo propio para inferencia y para OSD
+ */
+
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+
+enum PipelineStage {
+    STAGE_MUX,      // decoder -> nvstreammux
+    STAGE_INFER,    // nvstreammux -> nvinfer
+    STAGE_TRACK,    // nvinfer -> nvtracker
+    STAGE_OSD,      // nvtracker -> (tee auxiliar) -> nvvideoconvert -> nvdsosd
+    STAGE_ENCODE,   // nvdsosd -> conversión -> encoder
+    STAGE_OUTPUT,   // encoder -> parser -> mux/payloader -> sink
+    STAGE_COUNT
+};
+
+// Frontera de hilo a la entrada de una etapa
+struct QueueSpec {
+    gboolean enabled;
+    guint max_buffers;
+    gboolean leaky;      // Descarta los buffers más viejos en vez de bloquear
+    gint cpu;            // Núcleo del hilo del queue (-1 = sin afinidad)
+};
+
+struct Topology {
+    QueueSpec stages[STAGE_COUNT];
+};
+
+// Topología por defecto del perfil (live: colas de un frame que descartan)
+void topology_default(Topology *topo, gboolean live);
+
+// Interpreta una especificación; FALSE si es inválida
+gboolean topology_parse(const gchar *spec, Topology *topo);
+
+// Representación canónica (para reportes y benchmarks), liberar con g_free
+gchar *topology_to_string(const Topology *topo);
+
+const gchar *topology_stage_name(PipelineStage stage);
+
+// Crea el queue "queue-<etapa>" (NULL si la etapa no tiene frontera)
+GstElement *topology_make_queue(const Topology *topo, PipelineStage stage);
+
+// Aplica los tamaños/política de la etapa a un queue existente
+void topology_configure_queue(const Topology *topo, PipelineStage stage, GstElement *queue);
+
+// Fija la afinidad de los hilos de los queues al iniciar sus tareas
+void topology_install_affinity(const Topology *topo, GstElement *pipeline);
+
+#endif // TOPOLOGY_HPP
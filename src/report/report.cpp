@@ -4,43 +4,147 @@
  */
 
 #include "report.hpp"
-#include <fstream>
-#include <iomanip>
+#include "report_store.hpp"
+#include "text_format.hpp"
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
 
-void generate_report(const TrackerContext *ctx, const gchar *report_file) {
-    std::ofstream report(report_file);
-    if (!report.is_open()) {
+void generate_report(const TrackerContext *ctx, const gchar *report_file,
+                     const ReportExtras *extras) {
+    FILE *file = fopen(report_file, "w");
+    if (!file) {
         g_printerr("Error: No se pudo crear el reporte\n");
         return;
     }
+    static TextWriter report;   // 64 KiB: fuera de la pila
+    text_open(&report, file);
     
-    gint roi_left = (gint)(ctx->roi.x * ctx->source_width);
-    gint roi_top = (gint)(ctx->roi.y * ctx->source_height);
-    gint roi_width = (gint)(ctx->roi.w * ctx->source_width);
-    gint roi_height = (gint)(ctx->roi.h * ctx->source_height);
-    
-    report << "ROI: left: " << roi_left << " top: " << roi_top 
-           << " width: " << roi_width << " height: " << roi_height << "\n";
-    report << "Max time: " << ctx->max_time_seconds << "s\n";
-    report << "Detected: " << ctx->total_detected << " (" 
-           << ctx->total_alerts << ")\n";
+    // Configuración vigente al terminar (puede haber cambiado en caliente)
+    const TrackerConfig *config = ctx->config;
+    for (guint z = 0; z < config->num_rois; z++) {
+        const ROIParams &roi = config->rois[z];
+        // En píxeles de la fuente aunque se haya procesado a otra resolución
+        text_str(&report, "ROI: left: ");
+        text_i64(&report, (gint)(roi.x * ctx->source_width));
+        text_str(&report, " top: ");
+        text_i64(&report, (gint)(roi.y * ctx->source_height));
+        text_str(&report, " width: ");
+        text_i64(&report, (gint)(roi.w * ctx->source_width));
+        text_str(&report, " height: ");
+        text_i64(&report, (gint)(roi.h * ctx->source_height));
+        text_char(&report, '\n');
+    }
+    if (ctx->frame_width > 0 && (ctx->frame_width != ctx->source_width ||
+                                 ctx->frame_height != ctx->source_height)) {
+        text_str(&report, "Processing: ");
+        text_i64(&report, ctx->frame_width);
+        text_char(&report, 'x');
+        text_i64(&report, ctx->frame_height);
+        text_str(&report, " (source ");
+        text_i64(&report, ctx->source_width);
+        text_char(&report, 'x');
+        text_i64(&report, ctx->source_height);
+        text_str(&report, ")\n");
+    }
+    text_str(&report, "Max time: ");
+    text_i64(&report, config->max_time_seconds);
+    text_str(&report, "s\nDetected: ");
+    text_u64(&report, ctx->total_detected);
+    text_str(&report, " (");
+    text_u64(&report, ctx->total_alerts);
+    text_str(&report, ")\n");
     
+    // Por orden de entrada (la tabla del tracker no tiene orden)
+    std::vector<const TrackInfo *> rows;
+    rows.reserve(ctx->tracked_objects.size());
     for (const auto &pair : ctx->tracked_objects) {
         const TrackInfo &info = pair.second;
         gdouble time_in_roi = (info.state != STATE_OUTSIDE) ? 
-                              g_timer_elapsed(info.timer, NULL) : info.total_time;
+                              tracker_time_in_roi(&info) : info.total_time;
+        if (time_in_roi > 0.1) rows.push_back(&info);
+    }
+    std::sort(rows.begin(), rows.end(), [](const TrackInfo *a, const TrackInfo *b) {
+        return a->entry_timestamp != b->entry_timestamp
+               ? a->entry_timestamp < b->entry_timestamp : a->track_id < b->track_id;
+    });
+    
+    for (const TrackInfo *info : rows) {
+        gdouble time_in_roi = (info->state != STATE_OUTSIDE) ? 
+                              tracker_time_in_roi(info) : info->total_time;
+        guint64 entry = (guint64)info->entry_timestamp;
+        text_u64(&report, entry / 60);
+        text_char(&report, ':');
+        text_u64_padded(&report, entry % 60, 2);
+        text_char(&report, ' ');
+        text_str(&report, info->class_name ? info->class_name : "object");
+        text_str(&report, " time ");
+        text_i64(&report, (gint)time_in_roi);
+        text_char(&report, 's');
+        if (info->alert_triggered) text_str(&report, " alert");
+        if (info->snapshot_path) {
+            text_str(&report, " snapshot ");
+            text_str(&report, info->snapshot_path);
+        }
+        text_char(&report, '\n');
+    }
+    
+    if (extras && extras->rate_control && extras->rate_control->cfg.enabled) {
+        const RateController *rc = extras->rate_control;
+        text_str(&report, "Adaptive bitrate: saved ");
+        text_fixed(&report, rate_control_saved_mb_per_hour(rc), 1);
+        text_str(&report, " MB/h, idle ");
+        text_fixed(&report, rc->total_seconds > 0.0 ? 100.0 * rc->idle_seconds / rc->total_seconds : 0.0, 1);
+        text_str(&report, "%\n");
+    }
+    
+    if (extras && extras->resources && extras->resources->samples > 0) {
+        const ResourceSampler *rs = extras->resources;
+        text_str(&report, "Resources: peak RSS ");
+        text_fixed(&report, rs->peak_rss_kb / 1024.0, 1);
+        text_str(&report, " MB, mean CPU ");
+        text_fixed(&report, rs->wall_s > 0.0 ? 100.0 * rs->cpu_s / rs->wall_s : 0.0, 1);
+        text_char(&report, '%');
+        if (rs->gpu_samples > 0) {
+            text_str(&report, ", mean GPU ");
+            text_fixed(&report, rs->gpu_load_sum / rs->gpu_samples, 1);
+            text_char(&report, '%');
+        }
+        text_char(&report, '\n');
         
-        if (time_in_roi > 0.1) {
-            gint minutes = (gint)(info.entry_timestamp / 60);
-            gint seconds = (gint)(info.entry_timestamp) % 60;
-            report << minutes << ":" << std::setfill('0') << std::setw(2) << seconds 
-                   << " " << (info.class_name ? info.class_name : "object")
-                   << " time " << (gint)time_in_roi << "s";
-            if (info.alert_triggered) report << " alert";
-            report << "\n";
+        const gchar *names[6];
+        gdouble cpu[6];
+        guint n = resource_sampler_top_threads(rs, 6, names, cpu);
+        for (guint i = 0; i < n; i++) {
+            text_str(&report, "Thread ");
+            text_str(&report, names[i]);
+            text_str(&report, " CPU ");
+            text_fixed(&report, cpu[i], 1);
+            text_str(&report, "%\n");
+        }
+    }
+    
+    if (extras && extras->aggregates) {
+        AggView view;
+        aggregates_read(extras->aggregates, &view);
+        for (gint w = 0; w < AGG_WINDOWS; w++) {
+            gchar line[160];
+            aggregates_format_window(&view.windows[w], line, sizeof(line));
+            text_str(&report, "Window ");
+            text_str(&report, line);
+            text_char(&report, '\n');
         }
     }
     
-    report.close();
-    g_print("Reporte generado: %s\n", report_file);
+    text_flush(&report);
+    gboolean failed = report.failed;
+    if (fclose(file) != 0 || failed) {
+        g_printerr("Error: No se pudo escribir el reporte\n");
+    } else {
+        g_print("Reporte generado: %s\n", report_file);
+    }
+    
+    if (extras && extras->store_file) {
+        report_store_write(extras->store_file, ctx, rows);
+    }
 }
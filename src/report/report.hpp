@@ -8,8 +8,20 @@
 
 #include <glib.h>
 #include "config/track_info.hpp"
+#include "encoder/rate_control.hpp"
+#include "metrics/resources.hpp"
+#include "analytics/aggregates.hpp"
+
+// Secciones opcionales del reporte (NULL = no se incluyen)
+struct ReportExtras {
+    const RateController *rate_control;
+    const ResourceSampler *resources;   // Ya detenido (resource_sampler_stop)
+    const Aggregates *aggregates;       // Ventanas al final de la corrida
+    const gchar *store_file;            // Reporte columnar (--report-store)
+};
 
 // Genera el reporte final con estadísticas
-void generate_report(const TrackerContext *ctx, const gchar *report_file);
+void generate_report(const TrackerContext *ctx, const gchar *report_file,
+                     const ReportExtras *extras);
 
 #endif // REPORT_H
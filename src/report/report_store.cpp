@@ -0,0 +1,107 @@
+/*
+ * report_store.cpp
+ * Implementación de la escritura del reporte columnar
+ */
+
+#include "report_store.hpp"
+#include <stdio.h>
+#include <string.h>
+
+static inline guint64 to_ms(gdouble seconds) {
+    return seconds > 0.0 ? (guint64)(seconds * 1000.0 + 0.5) : 0;
+}
+
+// Escribe una columna y rellena hasta múltiplo de 8
+template <typename T>
+static gboolean write_column(FILE *f, const std::vector<T> &values, guint64 *offset) {
+    static const guint8 zeros[8] = { 0 };
+    gsize bytes = values.size() * sizeof(T);
+    gsize pad = (8 - bytes % 8) % 8;
+    gboolean ok = (bytes == 0 || fwrite(values.data(), 1, bytes, f) == bytes) &&
+                  (pad == 0 || fwrite(zeros, 1, pad, f) == pad);
+    *offset += bytes + pad;
+    return ok;
+}
+
+gboolean report_store_write(const gchar *path, const TrackerContext *ctx,
+                            const std::vector<const TrackInfo *> &rows) {
+    gsize n = rows.size();
+    std::vector<guint64> track_id(n), entry_ms(n), exit_ms(n);
+    std::vector<guint32> dwell_ms(n);
+    std::vector<guint16> class_id(n);
+    std::vector<gint8> zone(n);
+    std::vector<guint8> flags(n);
+
+    ReportStoreHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, REPORT_STORE_MAGIC, sizeof(header.magic));
+    header.version = REPORT_STORE_VERSION;
+    header.index_stride = REPORT_STORE_INDEX_STRIDE;
+    header.num_rows = n;
+    header.num_index = (n + REPORT_STORE_INDEX_STRIDE - 1) / REPORT_STORE_INDEX_STRIDE;
+    gdouble now = tracker_now(ctx);
+    header.start_unix_ms = g_get_real_time() / 1000 - (gint64)to_ms(now);
+
+    std::vector<guint64> index;
+    index.reserve(header.num_index);
+    for (gsize i = 0; i < n; i++) {
+        const TrackInfo *info = rows[i];
+        gboolean inside = info->state != STATE_OUTSIDE;
+        gdouble dwell = inside ? tracker_time_in_roi(info) : info->total_time;
+        track_id[i] = info->track_id & ~TRACKER_RESUMED_KEY;
+        entry_ms[i] = to_ms(info->entry_timestamp);
+        exit_ms[i] = entry_ms[i] + to_ms(dwell);
+        dwell_ms[i] = (guint32)MIN(to_ms(dwell), (guint64)G_MAXUINT32);
+        class_id[i] = (guint16)CLAMP(info->class_id, 0, G_MAXUINT16);
+        zone[i] = (gint8)CLAMP(info->entry_zone, -1, 127);
+        flags[i] = (info->alert_triggered ? REPORT_FLAG_ALERT : 0) |
+                   (inside ? REPORT_FLAG_INSIDE : 0) |
+                   (info->entry_timestamp < ctx->time_offset ? REPORT_FLAG_RESUMED : 0);
+        if (i % REPORT_STORE_INDEX_STRIDE == 0) index.push_back(entry_ms[i]);
+
+        guint cls = (guint)info->class_id;
+        if (cls < REPORT_STORE_MAX_CLASSES && info->class_name &&
+            header.class_names[cls][0] == '\0') {
+            g_strlcpy(header.class_names[cls], info->class_name, REPORT_STORE_CLASS_NAME);
+        }
+    }
+
+    gchar *tmp_path = g_strdup_printf("%s.tmp", path);
+    FILE *f = fopen(tmp_path, "wb");
+    if (!f) {
+        g_printerr("Report store: could not write %s\n", tmp_path);
+        g_free(tmp_path);
+        return FALSE;
+    }
+    // Encabezado provisional; los desplazamientos se conocen al escribir
+    guint64 offset = (sizeof(header) + 7) / 8 * 8;
+    gboolean ok = fseek(f, (long)offset, SEEK_SET) == 0;
+    header.column_offset[REPORT_COL_TRACK_ID] = offset;
+    ok = ok && write_column(f, track_id, &offset);
+    header.column_offset[REPORT_COL_ENTRY_MS] = offset;
+    ok = ok && write_column(f, entry_ms, &offset);
+    header.column_offset[REPORT_COL_EXIT_MS] = offset;
+    ok = ok && write_column(f, exit_ms, &offset);
+    header.column_offset[REPORT_COL_DWELL_MS] = offset;
+    ok = ok && write_column(f, dwell_ms, &offset);
+    header.column_offset[REPORT_COL_CLASS_ID] = offset;
+    ok = ok && write_column(f, class_id, &offset);
+    header.column_offset[REPORT_COL_ZONE] = offset;
+    ok = ok && write_column(f, zone, &offset);
+    header.column_offset[REPORT_COL_FLAGS] = offset;
+    ok = ok && write_column(f, flags, &offset);
+    header.index_offset = offset;
+    ok = ok && write_column(f, index, &offset);
+    ok = ok && fseek(f, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = (fclose(f) == 0) && ok;
+    ok = ok && rename(tmp_path, path) == 0;
+    if (!ok) {
+        g_printerr("Report store: error writing %s\n", path);
+        remove(tmp_path);
+        g_free(tmp_path);
+        return FALSE;
+    }
+    g_free(tmp_path);
+    g_print("Report store: %" G_GSIZE_FORMAT " rows -> %s\n", n, path);
+    return TRUE;
+}
@@ -0,0 +1,18 @@
+/*
+ * report_store.hpp
+ * Escritura del reporte columnar (--report-store)
+ */
+
+#ifndef REPORT_STORE_HPP
+#define REPORT_STORE_HPP
+
+#include <glib.h>
+#include <vector>
+#include "config/track_info.hpp"
+#include "report_store_file.hpp"
+
+// rows: los tracks del reporte ya ordenados por entry_timestamp
+gboolean report_store_write(const gchar *path, const TrackerContext *ctx,
+                            const std::vector<const TrackInfo *> &rows);
+
+#endif // REPORT_STORE_HPP
@@ -0,0 +1,87 @@
+/*
+ * report_store_file.cpp
+ * Lectura del formato columnar del reporte
+ */
+
+#include "report_store_file.hpp"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+size_t report_column_width(ReportColumn column) {
+    switch (column) {
+        case REPORT_COL_TRACK_ID:
+        case REPORT_COL_ENTRY_MS:
+        case REPORT_COL_EXIT_MS:  return 8;
+        case REPORT_COL_DWELL_MS: return 4;
+        case REPORT_COL_CLASS_ID: return 2;
+        default:                  return 1;
+    }
+}
+
+// La columna cabe en el archivo y está alineada
+static bool column_ok(const ReportStore *store, uint64_t offset, uint64_t count, size_t width) {
+    return offset % 8 == 0 && offset <= store->size &&
+           count <= (store->size - offset) / width;
+}
+
+bool report_store_open(ReportStore *store, const char *path) {
+    memset(store, 0, sizeof(*store));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ReportStoreHeader)) {
+        close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    store->map = (const uint8_t *)map;
+    store->size = (size_t)st.st_size;
+    store->header = (const ReportStoreHeader *)map;
+
+    const ReportStoreHeader *h = store->header;
+    bool ok = memcmp(h->magic, REPORT_STORE_MAGIC, sizeof(h->magic)) == 0 &&
+              h->version == REPORT_STORE_VERSION && h->index_stride > 0 &&
+              h->num_index == (h->num_rows + h->index_stride - 1) / h->index_stride &&
+              column_ok(store, h->index_offset, h->num_index, sizeof(uint64_t));
+    for (int c = 0; ok && c < REPORT_COL_COUNT; c++) {
+        ok = column_ok(store, h->column_offset[c], h->num_rows,
+                       report_column_width((ReportColumn)c));
+    }
+    if (!ok) {
+        report_store_close(store);
+        return false;
+    }
+    store->track_id = (const uint64_t *)(store->map + h->column_offset[REPORT_COL_TRACK_ID]);
+    store->entry_ms = (const uint64_t *)(store->map + h->column_offset[REPORT_COL_ENTRY_MS]);
+    store->exit_ms = (const uint64_t *)(store->map + h->column_offset[REPORT_COL_EXIT_MS]);
+    store->dwell_ms = (const uint32_t *)(store->map + h->column_offset[REPORT_COL_DWELL_MS]);
+    store->class_id = (const uint16_t *)(store->map + h->column_offset[REPORT_COL_CLASS_ID]);
+    store->zone = (const int8_t *)(store->map + h->column_offset[REPORT_COL_ZONE]);
+    store->flags = store->map + h->column_offset[REPORT_COL_FLAGS];
+    store->index = (const uint64_t *)(store->map + h->index_offset);
+    return true;
+}
+
+uint64_t report_store_seek(const ReportStore *store, uint64_t from_ms) {
+    const ReportStoreHeader *h = store->header;
+    // Último bloque que empieza antes de from_ms
+    uint64_t lo = 0, hi = h->num_index;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (store->index[mid] < from_ms) lo = mid + 1;
+        else hi = mid;
+    }
+    uint64_t row = lo > 0 ? (lo - 1) * h->index_stride : 0;
+    while (row < h->num_rows && store->entry_ms[row] < from_ms) row++;
+    return row;
+}
+
+void report_store_close(ReportStore *store) {
+    if (store->map) munmap((void *)store->map, store->size);
+    memset(store, 0, sizeof(*store));
+}
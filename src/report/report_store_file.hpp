@@ -0,0 +1,81 @@
+/*
+ * report_store_file.hpp
+ * Formato columnar del reporte y lectura por mmap
+ *
+ * Compartido por roi_surveillance y tools/report_query; no depende de
+ * GLib/GStreamer. Una fila por vehículo que pasó por el ROI, ordenadas por
+ * tiempo de entrada. Cada columna es un arreglo de ancho fijo alineado a
+ * 8 bytes, así que una consulta solo toca las columnas que filtra. El índice
+ * guarda la entrada de una fila de cada REPORT_STORE_INDEX_STRIDE: una
+ * búsqueda binaria sobre él ubica el bloque donde empieza un rango de tiempo.
+ *
+ * Archivo: ReportStoreHeader, las columnas (en el orden de ReportColumn) y el
+ * índice, en los desplazamientos que indica el encabezado.
+ */
+
+#ifndef REPORT_STORE_FILE_HPP
+#define REPORT_STORE_FILE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define REPORT_STORE_MAGIC "ROICOLS1"
+#define REPORT_STORE_VERSION 1
+#define REPORT_STORE_INDEX_STRIDE 256
+#define REPORT_STORE_MAX_CLASSES 64
+#define REPORT_STORE_CLASS_NAME 16
+
+#define REPORT_FLAG_ALERT   0x01       // Disparó la alerta de permanencia
+#define REPORT_FLAG_INSIDE  0x02       // Seguía en el ROI al terminar
+#define REPORT_FLAG_RESUMED 0x04       // Viene de una corrida anterior (checkpoint)
+
+enum ReportColumn {
+    REPORT_COL_TRACK_ID,               // uint64_t
+    REPORT_COL_ENTRY_MS,               // uint64_t, desde el inicio de la corrida
+    REPORT_COL_EXIT_MS,                // uint64_t
+    REPORT_COL_DWELL_MS,               // uint32_t
+    REPORT_COL_CLASS_ID,               // uint16_t
+    REPORT_COL_ZONE,                   // int8_t, ROI de entrada (-1 = sin zona)
+    REPORT_COL_FLAGS,                  // uint8_t, REPORT_FLAG_*
+    REPORT_COL_COUNT
+};
+
+struct ReportStoreHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t index_stride;
+    uint64_t num_rows;
+    uint64_t num_index;
+    int64_t  start_unix_ms;            // Hora real del tiempo 0 (UTC, ms)
+    uint64_t column_offset[REPORT_COL_COUNT];
+    uint64_t index_offset;             // uint64_t entry_ms por bloque
+    char     class_names[REPORT_STORE_MAX_CLASSES][REPORT_STORE_CLASS_NAME];
+};
+
+// Bytes de cada valor de la columna
+size_t report_column_width(ReportColumn column);
+
+// Vista de solo lectura de un archivo mapeado
+struct ReportStore {
+    const uint8_t *map;
+    size_t size;
+    const ReportStoreHeader *header;
+    const uint64_t *track_id;
+    const uint64_t *entry_ms;
+    const uint64_t *exit_ms;
+    const uint32_t *dwell_ms;
+    const uint16_t *class_id;
+    const int8_t *zone;
+    const uint8_t *flags;
+    const uint64_t *index;
+};
+
+// Mapea y valida el archivo; false si no existe, está truncado o no es del formato
+bool report_store_open(ReportStore *store, const char *path);
+
+// Primera fila con entry_ms >= from_ms (num_rows si no hay)
+uint64_t report_store_seek(const ReportStore *store, uint64_t from_ms);
+
+void report_store_close(ReportStore *store);
+
+#endif // REPORT_STORE_FILE_HPP
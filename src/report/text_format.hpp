@@ -0,0 +1,145 @@
+/*
+ * text_format.hpp
+ * Escritura de texto con búfer y formato de números sin iostreams
+ *
+ * Compartido por el reporte y tools/report_query; no depende de GLib. Los
+ * enteros se convierten de a dos dígitos con una tabla (como std::to_chars,
+ * que g++ 7 no trae) y los decimales con punto fijo redondeado, sin pasar
+ * por el locale. El búfer se vuelca al FILE* solo cuando se llena.
+ */
+
+#ifndef TEXT_FORMAT_HPP
+#define TEXT_FORMAT_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEXT_WRITER_BUFFER (64 * 1024)
+
+struct TextWriter {
+    FILE *file;
+    size_t used;
+    bool failed;                       // Algún fwrite falló
+    char buf[TEXT_WRITER_BUFFER];
+};
+
+static inline void text_open(TextWriter *w, FILE *file) {
+    w->file = file;
+    w->used = 0;
+    w->failed = false;
+}
+
+static inline void text_flush(TextWriter *w) {
+    if (w->used && fwrite(w->buf, 1, w->used, w->file) != w->used) w->failed = true;
+    w->used = 0;
+}
+
+// Espacio para n bytes más (n <= TEXT_WRITER_BUFFER)
+static inline char *text_reserve(TextWriter *w, size_t n) {
+    if (w->used + n > sizeof(w->buf)) text_flush(w);
+    return w->buf + w->used;
+}
+
+static inline void text_bytes(TextWriter *w, const char *s, size_t n) {
+    if (n > sizeof(w->buf)) {
+        text_flush(w);
+        if (fwrite(s, 1, n, w->file) != n) w->failed = true;
+        return;
+    }
+    memcpy(text_reserve(w, n), s, n);
+    w->used += n;
+}
+
+static inline void text_str(TextWriter *w, const char *s) {
+    text_bytes(w, s, strlen(s));
+}
+
+static inline void text_char(TextWriter *w, char c) {
+    *text_reserve(w, 1) = c;
+    w->used++;
+}
+
+static const char TEXT_DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Dígitos de v al final de end; devuelve el inicio
+static inline char *text_format_u64(uint64_t v, char *end) {
+    char *p = end;
+    while (v >= 100) {
+        const char *pair = &TEXT_DIGIT_PAIRS[(v % 100) * 2];
+        v /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (v >= 10) {
+        *--p = TEXT_DIGIT_PAIRS[v * 2 + 1];
+        *--p = TEXT_DIGIT_PAIRS[v * 2];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    return p;
+}
+
+static inline void text_u64(TextWriter *w, uint64_t v) {
+    char tmp[20];
+    char *start = text_format_u64(v, tmp + sizeof(tmp));
+    text_bytes(w, start, tmp + sizeof(tmp) - start);
+}
+
+static inline void text_i64(TextWriter *w, int64_t v) {
+    if (v < 0) {
+        text_char(w, '-');
+        text_u64(w, 0 - (uint64_t)v);
+    } else {
+        text_u64(w, (uint64_t)v);
+    }
+}
+
+// v con width dígitos como mínimo, rellenado con ceros (p.ej. segundos "07")
+static inline void text_u64_padded(TextWriter *w, uint64_t v, int width) {
+    char tmp[20];
+    char *start = text_format_u64(v, tmp + sizeof(tmp));
+    for (int n = (int)(tmp + sizeof(tmp) - start); n < width && n < 20; n++) text_char(w, '0');
+    text_bytes(w, start, tmp + sizeof(tmp) - start);
+}
+
+// Punto fijo con decimals decimales (0 a 9), redondeado
+static inline void text_fixed(TextWriter *w, double v, int decimals) {
+    if (v != v) {
+        text_str(w, "nan");
+        return;
+    }
+    if (v < 0) {
+        text_char(w, '-');
+        v = -v;
+    }
+    uint64_t scale = 1;
+    for (int i = 0; i < decimals; i++) scale *= 10;
+    if (v * scale >= 1.8e19) {
+        char tmp[64];
+        int n = snprintf(tmp, sizeof(tmp), "%.*f", decimals, v);
+        text_bytes(w, tmp, (size_t)n);
+        return;
+    }
+    // La parte entera aparte: la fracción se escala sin perder precisión;
+    // los empates exactos van al par, como printf
+    uint64_t whole = (uint64_t)v;
+    double scaled = (v - (double)whole) * scale;
+    uint64_t frac = (uint64_t)scaled;
+    double rest = scaled - (double)frac;
+    if (rest > 0.5 || (rest == 0.5 && (decimals > 0 ? frac : whole) % 2 == 1)) frac++;
+    if (frac >= scale) {
+        whole++;
+        frac -= scale;
+    }
+    text_u64(w, whole);
+    if (decimals > 0) {
+        text_char(w, '.');
+        text_u64_padded(w, frac, decimals);
+    }
+}
+
+#endif // TEXT_FORMAT_HPP
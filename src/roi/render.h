@@ -9,13 +9,17 @@
 #include <gst/gst.h>
 #include <glib.h>
 #include "app_config.hpp"
+#include "config/track_info.hpp"
 #include "gstnvdsmeta.h"
 
 // Utilidad para asignar colores
 void set_color(NvOSD_ColorParams &c, float r, float g, float b, float a = 1.0f);
 
-// Dibuja el rectángulo del ROI
+// Dibuja el rectángulo de cada ROI; el color de cada uno según su bit en
+// zones_inside/zones_alert. frame_width/frame_height: resolución de proceso
+// (la salida de nvstreammux, donde dibuja el OSD)
 void draw_roi_rect(NvDsBatchMeta *batch_meta, NvDsFrameMeta *fmeta,
-                   const ROIParams *roi, gboolean any_inside, gboolean any_alert);
+                   const TrackerConfig *config, guint32 zones_inside, guint32 zones_alert,
+                   gint frame_width, gint frame_height);
 
 #endif // RENDER_H
@@ -0,0 +1,399 @@
+/*
+ * snapshot.cpp
+ * Implementación de las capturas JPEG de alertas
+ */
+
+#include "snapshot.hpp"
+#include <gst/video/video.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+
+// Manejo de errores de libjpeg sin terminar el proceso
+struct JpegErrorMgr {
+    struct jpeg_error_mgr pub;
+    jmp_buf jump;
+};
+
+static void jpeg_error_exit(j_common_ptr cinfo) {
+    JpegErrorMgr *err = (JpegErrorMgr *)cinfo->err;
+    longjmp(err->jump, 1);
+}
+
+static gboolean write_jpeg(const gchar *path, const guint8 *rgba,
+                           gint width, gint height, gint quality) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return FALSE;
+
+    struct jpeg_compress_struct cinfo;
+    JpegErrorMgr jerr;
+    guint8 *row = (guint8 *)g_malloc((gsize)width * 3);
+
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = jpeg_error_exit;
+    if (setjmp(jerr.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        g_free(row);
+        fclose(file);
+        remove(path);
+        return FALSE;
+    }
+
+    jpeg_create_compress(&cinfo);
+    jpeg_stdio_dest(&cinfo, file);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    while (cinfo.next_scanline < cinfo.image_height) {
+        const guint8 *src = rgba + (gsize)cinfo.next_scanline * width * 4;
+        for (gint x = 0; x < width; x++) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        JSAMPROW row_ptr = row;
+        jpeg_write_scanlines(&cinfo, &row_ptr, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    g_free(row);
+    return fclose(file) == 0;
+}
+
+static void snapshot_job_free(SnapshotJob *job) {
+    g_free(job->pixels);
+    g_free(job->path);
+    g_free(job);
+}
+
+static void snapshot_log(SnapshotContext *snap, const SnapshotJob *job, const gchar *status) {
+    if (!snap->log) return;
+    g_mutex_lock(&snap->log_lock);
+    fprintf(snap->log, "%" G_GUINT64_FORMAT ",%" G_GUINT64_FORMAT ",%s,%s\n",
+            job->pts / GST_MSECOND, job->track_id, status, job->path);
+    fflush(snap->log);
+    g_mutex_unlock(&snap->log_lock);
+}
+
+static gpointer snapshot_worker(gpointer data) {
+    SnapshotContext *snap = (SnapshotContext *)data;
+
+    for (;;) {
+        g_mutex_lock(&snap->queue_lock);
+        while (snap->count == 0 && !snap->stopping) {
+            g_cond_wait(&snap->queue_cond, &snap->queue_lock);
+        }
+        if (snap->count == 0) {
+            // stopping y cola vacía
+            g_mutex_unlock(&snap->queue_lock);
+            break;
+        }
+        SnapshotJob *job = snap->jobs[snap->head];
+        snap->head = (snap->head + 1) % snap->capacity;
+        snap->count--;
+        snap->active++;
+        g_mutex_unlock(&snap->queue_lock);
+
+        gboolean ok = write_jpeg(job->path, job->pixels, job->width, job->height,
+                                 snap->quality);
+        snapshot_log(snap, job, ok ? "written" : "failed");
+        g_free(job->pixels);
+        job->pixels = NULL;
+
+        g_mutex_lock(&snap->queue_lock);
+        if (ok) {
+            snap->written++;
+            g_ptr_array_add(snap->written_jobs, job);
+            snap->written_hint.store(snap->written_jobs->len, std::memory_order_release);
+        } else {
+            snap->failed++;
+        }
+        snap->active--;
+        if (snap->count == 0 && snap->active == 0) g_cond_broadcast(&snap->idle_cond);
+        g_mutex_unlock(&snap->queue_lock);
+
+        if (!ok) snapshot_job_free(job);
+    }
+    return NULL;
+}
+
+// Encola un trabajo; si el pool está saturado se descarta el más antiguo
+static void snapshot_push_job(SnapshotContext *snap, SnapshotJob *job) {
+    SnapshotJob *evicted = NULL;
+
+    g_mutex_lock(&snap->queue_lock);
+    if (snap->count == snap->capacity) {
+        evicted = snap->jobs[snap->head];
+        snap->head = (snap->head + 1) % snap->capacity;
+        snap->count--;
+        snap->dropped++;
+    }
+    snap->jobs[(snap->head + snap->count) % snap->capacity] = job;
+    snap->count++;
+    g_cond_signal(&snap->queue_cond);
+    g_mutex_unlock(&snap->queue_lock);
+
+    if (evicted) {
+        snapshot_log(snap, evicted, "dropped");
+        snapshot_job_free(evicted);
+    }
+}
+
+gboolean snapshot_init(SnapshotContext *snap, const gchar *output_dir,
+                       guint n_workers, guint queue_size, gboolean full_frame) {
+    snap->output_dir = g_strdup(output_dir);
+    snap->full_frame = full_frame;
+    snap->margin = 0.25f;
+    snap->quality = 85;
+    snap->n_workers = n_workers < 1 ? 1 : n_workers;
+    snap->capacity = queue_size < 1 ? 1 : queue_size;
+    snap->head = 0;
+    snap->count = 0;
+    snap->active = 0;
+    snap->stopping = FALSE;
+    snap->written_jobs = g_ptr_array_new();
+    snap->written_hint.store(0, std::memory_order_relaxed);
+    snap->pending_count = 0;
+    snap->pending_hint.store(0, std::memory_order_relaxed);
+    snap->requested = 0;
+    snap->written = 0;
+    snap->dropped = 0;
+    snap->failed = 0;
+    snap->log = NULL;
+    snap->workers = NULL;
+    snap->jobs = g_new0(SnapshotJob *, snap->capacity);
+    g_mutex_init(&snap->pending_lock);
+    g_mutex_init(&snap->queue_lock);
+    g_cond_init(&snap->queue_cond);
+    g_cond_init(&snap->idle_cond);
+    g_mutex_init(&snap->log_lock);
+
+    if (g_mkdir_with_parents(snap->output_dir, 0755) != 0) {
+        g_printerr("ERROR: No se pudo crear el directorio de capturas: %s\n", snap->output_dir);
+        return FALSE;
+    }
+
+    gchar *log_path = g_build_filename(snap->output_dir, "snapshots.csv", NULL);
+    snap->log = fopen(log_path, "w");
+    if (snap->log) {
+        fprintf(snap->log, "pts_ms,track_id,status,path\n");
+    } else {
+        g_printerr("WARNING: No se pudo crear %s\n", log_path);
+    }
+    g_free(log_path);
+
+    snap->workers = g_new0(GThread *, snap->n_workers);
+    for (guint i = 0; i < snap->n_workers; i++) {
+        snap->workers[i] = g_thread_new("snapshot-enc", snapshot_worker, snap);
+    }
+
+    g_print("Alert snapshots: %s (%u workers, queue %u, %s)\n", snap->output_dir,
+            snap->n_workers, snap->capacity, full_frame ? "full frame" : "bbox crop");
+    return TRUE;
+}
+
+gboolean snapshot_request(SnapshotContext *snap, guint64 pts, guint64 track_id,
+                          const NvOSD_RectParams *bbox) {
+    gboolean queued = FALSE;
+    g_mutex_lock(&snap->pending_lock);
+    snap->requested++;
+    if (snap->pending_count < SNAPSHOT_MAX_PENDING) {
+        gchar *name = g_strdup_printf("alert_%" G_GUINT64_FORMAT "_%" G_GUINT64_FORMAT ".jpg",
+                                      track_id, pts / GST_MSECOND);
+        SnapshotRequest &req = snap->pending[snap->pending_count++];
+        req.pts = pts;
+        req.track_id = track_id;
+        req.left = bbox->left;
+        req.top = bbox->top;
+        req.width = bbox->width;
+        req.height = bbox->height;
+        req.path = g_build_filename(snap->output_dir, name, NULL);
+        g_free(name);
+        snap->pending_hint.store(snap->pending_count, std::memory_order_release);
+        queued = TRUE;
+    } else {
+        snap->dropped++;
+    }
+    g_mutex_unlock(&snap->pending_lock);
+    return queued;
+}
+
+void snapshot_apply_written(SnapshotContext *snap, TrackerContext *tracker) {
+    // Camino común: nada nuevo desde el último frame
+    if (snap->written_hint.load(std::memory_order_acquire) == 0) return;
+
+    g_mutex_lock(&snap->queue_lock);
+    GPtrArray *done = snap->written_jobs;
+    snap->written_jobs = g_ptr_array_new();
+    snap->written_hint.store(0, std::memory_order_relaxed);
+    g_mutex_unlock(&snap->queue_lock);
+
+    for (guint i = 0; i < done->len; i++) {
+        SnapshotJob *job = (SnapshotJob *)g_ptr_array_index(done, i);
+        auto it = tracker->tracked_objects.find(job->track_id);
+        if (it != tracker->tracked_objects.end()) {
+            // Una alerta posterior del mismo track reemplaza la anterior
+            g_free(it->second.snapshot_path);
+            it->second.snapshot_path = job->path;
+            job->path = NULL;
+        }
+        snapshot_job_free(job);
+    }
+    g_ptr_array_free(done, TRUE);
+}
+
+void snapshot_drain(SnapshotContext *snap) {
+    g_mutex_lock(&snap->queue_lock);
+    while (snap->count > 0 || snap->active > 0) {
+        g_cond_wait(&snap->idle_cond, &snap->queue_lock);
+    }
+    g_mutex_unlock(&snap->queue_lock);
+}
+
+GstPadProbeReturn snapshot_filter_probe(GstPad *pad, GstPadProbeInfo *info,
+                                        gpointer u_data) {
+    SnapshotContext *snap = (SnapshotContext *)u_data;
+    GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    // Camino común: ninguna alerta pendiente, el frame no se convierte
+    if (snap->pending_hint.load(std::memory_order_acquire) == 0) {
+        return GST_PAD_PROBE_DROP;
+    }
+
+    gboolean wanted = FALSE;
+    guint64 pts = GST_BUFFER_PTS(buf);
+    g_mutex_lock(&snap->pending_lock);
+    for (guint i = 0; i < snap->pending_count && !wanted; i++) {
+        wanted = (snap->pending[i].pts == pts);
+    }
+    g_mutex_unlock(&snap->pending_lock);
+
+    return wanted ? GST_PAD_PROBE_OK : GST_PAD_PROBE_DROP;
+}
+
+// Copia el rectángulo pedido (con margen) a un buffer propio del trabajo
+static SnapshotJob *snapshot_crop(SnapshotContext *snap, const SnapshotRequest *req,
+                                  const guint8 *frame, gint frame_w, gint frame_h,
+                                  gint stride) {
+    gint x0 = 0, y0 = 0, x1 = frame_w, y1 = frame_h;
+    if (!snap->full_frame) {
+        gfloat mx = req->width * snap->margin;
+        gfloat my = req->height * snap->margin;
+        x0 = CLAMP((gint)(req->left - mx), 0, frame_w - 1);
+        y0 = CLAMP((gint)(req->top - my), 0, frame_h - 1);
+        x1 = CLAMP((gint)(req->left + req->width + mx), x0 + 1, frame_w);
+        y1 = CLAMP((gint)(req->top + req->height + my), y0 + 1, frame_h);
+    }
+
+    SnapshotJob *job = g_new0(SnapshotJob, 1);
+    job->width = x1 - x0;
+    job->height = y1 - y0;
+    job->track_id = req->track_id;
+    job->pts = req->pts;
+    job->path = req->path;
+    job->pixels = (guint8 *)g_malloc((gsize)job->width * job->height * 4);
+
+    gsize row_bytes = (gsize)job->width * 4;
+    for (gint y = 0; y < job->height; y++) {
+        memcpy(job->pixels + y * row_bytes,
+               frame + (gsize)(y0 + y) * stride + (gsize)x0 * 4, row_bytes);
+    }
+    return job;
+}
+
+GstPadProbeReturn snapshot_sink_probe(GstPad *pad, GstPadProbeInfo *info,
+                                      gpointer u_data) {
+    SnapshotContext *snap = (SnapshotContext *)u_data;
+    GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER(info);
+    guint64 pts = GST_BUFFER_PTS(buf);
+
+    // Tomar las solicitudes de este PTS; las de PTS anteriores ya no llegarán
+    SnapshotRequest matched[SNAPSHOT_MAX_PENDING];
+    guint n_matched = 0, n_stale = 0, kept = 0;
+    gchar *stale_paths[SNAPSHOT_MAX_PENDING];
+
+    g_mutex_lock(&snap->pending_lock);
+    for (guint i = 0; i < snap->pending_count; i++) {
+        SnapshotRequest &req = snap->pending[i];
+        if (req.pts == pts) {
+            matched[n_matched++] = req;
+        } else if (req.pts < pts) {
+            stale_paths[n_stale++] = req.path;
+        } else {
+            snap->pending[kept++] = req;
+        }
+    }
+    snap->pending_count = kept;
+    snap->dropped += n_stale;
+    snap->pending_hint.store(kept, std::memory_order_release);
+    g_mutex_unlock(&snap->pending_lock);
+
+    for (guint i = 0; i < n_stale; i++) g_free(stale_paths[i]);
+    if (n_matched == 0) return GST_PAD_PROBE_OK;
+
+    // El stride y el desplazamiento vienen del GstVideoMeta del buffer si lo
+    // trae, si no de los caps: las filas pueden tener relleno
+    GstVideoInfo vinfo;
+    GstVideoFrame frame;
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    gboolean mapped = caps && gst_video_info_from_caps(&vinfo, caps) &&
+                      gst_video_frame_map(&frame, &vinfo, buf, GST_MAP_READ);
+    if (caps) gst_caps_unref(caps);
+    if (!mapped) {
+        for (guint i = 0; i < n_matched; i++) g_free(matched[i].path);
+        g_mutex_lock(&snap->pending_lock);
+        snap->dropped += n_matched;
+        g_mutex_unlock(&snap->pending_lock);
+        return GST_PAD_PROBE_OK;
+    }
+
+    const guint8 *pixels = (const guint8 *)GST_VIDEO_FRAME_PLANE_DATA(&frame, 0);
+    gint stride = GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 0);
+    gint width = GST_VIDEO_FRAME_WIDTH(&frame), height = GST_VIDEO_FRAME_HEIGHT(&frame);
+    for (guint i = 0; i < n_matched; i++) {
+        snapshot_push_job(snap, snapshot_crop(snap, &matched[i], pixels,
+                                              width, height, stride));
+    }
+    gst_video_frame_unmap(&frame);
+    return GST_PAD_PROBE_OK;
+}
+
+void snapshot_destroy(SnapshotContext *snap) {
+    g_mutex_lock(&snap->queue_lock);
+    snap->stopping = TRUE;
+    g_cond_broadcast(&snap->queue_cond);
+    g_mutex_unlock(&snap->queue_lock);
+
+    for (guint i = 0; i < snap->n_workers && snap->workers; i++) {
+        if (snap->workers[i]) g_thread_join(snap->workers[i]);
+    }
+
+    for (guint i = 0; i < snap->pending_count; i++) {
+        g_free(snap->pending[i].path);
+        snap->dropped++;
+    }
+    snap->pending_count = 0;
+    for (guint i = 0; i < snap->written_jobs->len; i++) {
+        snapshot_job_free((SnapshotJob *)g_ptr_array_index(snap->written_jobs, i));
+    }
+    g_ptr_array_free(snap->written_jobs, TRUE);
+
+    g_print("Alert snapshots: %" G_GUINT64_FORMAT " requested, %" G_GUINT64_FORMAT
+            " written, %" G_GUINT64_FORMAT " dropped, %" G_GUINT64_FORMAT " failed\n",
+            snap->requested, snap->written, snap->dropped, snap->failed);
+
+    if (snap->log) fclose(snap->log);
+    g_free(snap->workers);
+    g_free(snap->jobs);
+    g_free(snap->output_dir);
+    g_mutex_clear(&snap->pending_lock);
+    g_mutex_clear(&snap->queue_lock);
+    g_mutex_clear(&snap->log_lock);
+    g_cond_clear(&snap->queue_cond);
+    g_cond_clear(&snap->idle_cond);
+}
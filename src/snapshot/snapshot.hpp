@@ -0,0 +1,104 @@
+/*
+ * snapshot.hpp
+ * Captura asíncrona de imágenes JPEG al activarse una alerta
+ *
+ * El probe del OSD registra una solicitud (PTS + bbox) cuando un vehículo
+ * pasa a STATE_ALERT. La rama de captura solo convierte los frames con
+ * solicitudes pendientes; el recorte se entrega a un pool acotado de hilos
+ * que codifica y escribe a disco fuera del hilo de streaming. La ruta del
+ * JPEG se asigna al track solo cuando el pool lo escribió: el probe del OSD
+ * recoge los trabajos terminados con snapshot_apply_written().
+ */
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include <stdio.h>
+#include <atomic>
+#include "gstnvdsmeta.h"
+#include "config/track_info.hpp"
+
+#define SNAPSHOT_MAX_PENDING 32
+
+// Solicitud de captura (hilo del OSD -> rama de captura)
+struct SnapshotRequest {
+    guint64 pts;
+    guint64 track_id;
+    gfloat left, top, width, height;
+    gchar *path;
+};
+
+// Trabajo de codificación (rama de captura -> pool)
+struct SnapshotJob {
+    guint8 *pixels;      // RGBA recortado, filas contiguas
+    gint width;
+    gint height;
+    guint64 track_id;
+    guint64 pts;
+    gchar *path;
+};
+
+// Contexto de capturas
+struct SnapshotContext {
+    gchar *output_dir;
+    gboolean full_frame;     // Guardar el frame completo en vez del recorte
+    gfloat margin;           // Margen alrededor del bbox (fracción del tamaño)
+    gint quality;            // Calidad JPEG (1-100)
+
+    GMutex pending_lock;
+    SnapshotRequest pending[SNAPSHOT_MAX_PENDING];
+    guint pending_count;
+    std::atomic<guint> pending_hint;  // Copia de pending_count leída sin lock
+
+    GThread **workers;
+    guint n_workers;
+    GMutex queue_lock;
+    GCond queue_cond;
+    GCond idle_cond;         // Cola vacía y ningún trabajo en curso
+    SnapshotJob **jobs;      // Cola circular acotada
+    guint capacity;
+    guint head;
+    guint count;
+    guint active;            // Trabajos que un hilo del pool está escribiendo
+    gboolean stopping;
+    GPtrArray *written_jobs; // Escritos, sin píxeles; los recoge el hilo del OSD
+    std::atomic<guint> written_hint;
+
+    GMutex log_lock;         // El log no se escribe bajo queue_lock
+    FILE *log;               // <dir>/snapshots.csv
+    guint64 requested;
+    guint64 written;
+    guint64 dropped;         // Descartados por saturación o frame perdido
+    guint64 failed;
+};
+
+// Inicializa el pool de codificación y el directorio de salida
+gboolean snapshot_init(SnapshotContext *snap, const gchar *output_dir,
+                       guint n_workers, guint queue_size, gboolean full_frame);
+
+// Registra una captura para el frame con el PTS dado; FALSE si se descartó
+// por saturación
+gboolean snapshot_request(SnapshotContext *snap, guint64 pts, guint64 track_id,
+                          const NvOSD_RectParams *bbox);
+
+// Asigna a cada track la ruta de los JPEG ya escritos (hilo del OSD, o el
+// principal después de snapshot_drain)
+void snapshot_apply_written(SnapshotContext *snap, TrackerContext *tracker);
+
+// Espera a que el pool escriba los trabajos encolados (en EOS, antes del reporte)
+void snapshot_drain(SnapshotContext *snap);
+
+// Probe en la entrada de la rama: descarta los frames sin solicitudes
+GstPadProbeReturn snapshot_filter_probe(GstPad *pad, GstPadProbeInfo *info,
+                                        gpointer u_data);
+
+// Probe del fakesink de la rama: recorta y encola los trabajos
+GstPadProbeReturn snapshot_sink_probe(GstPad *pad, GstPadProbeInfo *info,
+                                      gpointer u_data);
+
+// Termina de escribir los trabajos pendientes y libera recursos
+void snapshot_destroy(SnapshotContext *snap);
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,44 @@
+/*
+ * latency.cpp
+ * Implementación del registro de marcas de ingreso
+ */
+
+#include "latency.hpp"
+#include <time.h>
+
+gboolean latency_log_init(LatencyLog *log, const gchar *path) {
+    log->frames = 0;
+    log->file = fopen(path, "wb");
+    if (!log->file) {
+        g_printerr("ERROR: No se pudo crear el registro de latencia: %s\n", path);
+        return FALSE;
+    }
+    g_print("Latency ingest log: %s\n", path);
+    return TRUE;
+}
+
+GstPadProbeReturn latency_ingest_probe(GstPad *pad, GstPadProbeInfo *info,
+                                       gpointer u_data) {
+    LatencyLog *log = (LatencyLog *)u_data;
+    GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!GST_CLOCK_TIME_IS_VALID(GST_BUFFER_PTS(buf))) return GST_PAD_PROBE_OK;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    LatencyIngestRecord rec;
+    rec.pts_ns = GST_BUFFER_PTS(buf);
+    rec.monotonic_ns = (guint64)ts.tv_sec * 1000000000ULL + (guint64)ts.tv_nsec;
+    // Escritura con buffer de stdio: 16 bytes por frame
+    fwrite(&rec, sizeof(rec), 1, log->file);
+    log->frames++;
+    return GST_PAD_PROBE_OK;
+}
+
+void latency_log_destroy(LatencyLog *log) {
+    if (log->file) {
+        fclose(log->file);
+        log->file = NULL;
+        g_print("Latency ingest log: %" G_GUINT64_FORMAT " frames\n", log->frames);
+    }
+}
@@ -0,0 +1,40 @@
+/*
+ * latency.hpp
+ * Registro de marcas de ingreso para medir latencia extremo a extremo
+ *
+ * Cada frame comprimido que entra al decoder se registra como
+ * (PTS, CLOCK_MONOTONIC). La herramienta tools/latency_probe recibe el
+ * stream RTP en la misma máquina, reconstruye el PTS a partir del timestamp
+ * RTP (timestamp-offset = 0) y calcula la latencia ingreso -> recepción.
+ */
+
+#ifndef LATENCY_HPP
+#define LATENCY_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+#include <stdio.h>
+
+// Registro binario de ingreso (compartido con tools/latency_probe)
+struct LatencyIngestRecord {
+    guint64 pts_ns;
+    guint64 monotonic_ns;
+};
+
+// Contexto del registro de ingreso
+struct LatencyLog {
+    FILE *file;
+    guint64 frames;
+};
+
+// Abre el archivo de marcas de ingreso
+gboolean latency_log_init(LatencyLog *log, const gchar *path);
+
+// Probe en la entrada del decoder: registra el instante de ingreso
+GstPadProbeReturn latency_ingest_probe(GstPad *pad, GstPadProbeInfo *info,
+                                       gpointer u_data);
+
+// Cierra el archivo
+void latency_log_destroy(LatencyLog *log);
+
+#endif // LATENCY_HPP
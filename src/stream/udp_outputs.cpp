@@ -0,0 +1,136 @@
+/*
+ * udp_outputs.cpp
+ * Implementación de las salidas UDP/RTP múltiples
+ */
+
+#include "udp_outputs.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Valida una lista "host:port,host:port"
+static gboolean valid_client_list(const gchar *clients) {
+    gchar **items = g_strsplit(clients, ",", -1);
+    gboolean ok = items[0] != NULL;
+    for (guint i = 0; items[i] && ok; i++) {
+        const gchar *colon = strrchr(items[i], ':');
+        gint port = colon ? atoi(colon + 1) : 0;
+        ok = colon && colon != items[i] && port > 0 && port < 65536;
+    }
+    g_strfreev(items);
+    return ok;
+}
+
+gboolean udp_rendition_parse(const gchar *spec, UdpRendition *out) {
+    out->clients = NULL;
+    const gchar *eq = strchr(spec, '=');
+    if (!eq) return FALSE;
+
+    guint kbps = 0;
+    if (sscanf(spec, "%dx%d@%u", &out->width, &out->height, &kbps) != 3 ||
+        out->width <= 0 || out->height <= 0 || kbps == 0) {
+        return FALSE;
+    }
+    // nvvideoconvert/encoders requieren dimensiones pares
+    out->width &= ~1;
+    out->height &= ~1;
+    out->bitrate = kbps * 1000;
+
+    if (!valid_client_list(eq + 1)) return FALSE;
+    out->clients = g_strdup(eq + 1);
+    return TRUE;
+}
+
+void udp_rendition_clear(UdpRendition *rendition) {
+    g_free(rendition->clients);
+    rendition->clients = NULL;
+}
+
+gchar *udp_build_client_list(const gchar *host, gint port,
+                             const gchar *extra_clients, const gchar *multicast) {
+    GString *list = g_string_new(NULL);
+    g_string_append_printf(list, "%s:%d", host, port);
+    if (extra_clients && *extra_clients) {
+        g_string_append_printf(list, ",%s", extra_clients);
+    }
+    if (multicast && *multicast) {
+        g_string_append_printf(list, ",%s", multicast);
+    }
+    return g_string_free(list, FALSE);
+}
+
+// Crea un elemento con nombre "<prefijo>-<índice>"
+static GstElement *make_indexed(const gchar *factory, const gchar *prefix, guint index) {
+    gchar *name = g_strdup_printf("%s-%u", prefix, index);
+    GstElement *elem = gst_element_factory_make(factory, name);
+    g_free(name);
+    return elem;
+}
+
+gboolean udp_add_rendition_branch(GstElement *pipeline, GstElement *tee,
+                                  const UdpRendition *rendition, guint index,
+                                  gboolean use_x264, guint gop) {
+    GstElement *queue     = make_indexed("queue",          "rendition-queue", index);
+    GstElement *conv      = make_indexed("nvvideoconvert", "rendition-conv", index);
+    GstElement *caps_elem = make_indexed("capsfilter",     "rendition-caps", index);
+    GstElement *encoder   = make_indexed(use_x264 ? "x264enc" : "nvv4l2h264enc",
+                                         "rendition-enc", index);
+    GstElement *parser    = make_indexed("h264parse",      "rendition-parser", index);
+    GstElement *pay       = make_indexed("rtph264pay",     "rendition-pay", index);
+    GstElement *sink      = make_indexed("multiudpsink",   "rendition-sink", index);
+
+    if (!queue || !conv || !caps_elem || !encoder || !parser || !pay || !sink) {
+        g_printerr("Failed to create rendition %u elements\n", index);
+        return FALSE;
+    }
+
+    // Una rendition lenta descarta frames en su cola en vez de frenar al tee
+    g_object_set(G_OBJECT(queue),
+                 "leaky", 2,
+                 "max-size-buffers", 3,
+                 "max-size-bytes", 0,
+                 "max-size-time", (guint64)0,
+                 NULL);
+
+    gchar *caps_str = g_strdup_printf(use_x264 ? "video/x-raw, format=I420, width=%d, height=%d"
+                                               : "video/x-raw(memory:NVMM), format=NV12, width=%d, height=%d",
+                                      rendition->width, rendition->height);
+    GstCaps *caps = gst_caps_from_string(caps_str);
+    g_object_set(G_OBJECT(caps_elem), "caps", caps, NULL);
+    gst_caps_unref(caps);
+    g_free(caps_str);
+
+    if (use_x264) {
+        g_object_set(G_OBJECT(encoder),
+                     "bitrate", rendition->bitrate / 1000,
+                     "speed-preset", 1,
+                     "key-int-max", gop,
+                     NULL);
+    } else {
+        g_object_set(G_OBJECT(encoder),
+                     "bitrate", rendition->bitrate,
+                     "preset-level", 1,
+                     "insert-sps-pps", TRUE,
+                     "iframeinterval", gop,
+                     NULL);
+    }
+    g_object_set(G_OBJECT(pay), "config-interval", 1, "pt", 96, NULL);
+    g_object_set(G_OBJECT(sink),
+                 "clients", rendition->clients,
+                 "sync", FALSE,
+                 "async", FALSE,
+                 NULL);
+
+    gst_bin_add_many(GST_BIN(pipeline), queue, conv, caps_elem, encoder,
+                     parser, pay, sink, NULL);
+    if (!gst_element_link_many(tee, queue, conv, caps_elem, encoder,
+                               parser, pay, sink, NULL)) {
+        g_printerr("Failed to link rendition %u\n", index);
+        return FALSE;
+    }
+
+    g_print("Linked rendition %u: %dx%d @ %u kbit/s -> %s\n", index,
+            rendition->width, rendition->height, rendition->bitrate / 1000,
+            rendition->clients);
+    return TRUE;
+}
@@ -0,0 +1,38 @@
+/*
+ * udp_outputs.hpp
+ * Salidas UDP/RTP hacia varios clientes y renditions de menor resolución
+ */
+
+#ifndef UDP_OUTPUTS_HPP
+#define UDP_OUTPUTS_HPP
+
+#include <gst/gst.h>
+#include <glib.h>
+
+#define MAX_RENDITIONS 4
+
+// Rendition adicional: <ancho>x<alto>@<kbps>=<host:port>[,<host:port>...]
+struct UdpRendition {
+    gint width;
+    gint height;
+    guint bitrate;       // bit/s
+    gchar *clients;      // Lista "host:port,host:port" para multiudpsink
+};
+
+// Interpreta una especificación de rendition; FALSE si es inválida
+gboolean udp_rendition_parse(const gchar *spec, UdpRendition *out);
+
+// Libera los campos de una rendition
+void udp_rendition_clear(UdpRendition *rendition);
+
+// Lista de clientes de la salida principal (host/port + extras + multicast)
+gchar *udp_build_client_list(const gchar *host, gint port,
+                             const gchar *extra_clients, const gchar *multicast);
+
+// Agrega la rama tee -> queue -> escalado -> encoder -> RTP -> multiudpsink;
+// bitrate y GOP fijos (el control de tasa adaptativo solo ajusta la principal)
+gboolean udp_add_rendition_branch(GstElement *pipeline, GstElement *tee,
+                                  const UdpRendition *rendition, guint index,
+                                  gboolean use_x264, guint gop);
+
+#endif // UDP_OUTPUTS_HPP
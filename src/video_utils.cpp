@@ -5,112 +5,130 @@
  */
 
 #include "video_utils.h"
-#include <gst/pbutils/pbutils.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 
-gboolean get_video_info(const gchar *filepath, VideoInfo *info) {
-    GError *error = NULL;
-    GstDiscoverer *discoverer;
-    GstDiscovererInfo *disc_info;
-    gchar *uri;
-    
-    // Inicializar estructura
+gboolean video_info_from_caps(GstCaps *caps, VideoInfo *info) {
     info->width = 0;
     info->height = 0;
     info->fps_num = 0;
-    info->fps_den = 0;
+    info->fps_den = 1;
     info->duration = 0.0;
     info->valid = FALSE;
-    
-    // Crear discoverer
-    discoverer = gst_discoverer_new(5 * GST_SECOND, &error);
-    if (!discoverer) {
-        g_printerr("Error creating discoverer: %s\n", error->message);
-        g_error_free(error);
+
+    if (!caps || gst_caps_get_size(caps) == 0) return FALSE;
+
+    const GstStructure *str = gst_caps_get_structure(caps, 0);
+    if (!gst_structure_get_int(str, "width", &info->width) ||
+        !gst_structure_get_int(str, "height", &info->height)) {
         return FALSE;
     }
-    
-    // Convertir filepath a URI
-    if (!g_str_has_prefix(filepath, "file://")) {
-        gchar *absolute_path = g_filename_to_uri(filepath, NULL, NULL);
-        if (!absolute_path) {
-            // Intentar con ruta relativa/absoluta directa
-            if (g_path_is_absolute(filepath)) {
-                uri = g_strdup_printf("file://%s", filepath);
-            } else {
-                gchar *cwd = g_get_current_dir();
-                uri = g_strdup_printf("file://%s/%s", cwd, filepath);
-                g_free(cwd);
-            }
-        } else {
-            uri = absolute_path;
-        }
+    // El framerate puede faltar (0/1 = variable o desconocido)
+    if (!gst_structure_get_fraction(str, "framerate", &info->fps_num, &info->fps_den)) {
+        info->fps_num = 0;
+        info->fps_den = 1;
+    }
+    info->valid = info->width > 0 && info->height > 0;
+    return info->valid;
+}
+
+/*
+ * Formato del cache: una línea por archivo, campos separados por tabulador
+ *   <mtime>\t<tamaño>\t<ancho>\t<alto>\t<fps_num>\t<fps_den>\t<ruta absoluta>
+ * Un archivo modificado cambia mtime/tamaño y su entrada deja de coincidir.
+ */
+
+// Ruta absoluta + mtime + tamaño del archivo de entrada
+static gboolean cache_key(const gchar *filepath, gchar **abs_path,
+                          gint64 *mtime, gint64 *size) {
+    struct stat st;
+    if (stat(filepath, &st) != 0) return FALSE;
+    *mtime = (gint64)st.st_mtime;
+    *size = (gint64)st.st_size;
+    if (g_path_is_absolute(filepath)) {
+        *abs_path = g_strdup(filepath);
     } else {
-        uri = g_strdup(filepath);
+        gchar *cwd = g_get_current_dir();
+        *abs_path = g_build_filename(cwd, filepath, NULL);
+        g_free(cwd);
     }
-    
-    g_print("Discovering video info: %s\n", uri);
-    
-    // Descubrir información
-    disc_info = gst_discoverer_discover_uri(discoverer, uri, &error);
-    if (!disc_info) {
-        g_printerr("Error discovering URI: %s\n", error->message);
-        g_error_free(error);
-        g_free(uri);
-        g_object_unref(discoverer);
+    return TRUE;
+}
+
+gboolean video_info_cache_lookup(const gchar *cache_path, const gchar *filepath,
+                                 VideoInfo *info) {
+    info->valid = FALSE;
+
+    gchar *abs_path;
+    gint64 mtime, size;
+    if (!cache_key(filepath, &abs_path, &mtime, &size)) return FALSE;
+
+    FILE *f = fopen(cache_path, "r");
+    if (!f) {
+        g_free(abs_path);
         return FALSE;
     }
-    
-    // Verificar resultado
-    GstDiscovererResult result = gst_discoverer_info_get_result(disc_info);
-    if (result != GST_DISCOVERER_OK) {
-        const gchar *result_str = "Unknown error";
-        switch (result) {
-            case GST_DISCOVERER_URI_INVALID: result_str = "Invalid URI"; break;
-            case GST_DISCOVERER_ERROR: result_str = "Discovery error"; break;
-            case GST_DISCOVERER_TIMEOUT: result_str = "Discovery timeout"; break;
-            case GST_DISCOVERER_BUSY: result_str = "Discoverer busy"; break;
-            case GST_DISCOVERER_MISSING_PLUGINS: result_str = "Missing plugins"; break;
-            default: break;
+
+    gchar line[4096];
+    while (fgets(line, sizeof(line), f)) {
+        gchar **fields = g_strsplit(g_strchomp(line), "\t", 7);
+        if (g_strv_length(fields) == 7 &&
+            g_ascii_strtoll(fields[0], NULL, 10) == mtime &&
+            g_ascii_strtoll(fields[1], NULL, 10) == size &&
+            strcmp(fields[6], abs_path) == 0) {
+            info->width = atoi(fields[2]);
+            info->height = atoi(fields[3]);
+            info->fps_num = atoi(fields[4]);
+            info->fps_den = atoi(fields[5]);
+            info->duration = 0.0;
+            info->valid = info->width > 0 && info->height > 0 && info->fps_den > 0;
         }
-        g_printerr("Discovery failed: %s (code: %d)\n", result_str, result);
-        gst_discoverer_info_unref(disc_info);
-        g_free(uri);
-        g_object_unref(discoverer);
-        return FALSE;
+        g_strfreev(fields);
+        if (info->valid) break;
     }
-    
-    // Obtener duración
-    info->duration = gst_discoverer_info_get_duration(disc_info) / (gdouble)GST_SECOND;
-    
-    // Obtener streams de video
-    GList *video_streams = gst_discoverer_info_get_video_streams(disc_info);
-    if (video_streams) {
-        GstDiscovererStreamInfo *stream_info = (GstDiscovererStreamInfo *)video_streams->data;
-        
-        if (GST_IS_DISCOVERER_VIDEO_INFO(stream_info)) {
-            GstDiscovererVideoInfo *video_info = GST_DISCOVERER_VIDEO_INFO(stream_info);
-            
-            info->width = gst_discoverer_video_info_get_width(video_info);
-            info->height = gst_discoverer_video_info_get_height(video_info);
-            info->fps_num = gst_discoverer_video_info_get_framerate_num(video_info);
-            info->fps_den = gst_discoverer_video_info_get_framerate_denom(video_info);
-            info->valid = TRUE;
-            
-            g_print("[OK] Video resolution: %dx%d @ %d/%d fps (%.2fs)\n",
-                    info->width, info->height, 
-                    info->fps_num, info->fps_den,
-                    info->duration);
+
+    fclose(f);
+    g_free(abs_path);
+    return info->valid;
+}
+
+gboolean video_info_cache_store(const gchar *cache_path, const gchar *filepath,
+                                const VideoInfo *info) {
+    gchar *abs_path;
+    gint64 mtime, size;
+    if (!info->valid || !cache_key(filepath, &abs_path, &mtime, &size)) return FALSE;
+
+    // Se conservan las entradas de otros archivos y se reemplaza la propia
+    GString *out = g_string_new(NULL);
+    gchar *contents = NULL;
+    if (g_file_get_contents(cache_path, &contents, NULL, NULL)) {
+        gchar **lines = g_strsplit(contents, "\n", -1);
+        for (guint i = 0; lines[i]; i++) {
+            const gchar *tab = lines[i];
+            for (gint n = 0; n < 6 && tab; n++) {
+                tab = strchr(tab, '\t');
+                if (tab) tab++;
+            }
+            if (!tab || strcmp(tab, abs_path) == 0) continue;
+            g_string_append_printf(out, "%s\n", lines[i]);
         }
-        
-        gst_discoverer_stream_info_list_free(video_streams);
-    } else {
-        g_printerr("No video streams found\n");
+        g_strfreev(lines);
+        g_free(contents);
     }
-    
-    // Limpiar
-    gst_discoverer_info_unref(disc_info);
-    g_free(uri);
-    g_object_unref(discoverer);
-    
-    return info->valid;
+    g_string_append_printf(out, "%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%d\t%d\t%d\t%d\t%s\n",
+                           mtime, size, info->width, info->height,
+                           info->fps_num, info->fps_den, abs_path);
+
+    // g_file_set_contents escribe a un temporal y renombra (atómico)
+    GError *error = NULL;
+    gboolean ok = g_file_set_contents(cache_path, out->str, out->len, &error);
+    if (!ok) {
+        g_printerr("Media cache: could not write %s: %s\n", cache_path, error->message);
+        g_error_free(error);
+    }
+    g_string_free(out, TRUE);
+    g_free(abs_path);
+    return ok;
 }
@@ -8,7 +8,6 @@
 #define VIDEO_UTILS_H
 
 #include <gst/gst.h>
-#include <gst/pbutils/pbutils.h>
 
 // Estructura para almacenar información del video
 typedef struct {
@@ -20,7 +19,15 @@ typedef struct {
     gboolean valid;
 } VideoInfo;
 
-// Obtiene información del video usando GstDiscoverer
-gboolean get_video_info(const gchar *filepath, VideoInfo *info);
+// Obtiene resolución y framerate de los caps negociados (video/x-raw)
+gboolean video_info_from_caps(GstCaps *caps, VideoInfo *info);
+
+// Busca la información del archivo en el cache (clave: ruta + mtime + tamaño)
+gboolean video_info_cache_lookup(const gchar *cache_path, const gchar *filepath,
+                                 VideoInfo *info);
+
+// Guarda/actualiza la entrada del archivo en el cache
+gboolean video_info_cache_store(const gchar *cache_path, const gchar *filepath,
+                                const VideoInfo *info);
 
 #endif // VIDEO_UTILS_H
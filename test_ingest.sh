@@ -0,0 +1,95 @@
+#!/bin/bash
+
+# Prueba de la etapa de entrada genérica con fuentes locales
+# Universidad de Costa Rica - IE0301
+#
+# Genera clips sintéticos (H.264/MP4, H.265/MKV, H.265/TS), un emisor RTP
+# local y, si está disponible, un servidor RTSP local (test-launch de
+# gst-rtsp-server). Cada entrada se procesa y se verifica el reporte.
+
+OUT_DIR="resultados_ingest"
+CLIP_SECONDS=5
+FRAMES=$((CLIP_SECONDS * 30))
+SRC="videotestsrc pattern=ball num-buffers=$FRAMES ! video/x-raw,width=1280,height=720,framerate=30/1"
+
+if [ ! -f "./bin/roi_surveillance" ]; then
+    echo "ERROR: Ejecutable no encontrado. Ejecuta 'make' primero"
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+rm -f "$OUT_DIR"/*.txt "$OUT_DIR"/*.log
+
+# Encoder H.264/H.265: hardware si existe, si no x264/x265
+enc() {
+    local codec=$1
+    if gst-inspect-1.0 "nvv4l2${codec}enc" > /dev/null 2>&1; then
+        echo "nvvideoconvert ! video/x-raw(memory:NVMM) ! nvv4l2${codec}enc ! ${codec}parse"
+    elif [ "$codec" = "h264" ]; then
+        echo "x264enc tune=zerolatency ! h264parse"
+    else
+        echo "x265enc tune=zerolatency ! h265parse"
+    fi
+}
+
+echo "Generando clips..."
+gst-launch-1.0 -q $SRC ! $(enc h264) ! mp4mux ! filesink location="$OUT_DIR/clip_h264.mp4"
+gst-launch-1.0 -q $SRC ! $(enc h265) ! matroskamux ! filesink location="$OUT_DIR/clip_h265.mkv"
+gst-launch-1.0 -q $SRC ! $(enc h265) ! mpegtsmux ! filesink location="$OUT_DIR/clip_h265.ts"
+
+status=0
+check() {
+    local name=$1
+    if [ -s "$OUT_DIR/report_$name.txt" ]; then
+        echo "[OK]    $name"
+    else
+        echo "[ERROR] $name (ver $OUT_DIR/$name.log)"
+        status=1
+    fi
+}
+
+run() {
+    local name=$1
+    shift
+    ./bin/roi_surveillance vi-file "$@" --mode video vo-file "$OUT_DIR/out_$name.mp4" \
+        --file-name "$OUT_DIR/report_$name.txt" > "$OUT_DIR/$name.log" 2>&1
+}
+
+for clip in clip_h264.mp4 clip_h265.mkv clip_h265.ts; do
+    name="${clip%.*}_${clip##*.}"
+    run "$name" "$OUT_DIR/$clip"
+    check "$name"
+done
+
+# RTP: emisor local en tiempo real; Ctrl+C (SIGINT) al terminar envía EOS
+echo "Probando RTP..."
+run rtp "rtp://127.0.0.1:5600?codec=h265" &
+PID_APP=$!
+sleep 2
+gst-launch-1.0 -q videotestsrc is-live=true pattern=ball num-buffers=$FRAMES ! \
+    video/x-raw,width=1280,height=720,framerate=30/1 ! $(enc h265) ! \
+    rtph265pay config-interval=1 ! udpsink host=127.0.0.1 port=5600
+sleep 1
+kill -INT "$PID_APP"
+wait "$PID_APP"
+check rtp
+
+# RTSP: solo si test-launch (ejemplo de gst-rtsp-server) está instalado
+if command -v test-launch > /dev/null 2>&1; then
+    echo "Probando RTSP..."
+    test-launch "( videotestsrc is-live=true pattern=ball ! video/x-raw,width=1280,height=720,framerate=30/1 ! $(enc h264) ! rtph264pay name=pay0 pt=96 )" \
+        > /dev/null 2>&1 &
+    PID_RTSP=$!
+    sleep 2
+    run rtsp "rtsp://127.0.0.1:8554/test" &
+    PID_APP=$!
+    sleep $((CLIP_SECONDS + 3))
+    kill -INT "$PID_APP"
+    wait "$PID_APP"
+    kill "$PID_RTSP" 2>/dev/null
+    check rtsp
+else
+    echo "[SKIP]  rtsp (test-launch no encontrado)"
+fi
+
+exit $status
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# Benchmark de latencia ingreso -> recepción RTP en loopback
+# Universidad de Costa Rica - IE0301
+#
+# Ejecuta el mismo video con el perfil throughput y con el perfil live,
+# recibe el stream con tools/latency_probe y compara p50/p99 por frame.
+
+VIDEO="${1:-videosPrueba/videoCarros.mp4}"
+OUT_DIR="resultados_latencia"
+PORT=5000
+
+if [ ! -f "./bin/roi_surveillance" ] || [ ! -f "./bin/latency_probe" ]; then
+    echo "ERROR: Ejecutables no encontrados. Ejecuta 'make && make tools' primero"
+    exit 1
+fi
+if [ ! -f "$VIDEO" ]; then
+    echo "ERROR: Video no encontrado: $VIDEO"
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+RESULTS="$OUT_DIR/latency.csv"
+echo "profile,ingested_frames,received_frames,matched,incomplete,unmatched,lat_p50_ms,lat_p90_ms,lat_p99_ms,lat_max_ms" > "$RESULTS"
+
+for profile in throughput live; do
+    echo "Perfil: $profile"
+    rm -f "$OUT_DIR/ingest_$profile.bin"
+
+    ./bin/latency_probe --port $PORT --ingest "$OUT_DIR/ingest_$profile.bin" \
+        --csv "$OUT_DIR/frames_$profile.csv" > "$OUT_DIR/summary_$profile.csv" &
+    PID_PROBE=$!
+    sleep 1
+
+    ./bin/roi_surveillance \
+        vi-file "$VIDEO" \
+        --mode udp \
+        --udp-host 127.0.0.1 --udp-port $PORT \
+        --profile "$profile" \
+        --latency-log "$OUT_DIR/ingest_$profile.bin" \
+        --file-name "$OUT_DIR/report_$profile.txt" \
+        > "$OUT_DIR/roi_surveillance_$profile.log" 2>&1
+    status=$?
+
+    # Si el pipeline falló no llegan más paquetes: no esperar al receptor
+    if [ $status -ne 0 ]; then
+        kill "$PID_PROBE" 2>/dev/null
+        wait "$PID_PROBE" 2>/dev/null
+        echo "  ERROR: roi_surveillance termino con codigo $status (ver $OUT_DIR/roi_surveillance_$profile.log)"
+        echo "$profile,error,,,,,,,," >> "$RESULTS"
+        continue
+    fi
+    wait "$PID_PROBE"
+    tail -n 1 "$OUT_DIR/summary_$profile.csv" | sed "s/^/$profile,/" >> "$RESULTS"
+done
+
+echo ""
+echo "=============================================="
+echo "Resultados ($RESULTS)"
+echo "=============================================="
+column -s, -t < "$RESULTS"
@@ -0,0 +1,99 @@
+#!/bin/bash
+
+# Prueba end-to-end de streaming UDP a varios clientes en loopback
+# Universidad de Costa Rica - IE0301
+#
+# Levanta receptores locales (2 unicast, 1 multicast y 1 rendition de baja
+# resolución), detiene el proceso de uno a mitad de la prueba y verifica que
+# los demás siguen recibiendo al mismo ritmo. UDP no tiene contrapresión: un
+# receptor detenido no llega a frenar al emisor, así que esto comprueba que
+# los clientes son independientes, no el comportamiento ante un cliente lento.
+
+VIDEO="${1:-videosPrueba/videoCarros.mp4}"
+OUT_DIR="resultados_udp_multi"
+MCAST="239.255.0.1"
+CAPS="application/x-rtp,media=video,encoding-name=H264,payload=96,clock-rate=90000"
+
+if [ ! -f "./bin/roi_surveillance" ]; then
+    echo "ERROR: Ejecutable no encontrado. Ejecuta 'make' primero"
+    exit 1
+fi
+if [ ! -f "$VIDEO" ]; then
+    echo "ERROR: Video no encontrado: $VIDEO"
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+rm -f "$OUT_DIR"/*.h264
+
+# Receptor: udpsrc -> depay -> archivo H.264 (sin decodificar)
+start_receiver() {
+    local port=$1
+    local extra=$2
+    gst-launch-1.0 -q udpsrc port="$port" $extra caps="$CAPS" ! \
+        rtph264depay ! h264parse ! filesink location="$OUT_DIR/port_$port.h264" \
+        > /dev/null 2>&1 &
+    echo $!
+}
+
+echo "Iniciando receptores..."
+PID_MAIN=$(start_receiver 5000 "")
+PID_EXTRA=$(start_receiver 5001 "")
+PID_MCAST=$(start_receiver 5002 "address=$MCAST auto-multicast=true")
+PID_LOW=$(start_receiver 5010 "")
+sleep 1
+
+echo "Iniciando roi_surveillance..."
+./bin/roi_surveillance \
+    vi-file "$VIDEO" \
+    --mode udp \
+    --udp-host 127.0.0.1 --udp-port 5000 \
+    --udp-clients 127.0.0.1:5001 \
+    --udp-multicast "$MCAST:5002" \
+    --rendition "640x360@800=127.0.0.1:5010" \
+    --file-name "$OUT_DIR/report.txt" \
+    > "$OUT_DIR/roi_surveillance.log" 2>&1 &
+PID_APP=$!
+
+# Ritmo de 5001 antes y durante la detención del receptor principal
+sleep 2
+size_extra_start=$(stat -c %s "$OUT_DIR/port_5001.h264" 2>/dev/null || echo 0)
+sleep 3
+echo "Deteniendo receptor 5000..."
+kill -STOP "$PID_MAIN"
+size_extra_before=$(stat -c %s "$OUT_DIR/port_5001.h264" 2>/dev/null || echo 0)
+sleep 3
+size_extra_after=$(stat -c %s "$OUT_DIR/port_5001.h264" 2>/dev/null || echo 0)
+kill -CONT "$PID_MAIN"
+rate_before=$(( (size_extra_before - size_extra_start) / 3 ))
+rate_stopped=$(( (size_extra_after - size_extra_before) / 3 ))
+
+wait "$PID_APP"
+sleep 1
+kill -INT "$PID_MAIN" "$PID_EXTRA" "$PID_MCAST" "$PID_LOW" 2>/dev/null
+wait 2>/dev/null
+
+echo ""
+echo "=============================================="
+echo "Resultados"
+echo "=============================================="
+status=0
+for port in 5000 5001 5002 5010; do
+    size=$(stat -c %s "$OUT_DIR/port_$port.h264" 2>/dev/null || echo 0)
+    if [ "$size" -gt 0 ]; then
+        echo "[OK]    puerto $port: $size bytes"
+    else
+        echo "[ERROR] puerto $port: sin datos"
+        status=1
+    fi
+done
+
+# El bitrate varía con la escena: basta con la mitad del ritmo previo
+if [ "$rate_stopped" -gt 0 ] && [ $((rate_stopped * 2)) -ge "$rate_before" ]; then
+    echo "[OK]    5001 con 5000 detenido: $rate_stopped B/s (antes $rate_before B/s)"
+else
+    echo "[ERROR] 5001 bajo de ritmo con 5000 detenido: $rate_stopped B/s (antes $rate_before B/s)"
+    status=1
+fi
+
+exit $status
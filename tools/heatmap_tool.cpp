@@ -0,0 +1,226 @@
+/*
+ * heatmap_tool.cpp
+ * Inspección, combinación y exportación a PNG de grillas de ocupación
+ *
+ * Uso:
+ *   heatmap_tool info <grilla.bin>
+ *   heatmap_tool merge <salida.bin> <grilla.bin> [grilla.bin ...]
+ *   heatmap_tool png <grilla.bin> <salida.png> [--presence|--dwell] [--scale N]
+ *
+ * Las grillas las genera roi_surveillance con --heatmap. El PNG usa una
+ * escala logarítmica (negro -> rojo -> amarillo -> blanco) y cada celda se
+ * dibuja como un bloque de N x N píxeles; se escribe sin compresión para no
+ * depender de zlib.
+ */
+
+#include "heatmap_grid.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static uint32_t crc_table[256];
+
+static void crc_init(void) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320U ^ (c >> 1) : c >> 1;
+        crc_table[n] = c;
+    }
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) crc = crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+static void put_be32(std::vector<uint8_t> &out, uint32_t v) {
+    out.push_back((uint8_t)(v >> 24));
+    out.push_back((uint8_t)(v >> 16));
+    out.push_back((uint8_t)(v >> 8));
+    out.push_back((uint8_t)v);
+}
+
+static void put_chunk(FILE *f, const char *type, const std::vector<uint8_t> &data) {
+    std::vector<uint8_t> chunk;
+    put_be32(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    uint32_t crc = crc_update(0xffffffffU, chunk.data() + 4, chunk.size() - 4) ^ 0xffffffffU;
+    put_be32(chunk, crc);
+    fwrite(chunk.data(), 1, chunk.size(), f);
+}
+
+// PNG RGB de 8 bits; IDAT con bloques deflate sin compresión
+static bool write_png(const char *path, const std::vector<uint8_t> &rgb,
+                      uint32_t width, uint32_t height) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    fwrite(signature, 1, sizeof(signature), f);
+
+    std::vector<uint8_t> ihdr;
+    put_be32(ihdr, width);
+    put_be32(ihdr, height);
+    ihdr.push_back(8);   // Bits por canal
+    ihdr.push_back(2);   // RGB
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    put_chunk(f, "IHDR", ihdr);
+
+    // Cada fila lleva el byte de filtro 0
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)height * (width * 3 + 1));
+    for (uint32_t y = 0; y < height; y++) {
+        raw.push_back(0);
+        const uint8_t *row = &rgb[(size_t)y * width * 3];
+        raw.insert(raw.end(), row, row + (size_t)width * 3);
+    }
+
+    std::vector<uint8_t> idat;
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    uint32_t a = 1, b = 0;
+    for (uint8_t v : raw) {
+        a = (a + v) % 65521;
+        b = (b + a) % 65521;
+    }
+    size_t pos = 0;
+    do {
+        size_t len = raw.size() - pos;
+        if (len > 65535) len = 65535;
+        bool last = pos + len == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back((uint8_t)len);
+        idat.push_back((uint8_t)(len >> 8));
+        idat.push_back((uint8_t)~len);
+        idat.push_back((uint8_t)(~len >> 8));
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < raw.size());
+    put_be32(idat, (b << 16) | a);
+    put_chunk(f, "IDAT", idat);
+    put_chunk(f, "IEND", std::vector<uint8_t>());
+    return fclose(f) == 0;
+}
+
+// Escala "hot": t en [0, 1]
+static void hot_color(double t, uint8_t *rgb) {
+    double r = t * 3.0, g = t * 3.0 - 1.0, bl = t * 3.0 - 2.0;
+    rgb[0] = (uint8_t)(255.0 * (r < 0 ? 0 : r > 1 ? 1 : r));
+    rgb[1] = (uint8_t)(255.0 * (g < 0 ? 0 : g > 1 ? 1 : g));
+    rgb[2] = (uint8_t)(255.0 * (bl < 0 ? 0 : bl > 1 ? 1 : bl));
+}
+
+static int cmd_info(const char *path) {
+    HeatmapGrid grid;
+    if (!heatmap_grid_load(&grid, path)) {
+        fprintf(stderr, "No se pudo leer %s\n", path);
+        return 1;
+    }
+    size_t cells = grid.presence.size(), used = 0, peak = 0;
+    uint64_t total = 0;
+    for (size_t i = 0; i < cells; i++) {
+        if (grid.presence[i]) used++;
+        if (grid.dwell_us[i] > grid.dwell_us[peak]) peak = i;
+        total += grid.presence[i];
+    }
+    printf("grid %ux%u, %u runs, %llu frames, %.1f s observed\n",
+           grid.width, grid.height, grid.runs, (unsigned long long)grid.frames,
+           grid.observed_us / 1e6);
+    printf("observations %llu, cells used %zu/%zu\n", (unsigned long long)total, used, cells);
+    printf("peak cell (%zu, %zu): %u observations, %.1f s dwell\n",
+           peak % grid.width, peak / grid.width, grid.presence[peak],
+           grid.dwell_us[peak] / 1e6);
+    return 0;
+}
+
+static int cmd_merge(int argc, char **argv) {
+    HeatmapGrid total;
+    if (!heatmap_grid_load(&total, argv[1])) {
+        fprintf(stderr, "No se pudo leer %s\n", argv[1]);
+        return 1;
+    }
+    for (int i = 2; i < argc; i++) {
+        HeatmapGrid grid;
+        if (!heatmap_grid_load(&grid, argv[i])) {
+            fprintf(stderr, "No se pudo leer %s\n", argv[i]);
+            return 1;
+        }
+        if (!heatmap_grid_merge(&total, &grid)) {
+            fprintf(stderr, "%s: grilla %ux%u distinta de %ux%u\n", argv[i],
+                    grid.width, grid.height, total.width, total.height);
+            return 1;
+        }
+    }
+    if (!heatmap_grid_save(&total, argv[0])) {
+        fprintf(stderr, "No se pudo escribir %s\n", argv[0]);
+        return 1;
+    }
+    printf("%s: %u runs, %llu frames\n", argv[0], total.runs, (unsigned long long)total.frames);
+    return 0;
+}
+
+static int cmd_png(int argc, char **argv) {
+    bool dwell = true;
+    uint32_t scale = 10;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--presence") == 0) {
+            dwell = false;
+        } else if (strcmp(argv[i], "--dwell") == 0) {
+            dwell = true;
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            scale = (uint32_t)atoi(argv[++i]);
+        }
+    }
+    if (scale == 0 || scale > 64) scale = 10;
+
+    HeatmapGrid grid;
+    if (!heatmap_grid_load(&grid, argv[0])) {
+        fprintf(stderr, "No se pudo leer %s\n", argv[0]);
+        return 1;
+    }
+    size_t cells = grid.presence.size();
+    std::vector<double> values(cells);
+    double max_value = 0.0;
+    for (size_t i = 0; i < cells; i++) {
+        values[i] = log1p(dwell ? grid.dwell_us[i] / 1e6 : (double)grid.presence[i]);
+        if (values[i] > max_value) max_value = values[i];
+    }
+
+    uint32_t width = grid.width * scale, height = grid.height * scale;
+    std::vector<uint8_t> rgb((size_t)width * height * 3);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            size_t cell = (size_t)(y / scale) * grid.width + x / scale;
+            hot_color(max_value > 0.0 ? values[cell] / max_value : 0.0,
+                      &rgb[((size_t)y * width + x) * 3]);
+        }
+    }
+    crc_init();
+    if (!write_png(argv[1], rgb, width, height)) {
+        fprintf(stderr, "No se pudo escribir %s\n", argv[1]);
+        return 1;
+    }
+    printf("%s: %ux%u (%s)\n", argv[1], width, height, dwell ? "dwell" : "presence");
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso:\n"
+            "  %s info <grilla.bin>\n"
+            "  %s merge <salida.bin> <grilla.bin> [grilla.bin ...]\n"
+            "  %s png <grilla.bin> <salida.png> [--presence|--dwell] [--scale N]\n",
+            prog, prog, prog);
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "info") == 0) return cmd_info(argv[2]);
+    if (argc >= 4 && strcmp(argv[1], "merge") == 0) return cmd_merge(argc - 2, argv + 2);
+    if (argc >= 4 && strcmp(argv[1], "png") == 0) return cmd_png(argc - 2, argv + 2);
+    usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,189 @@
+/*
+ * latency_probe.cpp
+ * Receptor RTP local que mide la latencia ingreso -> recepción
+ *
+ * Uso:
+ *   latency_probe --port 5000 --ingest ingest.bin [--duration s] [--idle s] [--wait s]
+ *                 [--csv salida.csv]
+ *
+ * roi_surveillance debe ejecutarse con --latency-log ingest.bin (lo que fija
+ * el timestamp-offset RTP en 0). Cada frame recibido (último paquete, bit de
+ * marca) se asocia con su marca de ingreso usando el timestamp RTP de 90 kHz.
+ * Ambos procesos usan CLOCK_MONOTONIC, por lo que deben correr en la misma
+ * máquina. Termina tras --idle segundos sin paquetes, o tras --wait segundos
+ * si el emisor nunca empieza (arranque fallido, puerto equivocado).
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+// Mismo formato que LatencyIngestRecord (src/stream/latency.hpp)
+struct IngestRecord {
+    uint64_t pts_ns;
+    uint64_t monotonic_ns;
+};
+
+struct FrameArrival {
+    uint64_t first_ns;
+    uint64_t last_ns;
+    uint32_t packets;
+    bool complete;       // Se recibió el paquete con bit de marca
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double percentile(std::vector<double> &v, double p) {
+    if (v.empty()) return 0.0;
+    size_t idx = (size_t)(p * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + idx, v.end());
+    return v[idx];
+}
+
+int main(int argc, char *argv[]) {
+    int port = 5000;
+    const char *ingest_path = NULL;
+    const char *csv_path = NULL;
+    double duration_s = 0.0;
+    double idle_s = 3.0;
+    double wait_s = 60.0;  // Sin ningún paquete: cubre la carga del modelo
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ingest") == 0 && i + 1 < argc) {
+            ingest_path = argv[++i];
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            duration_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--idle") == 0 && i + 1 < argc) {
+            idle_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--wait") == 0 && i + 1 < argc) {
+            wait_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        }
+    }
+    if (!ingest_path) {
+        fprintf(stderr, "Uso: %s --port <p> --ingest <archivo> [--duration s] "
+                        "[--idle s] [--wait s] [--csv archivo]\n", argv[0]);
+        return 1;
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int rcvbuf = 8 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("bind");
+        return 1;
+    }
+    fprintf(stderr, "Escuchando RTP en puerto %d...\n", port);
+
+    std::unordered_map<uint32_t, FrameArrival> frames;
+    uint8_t packet[65536];
+    uint64_t start_ns = monotonic_ns();
+    uint64_t last_packet_ns = 0;
+
+    for (;;) {
+        struct pollfd pfd = { sock, POLLIN, 0 };
+        int rc = poll(&pfd, 1, 100);
+        uint64_t now = monotonic_ns();
+
+        if (rc > 0) {
+            ssize_t n = recv(sock, packet, sizeof(packet), 0);
+            now = monotonic_ns();
+            if (n >= 12 && (packet[0] >> 6) == 2) {
+                bool marker = (packet[1] & 0x80) != 0;
+                uint32_t ts = ((uint32_t)packet[4] << 24) | ((uint32_t)packet[5] << 16) |
+                              ((uint32_t)packet[6] << 8) | (uint32_t)packet[7];
+                auto it = frames.find(ts);
+                if (it == frames.end()) {
+                    FrameArrival fa = { now, now, 0, false };
+                    it = frames.emplace(ts, fa).first;
+                }
+                it->second.last_ns = now;
+                it->second.packets++;
+                if (marker) it->second.complete = true;
+                last_packet_ns = now;
+            }
+        }
+
+        if (duration_s > 0 && (now - start_ns) / 1e9 >= duration_s) break;
+        if (last_packet_ns && (now - last_packet_ns) / 1e9 >= idle_s) break;
+        if (!last_packet_ns && (now - start_ns) / 1e9 >= wait_s) {
+            fprintf(stderr, "Sin paquetes en %.0f s, terminando\n", wait_s);
+            break;
+        }
+    }
+    close(sock);
+
+    // Marcas de ingreso ordenadas por PTS
+    std::vector<IngestRecord> ingest;
+    FILE *f = fopen(ingest_path, "rb");
+    if (!f) {
+        perror(ingest_path);
+        return 1;
+    }
+    IngestRecord rec;
+    while (fread(&rec, sizeof(rec), 1, f) == 1) ingest.push_back(rec);
+    fclose(f);
+    std::sort(ingest.begin(), ingest.end(),
+              [](const IngestRecord &a, const IngestRecord &b) { return a.pts_ns < b.pts_ns; });
+
+    FILE *csv = csv_path ? fopen(csv_path, "w") : NULL;
+    if (csv) fprintf(csv, "pts_ms,packets,latency_ms\n");
+
+    std::vector<double> latency_ms;
+    size_t incomplete = 0, unmatched = 0;
+    for (const auto &pair : frames) {
+        if (!pair.second.complete) {
+            incomplete++;
+            continue;
+        }
+        // rtph264pay: ts = floor(running_time * 90000 / 1e9) con offset 0
+        uint64_t lo = (uint64_t)pair.first * 1000000000ULL / 90000ULL;
+        uint64_t hi = ((uint64_t)pair.first + 1) * 1000000000ULL / 90000ULL;
+        auto it = std::lower_bound(ingest.begin(), ingest.end(), lo,
+                                   [](const IngestRecord &r, uint64_t v) { return r.pts_ns < v; });
+        if (it == ingest.end() || it->pts_ns > hi ||
+            pair.second.last_ns < it->monotonic_ns) {
+            unmatched++;
+            continue;
+        }
+        double ms = (pair.second.last_ns - it->monotonic_ns) / 1e6;
+        latency_ms.push_back(ms);
+        if (csv) {
+            fprintf(csv, "%.3f,%u,%.3f\n", it->pts_ns / 1e6, pair.second.packets, ms);
+        }
+    }
+    if (csv) fclose(csv);
+
+    size_t matched = latency_ms.size();
+    printf("ingested_frames,received_frames,matched,incomplete,unmatched,"
+           "lat_p50_ms,lat_p90_ms,lat_p99_ms,lat_max_ms\n");
+    double p50 = percentile(latency_ms, 0.50);
+    double p90 = percentile(latency_ms, 0.90);
+    double p99 = percentile(latency_ms, 0.99);
+    double pmax = percentile(latency_ms, 1.0);
+    printf("%zu,%zu,%zu,%zu,%zu,%.2f,%.2f,%.2f,%.2f\n", ingest.size(), frames.size(),
+           matched, incomplete, unmatched, p50, p90, p99, pmax);
+    return matched > 0 ? 0 : 2;
+}
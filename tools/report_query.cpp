@@ -0,0 +1,179 @@
+/*
+ * report_query.cpp
+ * Consultas por rango de tiempo sobre el reporte columnar (--report-store)
+ *
+ * Uso:
+ *   report_query <archivo>                                   (resumen)
+ *   report_query <archivo> [--from t] [--to t] [--zone N] [--class ID]
+ *                          [--alerts] [--csv]
+ *
+ * t es un tiempo desde el inicio de la corrida en segundos (p.ej. 90.5) o
+ * una hora local HH:MM[:SS] (la primera ocurrencia desde el inicio). Con
+ * algún filtro o --csv imprime CSV con una fila por vehículo que entró en
+ * el rango: track_id,class_id,class,entry_time,entry_s,exit_s,dwell_s,zone,
+ * alert,inside. El archivo se mapea: solo se leen las columnas y los
+ * bloques que tocan el rango.
+ */
+
+#include "report_store_file.hpp"
+#include "text_format.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Medianoche local del día de start (s desde epoch)
+static time_t local_midnight(int64_t start_unix_ms) {
+    time_t start = (time_t)(start_unix_ms / 1000);
+    struct tm tm;
+    localtime_r(&start, &tm);
+    tm.tm_hour = 0;
+    tm.tm_min = 0;
+    tm.tm_sec = 0;
+    return mktime(&tm);
+}
+
+// ms desde el inicio; not_before para que "--to" quede después de "--from"
+static bool parse_time(const char *spec, int64_t start_unix_ms, uint64_t not_before,
+                       uint64_t *out_ms) {
+    int h, m, s = 0;
+    char extra;
+    int fields = sscanf(spec, "%d:%d:%d%c", &h, &m, &s, &extra);
+    if (fields >= 2 && fields <= 3 && strchr(spec, ':')) {
+        if (h < 0 || h > 23 || m < 0 || m > 59 || s < 0 || s > 59) return false;
+        int64_t target = ((int64_t)local_midnight(start_unix_ms) + h * 3600 + m * 60 + s) * 1000;
+        while (target < start_unix_ms + (int64_t)not_before) target += 86400 * 1000LL;
+        *out_ms = (uint64_t)(target - start_unix_ms);
+        return true;
+    }
+    char *end;
+    double seconds = strtod(spec, &end);
+    if (end == spec || *end != '\0' || seconds < 0.0) return false;
+    *out_ms = (uint64_t)(seconds * 1000.0);
+    return true;
+}
+
+static void write_seconds(TextWriter *w, uint64_t ms) {
+    text_u64(w, ms / 1000);
+    text_char(w, '.');
+    text_u64_padded(w, ms % 1000, 3);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <archivo> [--from t] [--to t] [--zone N] [--class ID] "
+                        "[--alerts] [--csv]\n", argv[0]);
+        return 1;
+    }
+    ReportStore store;
+    if (!report_store_open(&store, argv[1])) {
+        fprintf(stderr, "No se pudo leer %s\n", argv[1]);
+        return 1;
+    }
+    const ReportStoreHeader *h = store.header;
+
+    bool csv = false, alerts_only = false;
+    const char *from_spec = NULL, *to_spec = NULL;
+    int zone = -2, class_id = -1;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            from_spec = argv[++i];
+            csv = true;
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            to_spec = argv[++i];
+            csv = true;
+        } else if (strcmp(argv[i], "--zone") == 0 && i + 1 < argc) {
+            zone = atoi(argv[++i]);
+            csv = true;
+        } else if (strcmp(argv[i], "--class") == 0 && i + 1 < argc) {
+            class_id = atoi(argv[++i]);
+            csv = true;
+        } else if (strcmp(argv[i], "--alerts") == 0) {
+            alerts_only = csv = true;
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        }
+    }
+    uint64_t from_ms = 0, to_ms = UINT64_MAX;
+    if ((from_spec && !parse_time(from_spec, h->start_unix_ms, 0, &from_ms)) ||
+        (to_spec && !parse_time(to_spec, h->start_unix_ms, from_ms, &to_ms))) {
+        fprintf(stderr, "Tiempo invalido (use segundos o HH:MM[:SS])\n");
+        report_store_close(&store);
+        return 1;
+    }
+
+    static TextWriter out;
+    text_open(&out, stdout);
+    time_t midnight = local_midnight(h->start_unix_ms);
+    uint64_t alerts = 0, zone_rows[8] = { 0 };
+    uint64_t first = report_store_seek(&store, from_ms);
+    if (csv) text_str(&out, "track_id,class_id,class,entry_time,entry_s,exit_s,dwell_s,zone,alert,inside\n");
+    for (uint64_t r = first; r < h->num_rows && store.entry_ms[r] <= to_ms; r++) {
+        if (zone != -2 && store.zone[r] != zone) continue;
+        if (class_id >= 0 && store.class_id[r] != class_id) continue;
+        uint8_t flags = store.flags[r];
+        if (alerts_only && !(flags & REPORT_FLAG_ALERT)) continue;
+        if (flags & REPORT_FLAG_ALERT) alerts++;
+        if (store.zone[r] >= 0 && store.zone[r] < 8) zone_rows[store.zone[r]]++;
+        if (!csv) continue;
+
+        uint16_t cls = store.class_id[r];
+        text_u64(&out, store.track_id[r]);
+        text_char(&out, ',');
+        text_u64(&out, cls);
+        text_char(&out, ',');
+        if (cls < REPORT_STORE_MAX_CLASSES) {
+            text_bytes(&out, h->class_names[cls], strnlen(h->class_names[cls], REPORT_STORE_CLASS_NAME));
+        }
+        text_char(&out, ',');
+        // Hora local sin localtime por fila (días siguientes suman horas)
+        int64_t local_s = (h->start_unix_ms + (int64_t)store.entry_ms[r]) / 1000 - midnight;
+        text_u64_padded(&out, (uint64_t)local_s / 3600, 2);
+        text_char(&out, ':');
+        text_u64_padded(&out, (uint64_t)local_s / 60 % 60, 2);
+        text_char(&out, ':');
+        text_u64_padded(&out, (uint64_t)local_s % 60, 2);
+        text_char(&out, ',');
+        write_seconds(&out, store.entry_ms[r]);
+        text_char(&out, ',');
+        write_seconds(&out, store.exit_ms[r]);
+        text_char(&out, ',');
+        write_seconds(&out, store.dwell_ms[r]);
+        text_char(&out, ',');
+        text_i64(&out, store.zone[r]);
+        text_str(&out, (flags & REPORT_FLAG_ALERT) ? ",1" : ",0");
+        text_str(&out, (flags & REPORT_FLAG_INSIDE) ? ",1\n" : ",0\n");
+    }
+
+    if (!csv) {
+        char started[32] = "?";
+        time_t start = (time_t)(h->start_unix_ms / 1000);
+        struct tm tm;
+        if (localtime_r(&start, &tm)) strftime(started, sizeof(started), "%Y-%m-%d %H:%M:%S", &tm);
+        text_str(&out, "Start: ");
+        text_str(&out, started);
+        text_str(&out, "\nRows: ");
+        text_u64(&out, h->num_rows);
+        text_str(&out, " (");
+        text_u64(&out, alerts);
+        text_str(&out, " alerts)\n");
+        if (h->num_rows > 0) {
+            text_str(&out, "Entries: ");
+            write_seconds(&out, store.entry_ms[0]);
+            text_str(&out, " s - ");
+            write_seconds(&out, store.entry_ms[h->num_rows - 1]);
+            text_str(&out, " s\n");
+        }
+        for (int z = 0; z < 8; z++) {
+            if (!zone_rows[z]) continue;
+            text_str(&out, "Zone ");
+            text_u64(&out, z);
+            text_str(&out, ": ");
+            text_u64(&out, zone_rows[z]);
+            text_char(&out, '\n');
+        }
+    }
+    text_flush(&out);
+    report_store_close(&store);
+    return out.failed ? 1 : 0;
+}
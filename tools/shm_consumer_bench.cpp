@@ -0,0 +1,138 @@
+/*
+ * shm_consumer_bench.cpp
+ * Benchmark de consumidores del anillo de memoria compartida
+ *
+ * Uso:
+ *   shm_consumer_bench <nombre> [--frames N] [--readers R] [--mode peek|touch|copy]
+ *
+ * Cada lector mide la latencia publicación -> lectura, los frames perdidos
+ * por atraso y los frames invalidados (sobrescritos mientras se usaban).
+ */
+
+#include "shm_reader.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum ConsumeMode { MODE_PEEK, MODE_TOUCH, MODE_COPY };
+
+struct ReaderResult {
+    uint64_t frames;
+    uint64_t lost;
+    uint64_t torn;
+    uint64_t bytes;
+    uint64_t checksum;
+    double elapsed_s;
+    std::vector<double> latency_us;
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double percentile(std::vector<double> &v, double p) {
+    if (v.empty()) return 0.0;
+    size_t idx = (size_t)(p * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + idx, v.end());
+    return v[idx];
+}
+
+static void run_reader(const std::string &name, uint64_t max_frames,
+                       ConsumeMode mode, ReaderResult *res) {
+    ShmReader reader;
+    while (!shm_reader_open(&reader, name.c_str())) {
+        usleep(100 * 1000);  // Esperar a que el escritor cree el segmento
+    }
+
+    std::vector<uint8_t> copy_buf;
+    res->latency_us.reserve(max_frames);
+    uint64_t start = monotonic_ns();
+
+    ShmFrameView view;
+    while (res->frames < max_frames) {
+        int rc = shm_reader_next(&reader, &view, 1000);
+        if (rc < 0) break;
+        if (rc == 0) continue;
+
+        uint64_t now = monotonic_ns();
+        if (mode == MODE_TOUCH) {
+            // Leer una palabra por línea de caché sin copiar el frame
+            for (uint32_t off = 0; off < view.frame_size; off += 64) {
+                res->checksum += view.pixels[off];
+            }
+        } else if (mode == MODE_COPY) {
+            copy_buf.resize(view.frame_size);
+            memcpy(copy_buf.data(), view.pixels, view.frame_size);
+        }
+        for (uint32_t i = 0; i < view.num_objects; i++) {
+            res->checksum += view.objects[i].track_id;
+        }
+
+        if (!shm_reader_release(&reader, &view)) {
+            res->torn++;
+            continue;
+        }
+        res->latency_us.push_back((now - view.publish_ns) / 1000.0);
+        res->bytes += view.frame_size;
+        res->frames++;
+    }
+
+    res->elapsed_s = (monotonic_ns() - start) / 1e9;
+    res->lost = reader.frames_lost;
+    shm_reader_close(&reader);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <nombre> [--frames N] [--readers R] [--mode peek|touch|copy]\n",
+                argv[0]);
+        return 1;
+    }
+
+    std::string name = argv[1];
+    uint64_t frames = 1000;
+    int readers = 1;
+    ConsumeMode mode = MODE_TOUCH;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--readers") == 0 && i + 1 < argc) {
+            readers = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            const char *m = argv[++i];
+            mode = strcmp(m, "peek") == 0 ? MODE_PEEK :
+                   strcmp(m, "copy") == 0 ? MODE_COPY : MODE_TOUCH;
+        }
+    }
+
+    std::vector<ReaderResult> results(readers);
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; r++) {
+        results[r] = ReaderResult();
+        threads.emplace_back(run_reader, name, frames, mode, &results[r]);
+    }
+    for (auto &t : threads) t.join();
+
+    printf("reader,frames,lost,torn,fps,mb_per_s,lat_p50_us,lat_p99_us,lat_max_us\n");
+    for (int r = 0; r < readers; r++) {
+        ReaderResult &res = results[r];
+        double fps = res.elapsed_s > 0 ? res.frames / res.elapsed_s : 0.0;
+        double mbps = res.elapsed_s > 0 ? res.bytes / res.elapsed_s / (1024.0 * 1024.0) : 0.0;
+        double p50 = percentile(res.latency_us, 0.50);
+        double p99 = percentile(res.latency_us, 0.99);
+        double pmax = percentile(res.latency_us, 1.0);
+        printf("%d,%llu,%llu,%llu,%.1f,%.1f,%.1f,%.1f,%.1f\n", r,
+               (unsigned long long)res.frames, (unsigned long long)res.lost,
+               (unsigned long long)res.torn, fps, mbps, p50, p99, pmax);
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * trajectory_reader.cpp
+ * Decodifica las trayectorias registradas con --trajectories
+ *
+ * Uso:
+ *   trajectory_reader <archivo>                         (resumen por track)
+ *   trajectory_reader <archivo> [--track ID] [--from s] [--to s]
+ *
+ * Con --track o un rango de tiempo imprime CSV con una fila por muestra:
+ * track_id,class_id,time_s,left,top,width,height,state (bbox normalizado,
+ * state: outside, inside o alert).
+ */
+
+#include "trajectory_file.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const char *STATE_NAMES[] = { "outside", "inside", "alert" };
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <archivo> [--track ID] [--from s] [--to s]\n", argv[0]);
+        return 1;
+    }
+    bool filter_track = false, samples_mode = false;
+    uint64_t track_id = 0;
+    double from_s = 0.0, to_s = 1e18;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--track") == 0 && i + 1 < argc) {
+            track_id = strtoull(argv[++i], NULL, 10);
+            filter_track = samples_mode = true;
+        } else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            from_s = atof(argv[++i]);
+            samples_mode = true;
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            to_s = atof(argv[++i]);
+            samples_mode = true;
+        }
+    }
+
+    TrajectoryReader reader;
+    if (!trajectory_reader_open(&reader, argv[1])) {
+        fprintf(stderr, "No se pudo leer %s\n", argv[1]);
+        return 1;
+    }
+    if (samples_mode) {
+        printf("track_id,class_id,time_s,left,top,width,height,state\n");
+    } else {
+        printf("%u tracks, %llu samples, %llu dropped\n", reader.header.num_tracks,
+               (unsigned long long)reader.header.samples,
+               (unsigned long long)reader.header.dropped);
+        printf("%10s %6s %10s %10s %8s %8s\n", "track", "class", "start_s", "end_s",
+               "samples", "B/sample");
+    }
+
+    const double scale = reader.header.scale;
+    uint64_t from_ms = (uint64_t)(from_s * 1000.0);
+    uint64_t to_ms = to_s >= 1e15 ? UINT64_MAX : (uint64_t)(to_s * 1000.0);
+    TrajectoryTrackHeader th;
+    std::vector<uint8_t> data;
+    std::vector<TrajectorySample> samples;
+    int status = 0;
+    while (trajectory_reader_next(&reader, &th, &data)) {
+        if (filter_track && th.track_id != track_id) continue;
+        if (th.last_pts_ms < from_ms || th.first_pts_ms > to_ms) continue;
+        if (!samples_mode) {
+            printf("%10llu %6d %10.2f %10.2f %8u %8.1f\n", (unsigned long long)th.track_id,
+                   th.class_id, th.first_pts_ms / 1000.0, th.last_pts_ms / 1000.0,
+                   th.samples, th.samples ? (double)th.bytes / th.samples : 0.0);
+            continue;
+        }
+        samples.clear();
+        if (!trajectory_decode(data.data(), data.size(), th.samples, &samples)) {
+            fprintf(stderr, "Track %llu: datos truncados\n", (unsigned long long)th.track_id);
+            status = 1;
+        }
+        for (const TrajectorySample &s : samples) {
+            if (s.pts_ms < from_ms || s.pts_ms > to_ms) continue;
+            printf("%llu,%d,%.3f,%.4f,%.4f,%.4f,%.4f,%s\n", (unsigned long long)th.track_id,
+                   th.class_id, s.pts_ms / 1000.0, s.x / scale, s.y / scale, s.w / scale,
+                   s.h / scale, s.state < 3 ? STATE_NAMES[s.state] : "?");
+        }
+    }
+    trajectory_reader_close(&reader);
+    return status;
+}